@@ -126,6 +126,8 @@ class EventReceiver(Structure):
     ]
 
 libpsmoveapi.psmoveapi_init.argtypes = [POINTER(EventReceiver), c_void_p]
+libpsmoveapi.psmoveapi_wait.argtypes = [c_int]
+libpsmoveapi.psmoveapi_wait.restype = c_bool
 
 class Controller(object):
     def __init__(self, controller):
@@ -183,6 +185,9 @@ class PSMoveAPI(object):
     def update(self):
         libpsmoveapi.psmoveapi_update()
 
+    def wait(self, timeout_ms=-1):
+        return bool(libpsmoveapi.psmoveapi_wait(timeout_ms))
+
     def _on_connect(self, controller, user_data):
         self._controllers[controller[0].serial] = Controller(controller[0])
         self.on_connect(self._controllers[controller[0].serial])
@@ -38,6 +38,7 @@ extern "C" {
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdarg.h>
+#include <stddef.h>
 
 #ifdef _WIN32
 #  define ADDCALL __cdecl
@@ -221,6 +222,7 @@ enum PSMoveOrientation_Fusion_Type {
 	OrientationFusion_MadgwickIMU,
 	OrientationFusion_MadgwickMARG,
 	OrientationFusion_ComplementaryMARG,
+	OrientationFusion_ESKF,
 };
 
 /*! Common Calibration Poses */
@@ -281,6 +283,40 @@ struct _PSMove_3AxisTransform
 };
 typedef struct _PSMove_3AxisTransform PSMove_3AxisTransform;
 
+/*! A decoded and calibrated input report, filled by psmove_poll_batch() */
+typedef struct {
+    int seq; /*!< Sequence number (1..16), as returned by psmove_poll() */
+    unsigned int buttons; /*!< Pressed buttons (bitmask of \ref PSMove_Button) */
+    unsigned char trigger; /*!< Trigger value (0..255) */
+    unsigned short timestamp; /*!< Raw 16-bit timestamp of the report (device clock) */
+    uint64_t time_us; /*!< Sampling time on the host clock, see psmove_get_sample_time_us() */
+    uint32_t latency_us; /*!< Estimated delivery latency, see psmove_get_latency_us() */
+    PSMove_3AxisVector accelerometer[2]; /*!< Accelerometer in g, indexed by \ref PSMove_Frame */
+    PSMove_3AxisVector gyroscope[2]; /*!< Gyroscope in rad/s, indexed by \ref PSMove_Frame */
+    float orientation[4]; /*!< Orientation quaternion (w, x, y, z) after this report, identity if orientation tracking is disabled */
+} PSMove_Sample;
+
+/*! Number of buckets in PSMove_Stats.interval_histogram */
+#define PSMOVE_STATS_INTERVAL_BUCKETS 10
+
+/*! Link quality statistics of a controller, see psmove_get_stats() */
+typedef struct {
+    uint64_t reports_received; /*!< Input reports read via psmove_poll() */
+    uint64_t gaps_detected; /*!< Number of gaps in the sequence numbers */
+    uint64_t reports_lost; /*!< Estimated number of reports lost in those gaps */
+    uint64_t reports_overflowed; /*!< Reports dropped because the threaded reading queue was full */
+    uint64_t led_updates; /*!< Successful LED/rumble writes by psmove_update_leds() */
+    uint64_t led_write_failures; /*!< Failed LED/rumble writes by psmove_update_leds() */
+    uint32_t max_interval_us; /*!< Longest time between the arrival of two reports */
+
+    /**
+     * Histogram of the time between the arrival of two reports. The upper
+     * bounds of the buckets are 2, 4, 8, 12, 16, 24, 32, 64 and 128 ms, the
+     * last bucket counts all intervals of 128 ms and above.
+     **/
+    uint32_t interval_histogram[PSMOVE_STATS_INTERVAL_BUCKETS];
+} PSMove_Stats;
+
 /*! Library version number */
 enum PSMove_Version {
     PSMOVE_CURRENT_VERSION = (PSMOVEAPI_VERSION_MAJOR << 16) |
@@ -404,6 +440,67 @@ ADDCALL psmove_connection_type(PSMove *move);
 ADDAPI bool
 ADDCALL psmove_is_remote(PSMove *move);
 
+/**
+ * \brief Connect to a controller replayed from a capture file
+ *
+ * Captures are recorded with psmove_start_recording(). The replayed
+ * controller behaves like a connected one: psmove_poll() delivers the
+ * recorded input reports, LED and rumble updates are accepted (but go
+ * nowhere), and the calibration of the recorded controller is used.
+ * This makes it possible to test and benchmark sensor fusion or tracking
+ * code without hardware, with results that are identical between runs.
+ *
+ * Timestamps (e.g. of psmove_get_sample_time_us()) follow the recorded
+ * timeline independent of the replay speed.
+ *
+ * \param filename Path of the capture file
+ * \param speed Replay speed factor (1 = real time, 2 = twice as fast,
+ *              0 = deliver reports as fast as they are polled)
+ *
+ * \return A new \ref PSMove handle, or \c NULL on error
+ **/
+ADDAPI PSMove *
+ADDCALL psmove_connect_replay(const char *filename, float speed);
+
+/**
+ * \brief Check if all reports of a replayed controller have been delivered
+ *
+ * \param move A valid \ref PSMove handle
+ *
+ * \return \ref true if the controller is a replay that has finished
+ * \return \ref false otherwise (also for non-replayed controllers)
+ **/
+ADDAPI bool
+ADDCALL psmove_is_replay_finished(PSMove *move);
+
+/**
+ * \brief Record the raw input and output reports of a controller
+ *
+ * All input reports read by psmove_poll() and all LED/rumble reports
+ * written to the controller are recorded with their arrival time, along
+ * with the serial number, model and calibration of the controller. Use
+ * psmove_connect_replay() to replay the capture. A recording that is
+ * already running is stopped first.
+ *
+ * \param move A valid \ref PSMove handle
+ * \param filename Path of the capture file (will be overwritten)
+ *
+ * \return \ref true if the recording was started
+ * \return \ref false if the file could not be created
+ **/
+ADDAPI bool
+ADDCALL psmove_start_recording(PSMove *move, const char *filename);
+
+/**
+ * \brief Stop recording reports of a controller
+ *
+ * This is done automatically by psmove_disconnect().
+ *
+ * \param move A valid \ref PSMove handle
+ **/
+ADDAPI void
+ADDCALL psmove_stop_recording(PSMove *move);
+
 /**
  * \brief Get the serial number (Bluetooth MAC address) of a controller.
  *
@@ -634,6 +731,69 @@ ADDCALL psmove_set_rumble(PSMove *move, unsigned char rumble);
 ADDAPI enum PSMove_Update_Result
 ADDCALL psmove_update_leds(PSMove *move);
 
+/**
+ * \brief Enable or disable reading input reports on a background thread.
+ *
+ * When threaded reading is enabled, a dedicated thread reads all input
+ * reports of the controller as soon as they arrive and queues them in a
+ * lock-free ring buffer. psmove_poll() then only takes the oldest queued
+ * report from that buffer, so no reports are lost while the application is
+ * busy (e.g. rendering a frame), and a slow controller does not delay the
+ * others.
+ *
+ * The queue holds about 1.5 seconds worth of reports; if psmove_poll() is
+ * not called for longer than that, newer reports are dropped.
+ *
+ * By default, threaded reading is disabled. Remote controllers (moved)
+ * do not support threaded reading.
+ *
+ * \note psmove_poll() must still only be called from one thread at a time.
+ *
+ * \param move A valid \ref PSMove handle
+ * \param enabled \ref true to enable threaded reading,
+ *                \ref false to disable
+ *
+ * \return \ref true on success
+ * \return \ref false on error (or if not supported for this controller)
+ **/
+ADDAPI bool
+ADDCALL psmove_set_threaded_reading(PSMove *move, bool enabled);
+
+/**
+ * \brief Wait until new data is available from any of the given controllers.
+ *
+ * Instead of calling psmove_poll() in a busy loop (or sleeping for some
+ * arbitrary time), this function can be used to put the calling thread to
+ * sleep until at least one of the controllers has received a new report.
+ *
+ * Waiting relies on threaded reading, so threaded reading is enabled on all
+ * given controllers that do not have it enabled yet (see
+ * psmove_set_threaded_reading()). Remote (moved) controllers cannot signal
+ * new data, so if any are given, the function returns after at most a few
+ * milliseconds, so they can be polled regularly.
+ *
+ * \code
+ *     while (running) {
+ *         psmove_wait_any(moves, count, 100);
+ *         for (i=0; i<count; i++) {
+ *             while (psmove_poll(moves[i])) {
+ *                 // process new data
+ *             }
+ *         }
+ *     }
+ * \endcode
+ *
+ * \param moves An array of valid \ref PSMove handles
+ * \param count The number of handles in \a moves
+ * \param timeout_ms The maximum time to wait in milliseconds, \c 0 to
+ *                   not block, or a negative value to wait forever
+ *
+ * \return \ref true if data is available on at least one controller
+ * \return \ref false if the timeout expired (or on error)
+ **/
+ADDAPI bool
+ADDCALL psmove_wait_any(PSMove **moves, size_t count, int timeout_ms);
+
 /**
  * \brief Read new sensor/button data from the controller.
  *
@@ -678,6 +838,225 @@ ADDCALL psmove_update_leds(PSMove *move);
 ADDAPI int
 ADDCALL psmove_poll(PSMove *move);
 
+/**
+ * \brief Read new sensor/button data from several controllers at once.
+ *
+ * This polls each controller once, like psmove_poll(), but the orientation
+ * of all controllers that received a report (and have orientation tracking
+ * enabled, see psmove_enable_orientation()) is updated afterwards in a
+ * single batch. Controllers that use the Madgwick IMU filter are fused
+ * together using SIMD instructions, which is faster than updating them one
+ * by one in setups with many controllers.
+ *
+ * \code
+ *     int results[16];
+ *     while (psmove_poll_many(moves, count, results)) {
+ *         for (i=0; i<count; i++) {
+ *             if (results[i]) {
+ *                 // process new data of moves[i]
+ *             }
+ *         }
+ *     }
+ * \endcode
+ *
+ * \param moves An array of \ref PSMove handles (\c NULL entries are skipped)
+ * \param count The number of handles in \a moves
+ * \param results Array of \a count entries that receives the return value
+ *                of psmove_poll() for each controller, or \c NULL
+ *
+ * \return The number of controllers that received new data
+ **/
+ADDAPI size_t
+ADDCALL psmove_poll_many(PSMove **moves, size_t count, int *results);
+
+/**
+ * \brief Read all pending sensor/button data from the controller at once.
+ *
+ * This is equivalent to calling psmove_poll() in a loop and reading the
+ * buttons, trigger and both calibrated accelerometer and gyroscope frames
+ * after each successful call, but avoids the per-report overhead of the
+ * individual getters. This is useful for consumers that need to process
+ * every single sensor reading (e.g. for logging or custom filtering).
+ *
+ * After this call, the other getters (e.g. psmove_get_buttons()) return
+ * the values of the most recent report, as with psmove_poll().
+ *
+ * \code
+ *     PSMove_Sample samples[32];
+ *     size_t count = psmove_poll_batch(move, samples, 32);
+ *     for (size_t i=0; i<count; i++) {
+ *         // process samples[i].gyroscope[Frame_FirstHalf], ...
+ *     }
+ * \endcode
+ *
+ * \param move A valid \ref PSMove handle
+ * \param out Array of at least \a max samples to fill
+ * \param max The maximum number of samples to read
+ *
+ * \return The number of samples written to \a out (\c 0 if no new data
+ *         is available or an error occurred)
+ **/
+ADDAPI size_t
+ADDCALL psmove_poll_batch(PSMove *move, PSMove_Sample *out, size_t max);
+
+/**
+ * \brief Keep the most recent samples of the controller in a history buffer.
+ *
+ * When enabled, every report read by psmove_poll(), psmove_poll_many() or
+ * psmove_poll_batch() is decoded into a \ref PSMove_Sample (including the
+ * orientation after the report) and stored in a per-controller ring buffer.
+ * Use psmove_get_history() to get the last samples, and psmove_get_history_at()
+ * to look up the state at a past time, e.g. to match a camera frame from
+ * psmove_tracker_update() (see psmove_tracker_get_frame_time_us()) with the
+ * sensor readings at the time it was taken.
+ *
+ * The history is disabled by default. Changing the size discards all
+ * samples stored so far. At about 88 reports per second, a size of 180
+ * keeps roughly two seconds of history.
+ *
+ * \param move A valid \ref PSMove handle
+ * \param size The number of samples to keep, or \c 0 to disable the history
+ *
+ * \return \ref true on success
+ * \return \ref false on error (e.g. out of memory)
+ **/
+ADDAPI bool
+ADDCALL psmove_set_history_size(PSMove *move, size_t size);
+
+/**
+ * \brief Get the most recent samples from the history.
+ *
+ * The samples are written to \a out in chronological order (oldest first),
+ * so that the last entry is the sample of the current report. The history
+ * must have been enabled with psmove_set_history_size().
+ *
+ * \param move A valid \ref PSMove handle
+ * \param out Array of at least \a max samples to fill
+ * \param max The maximum number of samples to get
+ *
+ * \return The number of samples written to \a out
+ **/
+ADDAPI size_t
+ADDCALL psmove_get_history(PSMove *move, PSMove_Sample *out, size_t max);
+
+/**
+ * \brief Get the interpolated state of the controller at a past time.
+ *
+ * Looks up the two samples in the history around \a time_us (on the clock
+ * of psmove_get_sample_time_us()) and interpolates between them:
+ * Accelerometer and gyroscope readings linearly, the orientation spherically.
+ * Buttons, trigger, sequence number and raw timestamp are the ones of the
+ * sample nearest to \a time_us. The \c time_us field of \a out is set to
+ * \a time_us.
+ *
+ * Times after the current report are not extrapolated, use
+ * psmove_get_predicted_orientation() for that.
+ *
+ * \param move A valid \ref PSMove handle
+ * \param time_us The time to look up, in microseconds (see psmove_util_get_time_us())
+ * \param out Pointer to a \ref PSMove_Sample to fill
+ *
+ * \return \ref true on success
+ * \return \ref false if the history is disabled or \a time_us is not
+ *         between the oldest and the newest sample in the history
+ **/
+ADDAPI bool
+ADDCALL psmove_get_history_at(PSMove *move, uint64_t time_us, PSMove_Sample *out);
+
+/**
+ * \brief Get the link quality statistics of the controller.
+ *
+ * The statistics are collected since connecting to the controller or
+ * since the last call to psmove_reset_stats(). They can be used to find
+ * controllers (or Bluetooth adapters) that lose many reports or that
+ * deliver them with large delays.
+ *
+ * \note The arrival intervals are most meaningful with threaded reading
+ *       enabled (see psmove_set_threaded_reading()), as otherwise reports
+ *       that queued up between two psmove_poll() calls arrive at once.
+ *
+ * \param move A valid \ref PSMove handle
+ * \param stats Pointer to a \ref PSMove_Stats structure to fill
+ *
+ * \return \ref true on success
+ * \return \ref false on error
+ **/
+ADDAPI bool
+ADDCALL psmove_get_stats(PSMove *move, PSMove_Stats *stats);
+
+/**
+ * \brief Reset the link quality statistics of the controller to zero.
+ *
+ * \param move A valid \ref PSMove handle
+ **/
+ADDAPI void
+ADDCALL psmove_reset_stats(PSMove *move);
+
+/**
+ * \brief Get the device timestamp of the current report.
+ *
+ * Each input report carries a 16-bit timestamp of the controller's internal
+ * clock. The library unwraps it into a 64-bit counter that starts at zero
+ * with the first report received and increases monotonically, even across
+ * dropped reports.
+ *
+ * You need to call psmove_poll() first to read new data from the
+ * controller.
+ *
+ * \param move A valid \ref PSMove handle
+ *
+ * \return The unwrapped device timestamp, in device clock ticks
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_get_device_timestamp(PSMove *move);
+
+/**
+ * \brief Get the time when the current report was sampled.
+ *
+ * The device clock is mapped onto the host's monotonic clock (see
+ * psmove_util_get_time_us()) by estimating the rate of the device clock and
+ * the lowest transport delay observed so far. Shortly after connecting
+ * (while the rate is not known yet) this is the same as the arrival time.
+ *
+ * Use this instead of the time of the psmove_poll() call if you need exact
+ * time differences between reports (e.g. for integrating sensor readings).
+ *
+ * \param move A valid \ref PSMove handle
+ *
+ * \return The sampling time, in microseconds on the host monotonic clock
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_get_sample_time_us(PSMove *move);
+
+/**
+ * \brief Get the time when the current report arrived at the host.
+ *
+ * If threaded reading is enabled (see psmove_set_threaded_reading()), this
+ * is the time the report was read by the reader thread, otherwise it is the
+ * time it was read by psmove_poll().
+ *
+ * \param move A valid \ref PSMove handle
+ *
+ * \return The arrival time, in microseconds on the host monotonic clock
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_get_arrival_time_us(PSMove *move);
+
+/**
+ * \brief Get the estimated latency of the current report.
+ *
+ * This is the difference between psmove_get_arrival_time_us() and
+ * psmove_get_sample_time_us(), i.e. how much longer than the fastest
+ * report seen so far it took for this report to arrive. The fixed part of
+ * the transport delay cannot be measured and is not included.
+ *
+ * \param move A valid \ref PSMove handle
+ *
+ * \return The estimated latency in microseconds
+ **/
+ADDAPI uint32_t
+ADDCALL psmove_get_latency_us(PSMove *move);
+
 /**
  * \brief Get the extension device's data as reported by the Move.
  *
@@ -1046,10 +1425,11 @@ ADDCALL psmove_get_magnetometer(PSMove *move, int *mx, int *my, int *mz);
 /**
  * \brief Get the normalized magnetometer vector from the controller.
  *
- * The normalized magnetometer vector is a three-axis vector where each
- * component is in the range [-1,+1], including both endpoints. The range
- * will be dynamically determined based on the highest (and lowest) value
- * observed during runtime. To get the raw magnetometer readings, use
+ * The normalized magnetometer vector is a three-axis vector of (about)
+ * unit length: The hard and soft iron calibration maps the ellipsoid
+ * fitted to the raw readings to the unit sphere. Without a saved
+ * calibration, the ellipsoid is fitted to the readings of psmove_poll()
+ * during runtime. To get the raw magnetometer readings, use
  * psmove_get_magnetometer().
  *
  * You need to call psmove_poll() first to read new data from the
@@ -1066,10 +1446,11 @@ ADDCALL psmove_get_magnetometer_vector(PSMove *move, float *mx, float *my, float
 /**
  * \brief Get the normalized magnetometer vector from the controller.
  *
- * The normalized magnetometer vector is a three-axis vector where each
- * component is in the range [-1,+1], including both endpoints. The range
- * will be dynamically determined based on the highest (and lowest) value
- * observed during runtime. To get the raw magnetometer readings, use
+ * The normalized magnetometer vector is a three-axis vector of (about)
+ * unit length: The hard and soft iron calibration maps the ellipsoid
+ * fitted to the raw readings to the unit sphere. Without a saved
+ * calibration, the ellipsoid is fitted to the readings of psmove_poll()
+ * during runtime. To get the raw magnetometer readings, use
  * psmove_get_magnetometer().
  *
  * You need to call psmove_poll() first to read new data from the
@@ -1084,8 +1465,10 @@ ADDCALL psmove_get_magnetometer_3axisvector(PSMove *move, PSMove_3AxisVector *ou
 /**
  * \brief Reset the magnetometer calibration state.
  *
- * This will reset the magnetometer calibration data, so they can be
- * re-adjusted dynamically. Used by the calibration utility.
+ * This will reset the magnetometer calibration data and start collecting
+ * the readings of the following psmove_poll() calls for a new ellipsoid
+ * fit. Readings that are far off the fitted ellipsoid are rejected as
+ * outliers. Used by the calibration utility.
  *
  * \ref move A valid \ref PSMove handle
  **/
@@ -1095,7 +1478,9 @@ ADDCALL psmove_reset_magnetometer_calibration(PSMove *move);
 /**
  * \brief Save the magnetometer calibration values.
  *
- * This will save the magnetometer calibration data to persistent storage.
+ * This will fit the ellipsoid to the readings collected since
+ * psmove_reset_magnetometer_calibration() and save the magnetometer
+ * calibration data to persistent storage.
  * If a calibration already exists, this will overwrite the old values.
  *
  * \param move A valid \ref PSMove handle
@@ -1106,14 +1491,15 @@ ADDCALL psmove_save_magnetometer_calibration(PSMove *move);
 /**
  * \brief Return the raw magnetometer calibration range.
  *
- * The magnetometer calibration is dynamic at runtime - this function returns
- * the raw range of magnetometer calibration. The user should rotate the
+ * While collecting readings for the magnetometer calibration, this function
+ * returns the raw range of the calibration so far. The user should rotate the
  * controller in all directions to find the response range of the controller
  * (this will be dynamically adjusted).
  *
  * \param move A valid \ref PSMove handle
  *
- * \return The smallest raw sensor range difference of all three axes
+ * \return The smallest diameter of the fitted ellipsoid in raw sensor units
+ *         (the smallest range of all three axes until enough directions are covered)
  **/
 ADDAPI float
 ADDCALL psmove_get_magnetometer_calibration_range(PSMove *move);
@@ -1123,11 +1509,14 @@ ADDCALL psmove_get_magnetometer_calibration_range(PSMove *move);
  *
  * For psmove_get_accelerometer_frame() and psmove_get_gyroscope_frame()
  * to work, the calibration data has to be availble. This usually happens
- * at pairing time via USB. The calibration files are stored in the PS
- * Move API data directory (see psmove_util_get_data_dir()) and can be
- * copied between machines (e.g. from the machine you do your pairing to
- * the machine where you run the API on, which is especially important for
- * mobile devices, where USB host mode might not be supported).
+ * at pairing time via USB. The calibrations of all controllers are stored
+ * in the file "calibration.store" in the PS Move API data directory (see
+ * psmove_util_get_data_dir()), which can be copied between machines (e.g.
+ * from the machine you do your pairing to the machine where you run the API
+ * on, which is especially important for mobile devices, where USB host mode
+ * might not be supported). Calibration files of earlier versions
+ * ("BTADDR.calibration" and "BTADDR.magnetometer.dat") are imported into
+ * the store automatically.
  *
  * If no calibration is available, the two functions returning calibrated
  * values will return uncalibrated values. Also, the orientation features
@@ -1140,6 +1529,23 @@ ADDCALL psmove_get_magnetometer_calibration_range(PSMove *move);
 ADDAPI bool
 ADDCALL psmove_has_calibration(PSMove *move);
 
+/**
+ * \brief Load the calibration of the controller again.
+ *
+ * Reads the calibration store (see psmove_has_calibration()) again and
+ * applies the stored calibration of this controller (sensor calibration,
+ * gyroscope bias table and magnetometer calibration). Use this to pick up
+ * calibration data that another process (e.g. the \c psmove utility) stored
+ * while this controller was connected, without reconnecting it.
+ *
+ * \param move A valid \ref PSMove handle
+ *
+ * \return \ref true if all calibration data was loaded
+ * \return \ref false if some of it is not in the store (or for replays)
+ **/
+ADDAPI bool
+ADDCALL psmove_reload_calibration(PSMove *move);
+
 /**
  * \brief Dump the calibration information to stdout.
  *
@@ -1247,6 +1653,10 @@ ADDCALL psmove_reset_orientation(PSMove *move);
  * OrientationFusion_ComplementaryMARG - Gyro integration blended with optimized Gravity/Magnetometer alignment
  *  - Suffers no drift
  *  - Con: Most expensive algorithms of the three (but not horrendously so)
+ * OrientationFusion_ESKF - Error-state Kalman filter: Gyro integration + Gravity (and Magnetometer, if available) correction
+ *  - Estimates the gyroscope bias, integrates over the measured time between reports
+ *  - Provides an uncertainty estimate, see psmove_get_orientation_covariance()
+ *  - Con: Somewhat more expensive than the Madgwick filters
 
  * \param move A valid \ref PSMove handle
  * \param fusion_type The orientation fusion algorithm denoted by the \ref PSMoveOrientation_Fusion_Type enum
@@ -1254,6 +1664,107 @@ ADDCALL psmove_reset_orientation(PSMove *move);
 ADDAPI void
 ADDCALL psmove_set_orientation_fusion_type(PSMove *move, enum PSMoveOrientation_Fusion_Type fusion_type);
 
+/**
+ * \brief Get the uncertainty of the current orientation estimate.
+ *
+ * This is only available with the \ref OrientationFusion_ESKF fusion type
+ * (see psmove_set_orientation_fusion_type()), which keeps track of the
+ * covariance of its error state. The error state consists of the orientation
+ * error (a small rotation in radians, in the sensor data basis) and the
+ * error of the estimated gyroscope bias (in rad/s).
+ *
+ * The square root of the sum of the first three diagonal entries is a
+ * rough estimate of the orientation error in radians, which can be used
+ * to ignore the orientation while the filter has not converged yet.
+ *
+ * \param move A valid \ref PSMove handle
+ * \param covariance Array of 36 floats that receives the 6x6 covariance
+ *                   matrix in row-major order
+ *
+ * \return \ref true on success
+ * \return \ref false if orientation tracking is not available or uses a different fusion type
+ **/
+ADDAPI bool
+ADDCALL psmove_get_orientation_covariance(PSMove *move, float *covariance);
+
+/**
+ * \brief Enable or disable the temperature-dependent gyroscope bias estimation.
+ *
+ * The gyroscope of the controller drifts with its temperature, e.g. while it
+ * warms up after being switched on. The drift value from the calibration
+ * stored on the controller was measured at one temperature only.
+ *
+ * With the bias estimation enabled (the default), the gyroscope reading is
+ * averaged whenever the controller is at rest for about a second. The result
+ * is stored in a table indexed by the controller temperature (see
+ * psmove_get_temperature_in_celsius()), which is saved next to the calibration
+ * file of the controller in psmove_disconnect() and loaded again when
+ * connecting. The gyroscope readings (and with that the orientation) are
+ * corrected with the bias for the current temperature, interpolated from
+ * nearby temperatures if there is no estimate for it yet.
+ *
+ * \param move A valid \ref PSMove handle
+ * \param enabled \ref true to estimate the bias, \ref false to use the drift
+ *                value from the controller calibration only
+ **/
+ADDAPI void
+ADDCALL psmove_set_gyroscope_bias_estimation(PSMove *move, bool enabled);
+
+/**
+ * \brief Get the gyroscope bias estimated by the orientation filter.
+ *
+ * This is only available with the \ref OrientationFusion_ESKF fusion type.
+ * The bias is in rad/s, in the sensor data basis, and is already subtracted
+ * from the gyroscope readings by the filter.
+ *
+ * \param move A valid \ref PSMove handle
+ * \param out_bias Receives the estimated gyroscope bias
+ *
+ * \return \ref true on success
+ * \return \ref false if orientation tracking is not available or uses a different fusion type
+ **/
+ADDAPI bool
+ADDCALL psmove_get_gyroscope_bias(PSMove *move, PSMove_3AxisVector *out_bias);
+
+/**
+ * \brief Predict the orientation at a given time.
+ *
+ * The orientation returned by psmove_get_orientation() is the one at the
+ * sampling time of the last report (see psmove_get_sample_time_us()), so by
+ * the time a frame is displayed, it is one poll interval plus the transport
+ * delay old. This function extrapolates the orientation to \a time_us using
+ * the latest angular velocity and angular acceleration of the controller,
+ * e.g. to the expected display time of the frame that is being rendered.
+ *
+ * The prediction is limited to the horizon set with
+ * psmove_set_orientation_prediction_horizon(). For times before the last
+ * sample, the current orientation is returned.
+ *
+ * \param move A valid \ref PSMove handle
+ * \param time_us Time to predict the orientation for, on the host monotonic
+ *                clock (see psmove_util_get_time_us())
+ * \param w A pointer to store the w part of the orientation quaternion
+ * \param x A pointer to store the x part of the orientation quaternion
+ * \param y A pointer to store the y part of the orientation quaternion
+ * \param z A pointer to store the z part of the orientation quaternion
+ **/
+ADDAPI void
+ADDCALL psmove_get_predicted_orientation(PSMove *move, uint64_t time_us,
+        float *w, float *x, float *y, float *z);
+
+/**
+ * \brief Set the longest time to extrapolate the orientation ahead.
+ *
+ * Limits how far psmove_get_predicted_orientation() extrapolates beyond the
+ * last sample, so that a stalled connection doesn't keep the orientation
+ * spinning. The default is 50 ms; 0 disables the prediction.
+ *
+ * \param move A valid \ref PSMove handle
+ * \param horizon_us The maximum prediction time in microseconds
+ **/
+ADDAPI void
+ADDCALL psmove_set_orientation_prediction_horizon(PSMove *move, uint32_t horizon_us);
+
 /**
  * \brief Set a common transform used on the calibration data in the psmove_get_transform_<sensor>_... methods
  *
@@ -1501,6 +2012,19 @@ ADDCALL psmove_reinit();
 ADDAPI long
 ADDCALL psmove_util_get_ticks();
 
+/**
+ * \brief Get the current time of the host's monotonic clock.
+ *
+ * This is the clock used for psmove_get_sample_time_us() and
+ * psmove_get_arrival_time_us(). On Linux, it is the same as
+ * \c clock_gettime(CLOCK_MONOTONIC), so it can be compared to
+ * other timestamps of the system.
+ *
+ * \return Time (in microseconds) of the monotonic clock
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_util_get_time_us();
+
 /**
  * \brief Get local save directory for settings.
  *
@@ -116,6 +116,28 @@ ADDAPI void
 ADDCALL psmove_fusion_get_position(PSMoveFusion *fusion, PSMove *move,
         float *x, float *y, float *z);
 
+/**
+ * \brief Get the modelview matrix predicted for a given time
+ *
+ * Like psmove_fusion_get_modelview_matrix(), but with the orientation from
+ * psmove_get_predicted_orientation() and the position from
+ * psmove_tracker_get_predicted_position() at \a time_us (on the host
+ * monotonic clock, see psmove_util_get_time_us()).
+ **/
+ADDAPI float *
+ADDCALL psmove_fusion_get_predicted_modelview_matrix(PSMoveFusion *fusion, PSMove *move,
+        uint64_t time_us);
+
+/**
+ * \brief Get the position predicted for a given time
+ *
+ * Like psmove_fusion_get_position(), but with the position from
+ * psmove_tracker_get_predicted_position() at \a time_us.
+ **/
+ADDAPI void
+ADDCALL psmove_fusion_get_predicted_position(PSMoveFusion *fusion, PSMove *move,
+        uint64_t time_us, float *x, float *y, float *z);
+
 /**
  * \brief Destroy an existing fusion instance and free allocated resources
  *
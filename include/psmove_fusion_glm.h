@@ -41,6 +41,14 @@ psmove_fusion_get_position_vec3(PSMoveFusion *fusion, PSMove *move)
     return result;
 }
 
+static inline glm::vec3
+psmove_fusion_get_predicted_position_vec3(PSMoveFusion *fusion, PSMove *move, uint64_t time_us)
+{
+    glm::vec3 result { 0.f, 0.f, 0.f };
+    psmove_fusion_get_predicted_position(fusion, move, time_us, &result.x, &result.y, &result.z);
+    return result;
+}
+
 static inline glm::mat4
 psmove_fusion_get_projection_matrix_mat4(PSMoveFusion *fusion)
 {
@@ -66,3 +74,16 @@ psmove_fusion_get_modelview_matrix_mat4(PSMoveFusion *fusion, PSMove *move)
 
     return result;
 }
+
+static inline glm::mat4
+psmove_fusion_get_predicted_modelview_matrix_mat4(PSMoveFusion *fusion, PSMove *move, uint64_t time_us)
+{
+    glm::mat4 result { 0.f };
+
+    float *m = psmove_fusion_get_predicted_modelview_matrix(fusion, move, time_us);
+    for (int i=0; i<16; ++i) {
+        result[i/4][i%4] = m[i];
+    }
+
+    return result;
+}
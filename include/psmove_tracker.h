@@ -71,6 +71,19 @@ enum PSMoveTracker_Status {
     Tracker_TRACKING, /*!< Calibrated and successfully tracked in the camera */
 };
 
+/*! Method used to estimate the position and radius of the sphere from its blob */
+enum PSMoveTracker_CircleEstimator {
+    CircleEstimator_FarthestPair, /*!< Center and distance of the most distant pair of sampled outline points */
+    CircleEstimator_AlgebraicFit, /*!< Least-squares circle fit to the blob's edge points, ignoring occluded parts */
+};
+
+/*! Where the sphere of a tracked controller is searched in the next frame */
+enum PSMoveTracker_ROIPrediction {
+    ROIPrediction_None, /*!< Around its last position, sized by its radius */
+    ROIPrediction_MotionModel, /*!< Around the position predicted by a constant-velocity model, sized by the prediction's uncertainty */
+    ROIPrediction_IMUAided, /*!< Like ROIPrediction_MotionModel, plus the distance the measured acceleration could move the sphere */
+};
+
 /* A structure to retain the tracker settings. Typically these do not change after init & calib.*/
 typedef struct {
 
@@ -98,6 +111,10 @@ typedef struct {
     int tracker_adaptive_z;                     /* [1] specifies to use a adaptive z smoothing  */
     float color_adaption_quality_t;             /* [35] maximal distance (calculated by 'psmove_tracker_hsvcolor_diff') between the first estimated color and the newly estimated  */
     float color_update_rate;                    /* [1] every x seconds adapt to the color, 0 means no adaption  */
+    float prediction_horizon_ms;                /* [50] longest extrapolation of psmove_tracker_get_predicted_position(), 0 disables it */
+    bool tracker_shared_segmentation;           /* [true] convert each frame to HSV once and segment all controllers in one pass */
+    enum PSMoveTracker_CircleEstimator circle_estimator; /* [CircleEstimator_FarthestPair] how to get the sphere position and radius from the blob */
+    enum PSMoveTracker_ROIPrediction roi_prediction; /* [ROIPrediction_MotionModel] where to search the sphere in the next frame */
     // size of "search" tiles when tracking is lost
     int search_tile_width;                      /* [0=auto] width of a single tile */
     int search_tile_height;                     /* height of a single tile */
@@ -492,6 +509,45 @@ ADDAPI int
 ADDCALL psmove_tracker_get_position(PSMoveTracker *tracker,
         PSMove *move, float *x, float *y, float *radius);
 
+/**
+ * \brief Predict the position and radius of a tracked controller
+ *
+ * Extrapolates the position returned by psmove_tracker_get_position() to
+ * \a time_us with the velocity of the controller in the camera image,
+ * estimated from the positions in the previous frames. The time of a position
+ * is the time its camera frame was retrieved by psmove_tracker_update_image().
+ * The prediction is limited to \c prediction_horizon_ms of the tracker settings.
+ *
+ * \param tracker A valid \ref PSMoveTracker handle
+ * \param move A valid \ref PSMove handle
+ * \param time_us Time to predict the position for, on the host monotonic
+ *                clock (see psmove_util_get_time_us())
+ * \param x Pointer to store the predicted X coordinate, or \c NULL
+ * \param y Pointer to store the predicted Y coordinate, or \c NULL
+ * \param radius Pointer to store the predicted radius, or \c NULL
+ *
+ * \return 1 on success, 0 if the controller is not registered with the tracker
+ **/
+ADDAPI int
+ADDCALL psmove_tracker_get_predicted_position(PSMoveTracker *tracker, PSMove *move,
+        uint64_t time_us, float *x, float *y, float *radius);
+
+/**
+ * \brief Get the time of the current camera frame
+ *
+ * This is the time when the current frame was retrieved by
+ * psmove_tracker_update_image(), on the host monotonic clock (see
+ * psmove_util_get_time_us()). Pass it to psmove_get_history_at() to get
+ * the sensor readings and orientation of a controller matching the
+ * positions found by psmove_tracker_update().
+ *
+ * \param tracker A valid \ref PSMoveTracker handle
+ *
+ * \return The frame time in microseconds, or 0 if no frame was retrieved yet
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_tracker_get_frame_time_us(PSMoveTracker *tracker);
+
 /**
  * \brief Get the camera image size for the tracker
  *
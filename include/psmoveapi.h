@@ -35,6 +35,13 @@ extern "C" {
 
 #include "psmove.h"
 
+/* Name of the environment variable listing capture files to replay as
+ * additional controllers (separated like PATH, see psmove_connect_replay()) */
+#define PSMOVEAPI_REPLAY_ENV "PSMOVEAPI_REPLAY"
+
+/* Name of the environment variable for the replay speed factor (default 1) */
+#define PSMOVEAPI_REPLAY_SPEED_ENV "PSMOVEAPI_REPLAY_SPEED"
+
 struct Vec3 {
     float x;
     float y;
@@ -76,12 +83,50 @@ struct EventReceiver {
     void (*disconnect)(struct Controller *controller, void *user_data);
 };
 
+struct PSMoveAPISettings {
+    // If nonzero, reading input and writing LEDs/rumble is done on a
+    // background thread per controller instead of in psmoveapi_update();
+    // psmoveapi_update() must still be called regularly for hotplug events
+    int threaded;
+
+    // Threaded mode only: Number of worker threads that run the callbacks
+    // of EventReceiver. Callbacks for the same controller never run at the
+    // same time and are delivered in order, but callbacks for different
+    // controllers may run concurrently. If zero, callbacks are queued and
+    // delivered on the caller's thread in psmoveapi_update().
+    int callback_threads;
+
+    // Minimum time (in microseconds) between two LED/rumble writes to any
+    // controller, so that writes are spread out instead of being sent in a
+    // burst (which delays input on a shared Bluetooth adapter). Changes are
+    // coalesced until it's a controller's turn. Zero uses a default of 2 ms,
+    // negative values disable spacing. In the unthreaded mode,
+    // psmoveapi_update() sends all pending writes and sleeps for the spacing
+    // between them, so it can take up to (number of controllers) * spacing.
+    // In threaded mode, each controller's I/O thread sends its own writes.
+    int output_spacing_us;
+};
+
 ADDAPI void
 ADDCALL psmoveapi_init(struct EventReceiver *receiver, void *user_data);
 
+// Like psmoveapi_init(), settings can be NULL for the default (unthreaded) mode
+ADDAPI void
+ADDCALL psmoveapi_init_with_settings(struct EventReceiver *receiver, void *user_data,
+        const struct PSMoveAPISettings *settings);
+
 ADDAPI void
 ADDCALL psmoveapi_update();
 
+// Block until new controller data or a hotplug event is available, or
+// until timeout_ms milliseconds have passed (negative: wait forever).
+// In threaded mode, this waits for queued callbacks (if there are no
+// callback threads) or hotplug events instead of controller data.
+// Call psmoveapi_update() afterwards to process the new data.
+// Returns true if there is something to process, false on timeout.
+ADDAPI bool
+ADDCALL psmoveapi_wait(int timeout_ms);
+
 ADDAPI void
 ADDCALL psmoveapi_quit();
 
@@ -134,9 +179,13 @@ _handler_receiver = {
 class PSMoveAPI {
 public:
     PSMoveAPI(Handler *handler) { psmoveapi_init(&_handler_receiver, handler); }
+    PSMoveAPI(Handler *handler, const PSMoveAPISettings &settings) {
+        psmoveapi_init_with_settings(&_handler_receiver, handler, &settings);
+    }
     ~PSMoveAPI() { psmoveapi_quit(); }
 
     void update() { psmoveapi_update(); }
+    bool wait(int timeout_ms) { return psmoveapi_wait(timeout_ms); }
 };
 
 }; // namespace psmoveapi
@@ -37,6 +37,7 @@
 #include "../psmove_sockets.h"
 #include "../psmove_private.h"
 #include "../psmove_port.h"
+#include "../psmove_scheduler.h"
 
 #include "psmove_moved_protocol.h"
 #include "moved_monitor.h"
@@ -50,6 +51,7 @@
 #endif
 
 #include <vector>
+#include <algorithm>
 
 struct move_daemon;
 
@@ -61,11 +63,10 @@ struct psmove_dev {
 
     PSMove *move;
     int assigned_id;
+    PSMoveScheduler *scheduler;
 
     unsigned char input[sizeof(PSMoveMovedResponse::read_input)];
     unsigned char output[sizeof(PSMoveMovedRequest::payload)];
-
-    int dirty_output;
 };
 
 struct moved_server {
@@ -91,8 +92,11 @@ struct move_daemon : public moved_server {
     void handle_disconnect(const char *path);
 
     void write_reports();
+    uint32_t get_write_timeout_ms();
     void dump_devices();
     int get_next_id();
+
+    PSMoveScheduler *scheduler;
 };
 
 
@@ -184,7 +188,9 @@ main(int argc, char *argv[])
         // so any monitor events might only be visible to clients
         // once they send UDP requests. In the future, using
         // select() from WinSock2 might be an option (or using
-        // threads and blocking I/O).
+        // threads and blocking I/O). Deferred output writes are
+        // sent when recvfrom() times out.
+        psmove_port_set_socket_timeout_ms(moved.get_socket(), moved.get_write_timeout_ms());
         moved.handle_request();
         if (moved_monitor_wait(monitor, false)) {
             moved_monitor_poll(monitor);
@@ -328,7 +334,7 @@ moved_server::~moved_server()
 
 
 psmove_dev::psmove_dev(move_daemon *moved, const char *path, const wchar_t *serial)
-    : dirty_output(0)
+    : scheduler(moved->scheduler)
 {
     if (path != NULL) {
         // TODO: FIXME: This should use the device's actual USB product ID.
@@ -343,23 +349,28 @@ psmove_dev::psmove_dev(move_daemon *moved, const char *path, const wchar_t *seri
     assigned_id = moved->get_next_id();
 
     psmove_set_rate_limiting(move, false);
+
+    // Clients send keep-alive updates themselves, so only write changes
+    psmove_scheduler_add(scheduler, this, 0, 0);
 }
 
 void
 psmove_dev::set_output(const unsigned char *output)
 {
     memcpy(this->output, output, sizeof(this->output));
-    dirty_output++;
+    psmove_scheduler_mark_dirty(scheduler, this);
 }
 
 psmove_dev::~psmove_dev()
 {
+    psmove_scheduler_remove(scheduler, this);
     psmove_disconnect(move);
 }
 
 
 move_daemon::move_daemon()
     : moved_server()
+    , scheduler(psmove_scheduler_new(PSMOVE_SCHEDULER_DEFAULT_SPACING_US))
 {
 }
 
@@ -423,13 +434,28 @@ move_daemon::handle_disconnect(const char *path)
 void
 move_daemon::write_reports()
 {
-    for (psmove_dev *dev: devs) {
-        /* Send new outputs for devices with "dirty" output */
-        if (dev->dirty_output) {
-            _psmove_write_data(dev->move, dev->output, sizeof(dev->output));
-            dev->dirty_output = 0;
-        }
+    /* Send new outputs, spread out so that they don't delay input reports */
+    void *key;
+    while ((key = psmove_scheduler_next(scheduler, psmove_port_get_time_us())) != NULL) {
+        psmove_dev *dev = static_cast<psmove_dev *>(key);
+        _psmove_write_data(dev->move, dev->output, sizeof(dev->output));
+    }
+}
+
+uint32_t
+move_daemon::get_write_timeout_ms()
+{
+    uint64_t due_us = psmove_scheduler_get_next_due_us(scheduler, NULL);
+    if (due_us == UINT64_MAX) {
+        /* No write pending, block until the next request */
+        return 0;
     }
+
+    /* A timeout of 0 would block, so wait at least 1 ms */
+    uint64_t now_us = psmove_port_get_time_us();
+    uint64_t due_ms = (due_us > now_us) ? (due_us - now_us + 999) / 1000 : 1;
+
+    return (uint32_t)std::min(due_ms, (uint64_t)UINT32_MAX);
 }
 
 move_daemon::~move_daemon()
@@ -437,4 +463,6 @@ move_daemon::~move_daemon()
     for (psmove_dev *dev: devs) {
         delete dev;
     }
+
+    psmove_scheduler_free(scheduler);
 }
@@ -0,0 +1,81 @@
+#pragma once
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/* Fixed-point math, used instead of floats in PSMOVE_USE_FIXED_POINT builds (see _psmove_set_fixed_point()) */
+
+//-- includes -----
+#include <stdint.h>
+
+//-- constants -----
+/* 16.16 fixed-point, for calibrated sensor readings (in g and rad/s) */
+#define PSMOVE_Q16_ONE ((int32_t)1 << 16)
+
+/* 2.30 fixed-point, for unit vectors and quaternions (range -2..2) */
+#define PSMOVE_Q30_ONE ((int32_t)1 << 30)
+
+//-- definitions -----
+typedef int32_t psmove_q16;
+typedef int32_t psmove_q30;
+
+//-- interface -----
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Convert from float, saturating at the limits of the format */
+psmove_q16 psmove_q16_from_float(float x);
+psmove_q30 psmove_q30_from_float(float x);
+
+/* Integer square root: floor(sqrt(x)), sqrt of a 4.60 value is 2.30 */
+uint32_t psmove_fixed_sqrt(uint64_t x);
+
+#ifdef __cplusplus
+}
+#endif
+
+//-- inline functions -----
+static inline float
+psmove_q16_to_float(psmove_q16 x)
+{
+    return (float)x * (1.f / PSMOVE_Q16_ONE);
+}
+
+static inline float
+psmove_q30_to_float(psmove_q30 x)
+{
+    return (float)x * (1.f / PSMOVE_Q30_ONE);
+}
+
+/* Rounded product of two 2.30 values */
+static inline psmove_q30
+psmove_q30_mul(psmove_q30 a, psmove_q30 b)
+{
+    return (psmove_q30)(((int64_t)a * b + ((int64_t)1 << 29)) >> 30);
+}
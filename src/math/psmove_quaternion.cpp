@@ -102,4 +102,19 @@ psmove_vector3f_clockwise_rotate(const glm::quat &q, const glm::vec3 &v)
 	// GLM rotates counterclockwise (i.e. q*v*q^-1), 
 	// while we want the inverse of that (q^-1*v*q)
     return glm::conjugate(q) * v;
-}
\ No newline at end of file
+}
+
+glm::quat
+psmove_quaternion_from_rotation_vector(const glm::vec3 &rotation)
+{
+	// Rotation about the axis of the vector, by its length (in radians)
+	float angle = glm::length(rotation);
+
+	if (is_nearly_zero(angle))
+	{
+		// Small angle approximation: sin(angle/2)/angle ~= 1/2
+		return glm::normalize(glm::quat(1.f, rotation.x*0.5f, rotation.y*0.5f, rotation.z*0.5f));
+	}
+
+	return glm::angleAxis(angle, rotation / angle);
+}
@@ -59,5 +59,8 @@ psmove_quaternion_is_valid(const glm::quat &q);
 glm::vec3
 psmove_vector3f_clockwise_rotate(const glm::quat &q, const glm::vec3 &v);
 
+glm::quat
+psmove_quaternion_from_rotation_vector(const glm::vec3 &rotation);
+
 //-- macros -----
 #define assert_quaternion_is_normalized(q) assert(is_nearly_equal(glm::dot(q,q), 1.f, k_normal_epsilon))
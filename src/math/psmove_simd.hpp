@@ -0,0 +1,145 @@
+#pragma once
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+/* Packed float math, used to run the same filter on several controllers at once */
+
+//-- includes -----
+#include <math.h>
+
+#if defined(__AVX__)
+#  include <immintrin.h>
+#  define PSMOVE_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define PSMOVE_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#  include <arm_neon.h>
+#  define PSMOVE_SIMD_NEON
+#endif
+
+//-- constants -----
+/* Number of float lanes processed by one PSMoveSIMDFloat operation */
+#if defined(PSMOVE_SIMD_AVX)
+#  define PSMOVE_SIMD_WIDTH 8
+#elif defined(PSMOVE_SIMD_SSE2) || defined(PSMOVE_SIMD_NEON)
+#  define PSMOVE_SIMD_WIDTH 4
+#else
+#  define PSMOVE_SIMD_WIDTH 1
+#endif
+
+//-- structures -----
+struct PSMoveSIMDFloat
+{
+#if defined(PSMOVE_SIMD_AVX)
+    __m256 v;
+#elif defined(PSMOVE_SIMD_SSE2)
+    __m128 v;
+#elif defined(PSMOVE_SIMD_NEON)
+    float32x4_t v;
+#else
+    float v;
+#endif
+};
+
+//-- inline functions -----
+#if defined(PSMOVE_SIMD_AVX)
+
+static inline PSMoveSIMDFloat psmove_simd_load(const float *p) { return { _mm256_loadu_ps(p) }; }
+static inline void psmove_simd_store(float *p, PSMoveSIMDFloat a) { _mm256_storeu_ps(p, a.v); }
+static inline PSMoveSIMDFloat psmove_simd_set(float f) { return { _mm256_set1_ps(f) }; }
+static inline PSMoveSIMDFloat operator+(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { _mm256_add_ps(a.v, b.v) }; }
+static inline PSMoveSIMDFloat operator-(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { _mm256_sub_ps(a.v, b.v) }; }
+static inline PSMoveSIMDFloat operator*(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { _mm256_mul_ps(a.v, b.v) }; }
+static inline PSMoveSIMDFloat operator/(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { _mm256_div_ps(a.v, b.v) }; }
+static inline PSMoveSIMDFloat psmove_simd_sqrt(PSMoveSIMDFloat a) { return { _mm256_sqrt_ps(a.v) }; }
+
+/* Per lane: (a > b) ? then_value : else_value */
+static inline PSMoveSIMDFloat
+psmove_simd_select_greater(PSMoveSIMDFloat a, PSMoveSIMDFloat b, PSMoveSIMDFloat then_value, PSMoveSIMDFloat else_value)
+{
+    return { _mm256_blendv_ps(else_value.v, then_value.v, _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)) };
+}
+
+#elif defined(PSMOVE_SIMD_SSE2)
+
+static inline PSMoveSIMDFloat psmove_simd_load(const float *p) { return { _mm_loadu_ps(p) }; }
+static inline void psmove_simd_store(float *p, PSMoveSIMDFloat a) { _mm_storeu_ps(p, a.v); }
+static inline PSMoveSIMDFloat psmove_simd_set(float f) { return { _mm_set1_ps(f) }; }
+static inline PSMoveSIMDFloat operator+(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { _mm_add_ps(a.v, b.v) }; }
+static inline PSMoveSIMDFloat operator-(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { _mm_sub_ps(a.v, b.v) }; }
+static inline PSMoveSIMDFloat operator*(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { _mm_mul_ps(a.v, b.v) }; }
+static inline PSMoveSIMDFloat operator/(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { _mm_div_ps(a.v, b.v) }; }
+static inline PSMoveSIMDFloat psmove_simd_sqrt(PSMoveSIMDFloat a) { return { _mm_sqrt_ps(a.v) }; }
+
+/* Per lane: (a > b) ? then_value : else_value */
+static inline PSMoveSIMDFloat
+psmove_simd_select_greater(PSMoveSIMDFloat a, PSMoveSIMDFloat b, PSMoveSIMDFloat then_value, PSMoveSIMDFloat else_value)
+{
+    __m128 mask = _mm_cmpgt_ps(a.v, b.v);
+    return { _mm_or_ps(_mm_and_ps(mask, then_value.v), _mm_andnot_ps(mask, else_value.v)) };
+}
+
+#elif defined(PSMOVE_SIMD_NEON)
+
+static inline PSMoveSIMDFloat psmove_simd_load(const float *p) { return { vld1q_f32(p) }; }
+static inline void psmove_simd_store(float *p, PSMoveSIMDFloat a) { vst1q_f32(p, a.v); }
+static inline PSMoveSIMDFloat psmove_simd_set(float f) { return { vdupq_n_f32(f) }; }
+static inline PSMoveSIMDFloat operator+(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { vaddq_f32(a.v, b.v) }; }
+static inline PSMoveSIMDFloat operator-(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { vsubq_f32(a.v, b.v) }; }
+static inline PSMoveSIMDFloat operator*(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { vmulq_f32(a.v, b.v) }; }
+static inline PSMoveSIMDFloat operator/(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { vdivq_f32(a.v, b.v) }; }
+static inline PSMoveSIMDFloat psmove_simd_sqrt(PSMoveSIMDFloat a) { return { vsqrtq_f32(a.v) }; }
+
+/* Per lane: (a > b) ? then_value : else_value */
+static inline PSMoveSIMDFloat
+psmove_simd_select_greater(PSMoveSIMDFloat a, PSMoveSIMDFloat b, PSMoveSIMDFloat then_value, PSMoveSIMDFloat else_value)
+{
+    return { vbslq_f32(vcgtq_f32(a.v, b.v), then_value.v, else_value.v) };
+}
+
+#else
+
+static inline PSMoveSIMDFloat psmove_simd_load(const float *p) { return { *p }; }
+static inline void psmove_simd_store(float *p, PSMoveSIMDFloat a) { *p = a.v; }
+static inline PSMoveSIMDFloat psmove_simd_set(float f) { return { f }; }
+static inline PSMoveSIMDFloat operator+(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { a.v + b.v }; }
+static inline PSMoveSIMDFloat operator-(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { a.v - b.v }; }
+static inline PSMoveSIMDFloat operator*(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { a.v * b.v }; }
+static inline PSMoveSIMDFloat operator/(PSMoveSIMDFloat a, PSMoveSIMDFloat b) { return { a.v / b.v }; }
+static inline PSMoveSIMDFloat psmove_simd_sqrt(PSMoveSIMDFloat a) { return { sqrtf(a.v) }; }
+
+/* Per lane: (a > b) ? then_value : else_value */
+static inline PSMoveSIMDFloat
+psmove_simd_select_greater(PSMoveSIMDFloat a, PSMoveSIMDFloat b, PSMoveSIMDFloat then_value, PSMoveSIMDFloat else_value)
+{
+    return { (a.v > b.v) ? then_value.v : else_value.v };
+}
+
+#endif
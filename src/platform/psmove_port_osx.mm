@@ -33,7 +33,13 @@
 #include "psmove_format.h"
 
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include <string>
 #include <iostream>
@@ -324,6 +330,18 @@ psmove_port_get_time_ms()
     return (now - startup_time);
 }
 
+uint64_t
+psmove_port_get_time_us()
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        return 0;
+    }
+
+    return ((uint64_t)ts.tv_sec * 1000 * 1000 + ts.tv_nsec / 1000);
+}
+
 void
 psmove_port_set_socket_timeout_ms(int socket, uint32_t timeout_ms)
 {
@@ -346,6 +364,129 @@ psmove_port_close_socket(int socket)
     close(socket);
 }
 
+const void *
+psmove_port_map_file(const char *filename, size_t *size)
+{
+    struct stat st;
+    void *data;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+
+    data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping stays valid after closing the file
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    *size = st.st_size;
+    return data;
+}
+
+void
+psmove_port_unmap_file(const void *data, size_t size)
+{
+    munmap((void *)data, size);
+}
+
+bool
+psmove_port_replace_file(const char *from, const char *to)
+{
+    return rename(from, to) == 0;
+}
+
+char *
+psmove_port_write_temporary_file(const char *filename, const void *data, size_t size)
+{
+    size_t length = strlen(filename) + 8;
+    char *result = (char *)malloc(length);
+    snprintf(result, length, "%s.XXXXXX", filename);
+
+    int fd = mkstemp(result);
+    if (fd == -1) {
+        free(result);
+        return NULL;
+    }
+
+    // mkstemp() creates the file readable by the owner only
+    struct stat st;
+    fchmod(fd, (stat(filename, &st) == 0) ? (st.st_mode & 0777) : 0644);
+
+    const char *pos = (const char *)data;
+    bool ok = true;
+    while (size > 0) {
+        ssize_t written = write(fd, pos, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            ok = false;
+            break;
+        }
+
+        pos += written;
+        size -= written;
+    }
+
+    // Make sure the contents are on disk before the file replaces another
+    // (fsync() only flushes to the drive, not out of its cache)
+    ok = ok && (fcntl(fd, F_FULLFSYNC) == 0 || fsync(fd) == 0);
+    ok = (close(fd) == 0) && ok;
+
+    if (!ok) {
+        unlink(result);
+        free(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+struct _PSMoveFileLock {
+    int fd;
+};
+
+PSMoveFileLock *
+psmove_port_lock_file(const char *filename)
+{
+    int fd = open(filename, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    while (flock(fd, LOCK_EX) != 0) {
+        if (errno != EINTR) {
+            close(fd);
+            return NULL;
+        }
+    }
+
+    PSMoveFileLock *lock = (PSMoveFileLock *)calloc(1, sizeof(PSMoveFileLock));
+    lock->fd = fd;
+    return lock;
+}
+
+void
+psmove_port_unlock_file(PSMoveFileLock *lock)
+{
+    psmove_return_if_fail(lock != NULL);
+
+    flock(lock->fd, LOCK_UN);
+    close(lock->fd);
+    free(lock);
+}
+
 char *
 psmove_port_get_host_bluetooth_address()
 {
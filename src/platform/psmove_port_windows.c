@@ -768,6 +768,27 @@ psmove_port_get_time_ms()
     return (uint64_t)((now.QuadPart - startup_time.QuadPart) * 1000 / frequency.QuadPart);
 }
 
+uint64_t
+psmove_port_get_time_us()
+{
+    static LARGE_INTEGER frequency = { .QuadPart = 0 };
+    LARGE_INTEGER now;
+
+    if (frequency.QuadPart == 0) {
+        if (!QueryPerformanceFrequency(&frequency)) {
+            return 0;
+        }
+    }
+
+    if (!QueryPerformanceCounter(&now)) {
+        return 0;
+    }
+
+    /* Split the conversion to avoid overflowing for large counter values */
+    return (uint64_t)((now.QuadPart / frequency.QuadPart) * 1000 * 1000 +
+            (now.QuadPart % frequency.QuadPart) * 1000 * 1000 / frequency.QuadPart);
+}
+
 void
 psmove_port_set_socket_timeout_ms(int socket, uint32_t timeout_ms)
 {
@@ -805,6 +826,146 @@ psmove_port_close_socket(int socket)
     closesocket(socket);
 }
 
+const void *
+psmove_port_map_file(const char *filename, size_t *size)
+{
+    LARGE_INTEGER file_size;
+    char *data = NULL;
+    size_t offset = 0;
+
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0 ||
+            (uint64_t)file_size.QuadPart > SIZE_MAX) {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    // Read into memory instead of mapping, as a file that is mapped by any
+    // process can't be replaced (psmove_port_replace_file() would fail)
+    data = (char *)malloc((size_t)file_size.QuadPart);
+    while (data != NULL && offset < (size_t)file_size.QuadPart) {
+        size_t remaining = (size_t)file_size.QuadPart - offset;
+        DWORD chunk = (remaining > MAXDWORD) ? MAXDWORD : (DWORD)remaining;
+        DWORD read = 0;
+
+        if (!ReadFile(file, data + offset, chunk, &read, NULL) || read == 0) {
+            free(data);
+            data = NULL;
+            break;
+        }
+
+        offset += read;
+    }
+
+    CloseHandle(file);
+
+    if (data != NULL) {
+        *size = (size_t)file_size.QuadPart;
+    }
+
+    return data;
+}
+
+void
+psmove_port_unmap_file(const void *data, size_t size)
+{
+    (void)size;
+
+    free((void *)data);
+}
+
+bool
+psmove_port_replace_file(const char *from, const char *to)
+{
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+char *
+psmove_port_write_temporary_file(const char *filename, const void *data, size_t size)
+{
+    static volatile LONG counter = 0;
+
+    size_t length = strlen(filename) + 32;
+    char *result = (char *)malloc(length);
+    HANDLE file = INVALID_HANDLE_VALUE;
+    int i;
+
+    for (i=0; i<100 && file == INVALID_HANDLE_VALUE; i++) {
+        snprintf(result, length, "%s.%lu.%ld.tmp", filename,
+                (unsigned long)GetCurrentProcessId(), (long)InterlockedIncrement(&counter));
+
+        file = CreateFileA(result, GENERIC_WRITE, 0, NULL, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE && GetLastError() != ERROR_FILE_EXISTS) {
+            break;
+        }
+    }
+
+    if (file == INVALID_HANDLE_VALUE) {
+        free(result);
+        return NULL;
+    }
+
+    DWORD written = 0;
+    bool ok = WriteFile(file, data, (DWORD)size, &written, NULL) && written == size;
+
+    // Make sure the contents are on disk before the file replaces another
+    ok = ok && FlushFileBuffers(file);
+    ok = CloseHandle(file) && ok;
+
+    if (!ok) {
+        DeleteFileA(result);
+        free(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+struct _PSMoveFileLock {
+    HANDLE file;
+};
+
+PSMoveFileLock *
+psmove_port_lock_file(const char *filename)
+{
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+
+    HANDLE file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    if (!LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped)) {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    PSMoveFileLock *lock = (PSMoveFileLock *)calloc(1, sizeof(PSMoveFileLock));
+    lock->file = file;
+    return lock;
+}
+
+void
+psmove_port_unlock_file(PSMoveFileLock *lock)
+{
+    psmove_return_if_fail(lock != NULL);
+
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(overlapped));
+
+    UnlockFileEx(lock->file, 0, 1, 0, &overlapped);
+    CloseHandle(lock->file);
+    free(lock);
+}
+
 char *
 psmove_port_get_host_bluetooth_address()
 {
@@ -31,8 +31,15 @@
 #include "psmove_port.h"
 #include "psmove_private.h"
 #include "psmove_calibration.h"
+#include "psmove_calibration_store.h"
+#include "psmove_capture.h"
+#include "psmove_clock.h"
+#include "psmove_history.h"
+#include "psmove_magnetometer.h"
 #include "psmove_orientation.h"
+#include "psmove_reader.h"
 #include "math/psmove_vector.h"
+#include "math/psmove_fixed.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -49,6 +56,14 @@
 #include "daemon/moved_client.h"
 #include "hidapi.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define PSMOVE_DECODE_SSE2
+#elif defined(__ARM_NEON) && defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#  include <arm_neon.h>
+#  define PSMOVE_DECODE_NEON
+#endif
+
 /* Begin private definitions */
 
 /* Buffer size for writing LEDs and reading sensor data */
@@ -71,11 +86,21 @@
 /* Buffer size for sending/retrieving a request to an extension device */
 #define PSMOVE_EXT_DEVICE_REPORT_SIZE 49
 
-/* Maximum milliseconds to inhibit further updates to LEDs if not changed */
-#define PSMOVE_MAX_LED_INHIBIT_MS 4000
+/* Maximum time (in milliseconds) to block in psmove_wait_any() for remote controllers */
+#define PSMOVE_MAX_REMOTE_WAIT_MS 5
+
+/* Number of orientations collected by psmove_poll_many() per fusion batch */
+#define PSMOVE_POLL_MANY_BATCH_SIZE 16
+
+/* Default limit of psmove_get_predicted_orientation() (in microseconds) */
+#define PSMOVE_DEFAULT_PREDICTION_HORIZON_US 50000
 
-/* Minimum time (in milliseconds) between two LED updates (rate limiting) */
-#define PSMOVE_MIN_LED_UPDATE_WAIT_MS 120
+/* Whether new controllers use fixed-point math (see _psmove_set_fixed_point()) */
+#if defined(PSMOVE_USE_FIXED_POINT)
+#define PSMOVE_FIXED_POINT_DEFAULT true
+#else
+#define PSMOVE_FIXED_POINT_DEFAULT false
+#endif
 
 
 enum PSMove_Request_Type {
@@ -113,6 +138,7 @@ enum PSMove_Request_Type {
 enum PSMove_Device_Type {
     PSMove_HIDAPI = 0x01,
     PSMove_MOVED = 0x02,
+    PSMove_REPLAY = 0x03,
 };
 
 enum PSMove_Sensor {
@@ -131,26 +157,8 @@ typedef struct {
     unsigned char _padding[PSMOVE_BUFFER_SIZE-7]; /* must be zero */
 } PSMove_Data_LEDs;
 
-/* Decode 12-bit signed value (assuming two's complement) */
-#define TWELVE_BIT_SIGNED(x) (((x) & 0x800)?(-(((~(x)) & 0xFFF) + 1)):(x))
-
-/* Decode 16-bit signed value from data pointer and offset */
-static inline int
-psmove_decode_16bit(char *data, int offset)
-{
-    unsigned char low = data[offset] & 0xFF;
-    unsigned char high = (data[offset+1]) & 0xFF;
-    return (low | (high << 8)) - 0x8000;
-}
-
-static inline int
-psmove_decode_16bit_twos_complement(char *data, int offset)
-{
-    unsigned char low = data[offset] & 0xFF;
-    unsigned char high = (data[offset+1]) & 0xFF;
-    int value = (low | (high << 8));
-    return (value & 0x8000) ? (-(~value & 0xFFFF) + 1) : value;
-}
+/* Sign-extend a 12-bit two's complement value */
+#define TWELVE_BIT_SIGNED(x) ((int16_t)((((x) & 0xFFF) ^ 0x800) - 0x800))
 
 #define NUM_PSMOVE_PIDS \
     ((sizeof(PSMOVE_PIDS) / sizeof(PSMOVE_PIDS[0])) - 1)
@@ -231,8 +239,68 @@ typedef union {
     PSMove_ZCM2_Data_Input zcm2;
 } PSMove_Data_Input;
 
+/* Number of 16-bit accelerometer and gyroscope values in an input report */
+#define PSMOVE_INPUT_IMU_VALUES 12
+
+/* Sensor values of an input report, decoded once by psmove_decode_input() */
+typedef struct {
+    /**
+     * Raw accelerometer and gyroscope values, indexed by [enum PSMove_Sensor]
+     * [enum PSMove_Frame][axis]. This is the layout of the report, so it can
+     * be decoded in one go. Models with only one frame per report have it
+     * duplicated into both frames.
+     **/
+    int16_t imu[2][2][3];
+
+    /* Raw magnetometer values (zero on models without magnetometer) */
+    int16_t magnetometer[3];
+
+    /* Raw 12-bit temperature value */
+    uint16_t temperature;
+} PSMove_Decoded_Input;
+
+/* 3x4 affine transform, stored by column (with a padding row) for SIMD */
+typedef struct {
+    float columns[4][4];
+} PSMove_Affine_Transform;
+
+/* Fixed-point version of PSMove_Affine_Transform: out (16.16) = matrix (2.30) * raw + offset (16.16) */
+typedef struct {
+    psmove_q30 matrix[3][3];
+    psmove_q16 offset[3];
+} PSMove_Fixed_Affine_Transform;
+
+/* Calibrated sensor values of an input report, see psmove_calibrate_input() */
+typedef struct {
+    /**
+     * Indexed like PSMove_Decoded_Input.imu. "mapped" only has the
+     * calibration applied, "transformed" also has the sensor data transform
+     * (psmove_set_sensor_data_transform()) applied. Only one of the float
+     * and fixed-point versions is filled in, depending on _PSMove.fixed_point.
+     **/
+
+    /* The last element is padding */
+    float mapped[2][2][4];
+    float transformed[2][2][4];
+
+    /* In 16.16 fixed-point, only converted to float when read (see psmove_get_calibrated_frame()) */
+    psmove_q16 mapped_fixed[2][2][3];
+    psmove_q16 transformed_fixed[2][2][3];
+} PSMove_Calibrated_Input;
+
+/* How to decode the input report of a model, indexed by enum PSMove_Model_Type */
+static const struct {
+    uint16_t imu_bias; /* XOR mask that converts IMU values to two's complement */
+    bool single_frame; /* only the first accelerometer/gyroscope frame is valid */
+    bool magnetometer; /* report contains magnetometer values */
+} psmove_input_formats[Model_Count] = {
+    [Model_Unknown] = { 0x0000, true, false },
+    [Model_ZCM1] = { 0x8000, false, true }, /* offset binary */
+    [Model_ZCM2] = { 0x0000, true, false },
+};
+
 struct _PSMove {
-    /* Device type (hidapi-based or moved-based */
+    /* Device type (hidapi-based, moved-based or replayed from a capture) */
     enum PSMove_Device_Type type;
 
     /* The handle to the HIDAPI device */
@@ -240,10 +308,25 @@ struct _PSMove {
 
     hid_device *handle_addr; // Only used by _WIN32. Needed by Win 8.1 to get BT address.
 
+    /* Background reader thread (if threaded reading is enabled), or NULL */
+    PSMoveReader *reader;
+
     /* The handle to the moved client */
     moved_client *client;
     int remote_id;
 
+    /* Capture being replayed (PSMove_REPLAY only) */
+    PSMoveCaptureReader *replay;
+
+    /* Playback speed factor of the replay (0 = as fast as possible) */
+    float replay_speed;
+
+    /* Host time (psmove_port_get_time_us) at which the replay started */
+    uint64_t replay_start_us;
+
+    /* Capture that input and output reports are recorded to, or NULL */
+    PSMoveCaptureWriter *recorder;
+
     /* Index (at connection time) - not exposed yet */
     int id;
 
@@ -251,6 +334,22 @@ struct _PSMove {
     PSMove_Data_LEDs leds;
     PSMove_Data_Input input;
 
+    /* Sensor values of the most recent input report */
+    PSMove_Decoded_Input decoded;
+    PSMove_Calibrated_Input calibrated;
+
+    /* Calibration of each sensor, without and with the sensor data transform */
+    PSMove_Affine_Transform mapped_affine[2];
+    PSMove_Affine_Transform transformed_affine[2];
+    PSMove_Fixed_Affine_Transform mapped_fixed[2];
+    PSMove_Fixed_Affine_Transform transformed_fixed[2];
+
+    /* Calibration mapping and Madgwick IMU fusion in fixed-point (see _psmove_set_fixed_point()) */
+    bool fixed_point;
+
+    /* Transforms sensor data into the user's coordinate system */
+    PSMove_3AxisTransform sensor_transform;
+
     /* Controller hardware model */
     enum PSMove_Model_Type model;
 
@@ -277,15 +376,41 @@ struct _PSMove {
     PSMoveCalibration *calibration;
     PSMoveOrientation *orientation;
 
+    /* Reconstructs sampling times from the device timestamps */
+    PSMoveClock *clock;
+
+    /* Link quality statistics (psmove_get_stats) */
+    PSMove_Stats stats;
+
+    /* Overflow count of the reader already accounted for in stats */
+    unsigned int stats_reader_overflows;
+
+    /* Arrival time of the previous report (for the interval histogram) */
+    uint64_t stats_last_arrival_us;
+
+    /* Reports lost (according to the sequence numbers) right before the current one */
+    int reports_lost_before_input;
+
+    /* Recent samples (psmove_set_history_size), NULL if disabled */
+    PSMoveHistory *history;
+
+    /* Sequence number of a report not yet added to the history (psmove_poll_many) */
+    int history_pending_seq;
+
     /* Is orientation tracking currently enabled? */
     bool orientation_enabled;
 
+    /* Longest extrapolation of psmove_get_predicted_orientation() */
+    uint32_t prediction_horizon_us;
+
 	/* The direction of the magnetic field found during calibration */
 	PSMove_3AxisVector magnetometer_calibration_direction;
 
-    /* Minimum and maximum magnetometer values observed this session */
-    PSMove_3AxisVector magnetometer_min;
-    PSMove_3AxisVector magnetometer_max;
+    /* Hard and soft iron calibration of the magnetometer */
+    PSMove_MagnetometerEllipsoid magnetometer_ellipsoid;
+
+    /* Collects magnetometer readings for the ellipsoid fit while not calibrated, NULL otherwise */
+    PSMoveMagnetometerFit *magnetometer_fit;
 
     enum PSMove_Connection_Type connection_type;
 };
@@ -293,6 +418,9 @@ struct _PSMove {
 bool
 psmove_load_magnetometer_calibration(PSMove *move);
 
+static void
+psmove_update_input_transforms(PSMove *move);
+
 /* End private definitions */
 
 static moved_client_list *clients;
@@ -386,6 +514,14 @@ _psmove_read_data(PSMove *move, unsigned char *data, size_t length)
     }
 }
 
+int
+_psmove_get_reports_lost_before_input(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, 0);
+
+    return move->reports_lost_before_input;
+}
+
 bool
 psmove_is_remote(PSMove *move)
 {
@@ -486,6 +622,7 @@ psmove_connect_internal(const wchar_t *serial, const char *path, int id, unsigne
 {
     PSMove *move = (PSMove*)calloc(1, sizeof(PSMove));
     move->type = PSMove_HIDAPI;
+    move->fixed_point = PSMOVE_FIXED_POINT_DEFAULT;
     move->connection_type = Conn_Unknown;
 
     /* Make sure the first LEDs update will go through (+ init get_ticks) */
@@ -593,6 +730,11 @@ psmove_connect_internal(const wchar_t *serial, const char *path, int id, unsigne
 
     move->calibration = psmove_calibration_new(move);
     move->orientation = psmove_orientation_new(move);
+    move->clock = psmove_clock_new();
+    move->prediction_horizon_us = PSMOVE_DEFAULT_PREDICTION_HORIZON_US;
+
+    move->sensor_transform = *k_psmove_sensor_transform_opengl;
+    psmove_update_input_transforms(move);
 
     switch (move->model) {
         case Model_ZCM1:
@@ -741,6 +883,7 @@ psmove_connect_remote_by_id(int id, moved_client *client, int remote_id)
 {
     PSMove *move = (PSMove*)calloc(1, sizeof(PSMove));
     move->type = PSMove_MOVED;
+    move->fixed_point = PSMOVE_FIXED_POINT_DEFAULT;
 
     // By default, all moved-provided controllers are considered Bluetooth
     move->connection_type = Conn_Bluetooth;
@@ -772,6 +915,11 @@ psmove_connect_remote_by_id(int id, moved_client *client, int remote_id)
     // XXX: Copy calibration remotely if possible
 
     move->orientation = psmove_orientation_new(move);
+    move->clock = psmove_clock_new();
+    move->prediction_horizon_us = PSMOVE_DEFAULT_PREDICTION_HORIZON_US;
+
+    move->sensor_transform = *k_psmove_sensor_transform_opengl;
+    psmove_update_input_transforms(move);
 
     /* Load magnetometer calibration data */
     psmove_load_magnetometer_calibration(move);
@@ -782,6 +930,115 @@ psmove_connect_remote_by_id(int id, moved_client *client, int remote_id)
     return move;
 }
 
+PSMove *
+psmove_connect_replay(const char *filename, float speed)
+{
+    psmove_return_val_if_fail(filename != NULL, NULL);
+
+    PSMoveCaptureReader *replay = psmove_capture_reader_new(filename);
+    if (replay == NULL) {
+        return NULL;
+    }
+
+    enum PSMove_Model_Type model = psmove_capture_reader_get_model(replay);
+    if (model != Model_ZCM1 && model != Model_ZCM2) {
+        PSMOVE_WARNING("Unsupported controller model in capture: %s", filename);
+        psmove_capture_reader_free(replay);
+        return NULL;
+    }
+
+    PSMove *move = (PSMove*)calloc(1, sizeof(PSMove));
+    move->type = PSMove_REPLAY;
+    move->fixed_point = PSMOVE_FIXED_POINT_DEFAULT;
+
+    // Captures don't record the connection, treat them like wireless controllers
+    move->connection_type = Conn_Bluetooth;
+
+    move->replay = replay;
+    move->replay_speed = (speed > 0.f) ? speed : 0.f;
+
+    /* Message type for LED set requests */
+    move->leds.type = PSMove_Req_SetLEDs;
+
+    move->model = model;
+    move->id = -1;
+    move->serial_number = strdup(psmove_capture_reader_get_serial(replay));
+
+    /* Use the calibration of the recorded controller, not the one on disk */
+    size_t calibration_size = 0;
+    const char *calibration = psmove_capture_reader_get_calibration(replay, &calibration_size);
+    move->calibration = psmove_calibration_new_from_usb_data(move, calibration, calibration_size);
+
+    move->orientation = psmove_orientation_new(move);
+    move->clock = psmove_clock_new();
+    move->prediction_horizon_us = PSMOVE_DEFAULT_PREDICTION_HORIZON_US;
+
+    move->sensor_transform = *k_psmove_sensor_transform_opengl;
+    psmove_update_input_transforms(move);
+
+    /* Start from scratch, but with the recorded magnetometer calibration */
+    psmove_reset_magnetometer_calibration(move);
+    move->magnetometer_calibration_direction = psmove_capture_reader_get_magnetometer_direction(replay);
+
+    move->replay_start_us = psmove_port_get_time_us();
+
+    /* Bookkeeping of open handles (for psmove_reinit) */
+    psmove_num_open_handles++;
+
+    return move;
+}
+
+bool
+psmove_is_replay_finished(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, true);
+
+    if (move->type != PSMove_REPLAY) {
+        return false;
+    }
+
+    /* Trailing output records don't count, they are never replayed */
+    const PSMoveCapture_Record *record;
+    while ((record = psmove_capture_reader_peek(move->replay)) != NULL &&
+            record->type != CaptureRecord_Input) {
+        psmove_capture_reader_advance(move->replay);
+    }
+
+    return (record == NULL);
+}
+
+bool
+psmove_start_recording(PSMove *move, const char *filename)
+{
+    psmove_return_val_if_fail(move != NULL, false);
+    psmove_return_val_if_fail(filename != NULL, false);
+
+    psmove_stop_recording(move);
+
+    const char *calibration = NULL;
+    size_t calibration_size = 0;
+    if (move->calibration) {
+        psmove_calibration_get_usb_data(move->calibration, &calibration, &calibration_size);
+    }
+
+    move->recorder = psmove_capture_writer_new(filename, move->serial_number,
+            move->model, calibration, calibration_size,
+            &move->magnetometer_calibration_direction);
+
+    return (move->recorder != NULL);
+}
+
+void
+psmove_stop_recording(PSMove *move)
+{
+    psmove_return_if_fail(move != NULL);
+
+    if (move->recorder) {
+        psmove_capture_writer_free(move->recorder);
+        move->recorder = NULL;
+    }
+}
+
 static int
 compare_hid_device_info_ptr(const void *a, const void *b)
 {
@@ -934,8 +1191,8 @@ _psmove_read_btaddrs(PSMove *move, PSMove_Data_BTAddr *host, PSMove_Data_BTAddr
     }
 #endif
 
-    if (move->type == PSMove_MOVED) {
-        PSMOVE_ERROR("Not implemented in MOVED mode");
+    if (move->type != PSMove_HIDAPI) {
+        PSMOVE_ERROR("Not implemented for remote or replayed controllers");
         return 0;
     }
 
@@ -1355,9 +1612,30 @@ psmove_update_leds(PSMove *move)
         return Update_Ignored;
     }
 
+    return _psmove_flush_leds(move);
+}
+
+bool
+_psmove_get_leds_dirty(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, false);
+
+    return move->leds_dirty;
+}
+
+enum PSMove_Update_Result
+_psmove_flush_leds(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, 0);
+
     move->leds_dirty = 0;
     move->last_leds_update = psmove_util_get_ticks();
 
+    if (move->recorder) {
+        psmove_capture_writer_write(move->recorder, CaptureRecord_Output,
+                psmove_port_get_time_us(), (unsigned char *)&move->leds, sizeof(move->leds));
+    }
+
     switch (move->type) {
         case PSMove_HIDAPI:
         	// NOTE: On Linux, hid_write returns 0 for a Bluetooth-connected
@@ -1372,18 +1650,26 @@ psmove_update_leds(PSMove *move)
 
             if (hid_write(move->handle, (unsigned char*)(&(move->leds)),
                     sizeof(move->leds)) >= 0) {
+                move->stats.led_updates++;
                 return Update_Success;
             } else {
+                move->stats.led_write_failures++;
                 return Update_Failed;
             }
             break;
         case PSMove_MOVED:
             if (moved_client_send(move->client, MOVED_REQ_SET_LEDS, move->remote_id, (uint8_t *)&move->leds, sizeof(move->leds))) {
+                move->stats.led_updates++;
                 return Update_Success;
             } else {
+                move->stats.led_write_failures++;
                 return Update_Failed;
             }
             break;
+        case PSMove_REPLAY:
+            /* There is no device to write to, only record the output */
+            move->stats.led_updates++;
+            return Update_Success;
         default:
             PSMOVE_ERROR("Unknown device type");
             return 0;
@@ -1391,121 +1677,884 @@ psmove_update_leds(PSMove *move)
     }
 }
 
-void
-psmove_set_rate_limiting(PSMove *move, bool enabled)
-{
-    psmove_return_if_fail(move != NULL);
-    move->leds_rate_limiting = enabled;
-}
+/**
+ * Decode the sensor values of an input report. The accelerometer and gyroscope
+ * values are 12 consecutive little-endian 16-bit words in the report, so on
+ * little-endian CPUs they are loaded as-is and only need the per-model bias
+ * flipped to become two's complement (two SIMD loads and XORs).
+ **/
+static void
+psmove_decode_input(const PSMove_Data_Input *input, enum PSMove_Model_Type model,
+        PSMove_Decoded_Input *decoded)
+{
+    const unsigned char *data = (const unsigned char *)input;
+    const unsigned char *imu = data + offsetof(PSMove_Data_Input_Common, aXlow);
+    int16_t *values = &decoded->imu[0][0][0];
+
+    if ((unsigned int)model >= Model_Count) {
+        model = Model_Unknown;
+    }
+
+    uint16_t bias = psmove_input_formats[model].imu_bias;
+
+#if defined(PSMOVE_DECODE_SSE2)
+    __m128i mask = _mm_set1_epi16((short)bias);
+    _mm_storeu_si128((__m128i *)values,
+            _mm_xor_si128(_mm_loadu_si128((const __m128i *)imu), mask));
+    _mm_storel_epi64((__m128i *)(values + 8),
+            _mm_xor_si128(_mm_loadl_epi64((const __m128i *)(imu + 16)), mask));
+#elif defined(PSMOVE_DECODE_NEON)
+    uint16x8_t mask = vdupq_n_u16(bias);
+    vst1q_u16((uint16_t *)values,
+            veorq_u16(vreinterpretq_u16_u8(vld1q_u8(imu)), mask));
+    vst1_u16((uint16_t *)(values + 8),
+            veor_u16(vreinterpret_u16_u8(vld1_u8(imu + 16)), vget_low_u16(mask)));
+#else
+    int i;
+    for (i = 0; i < PSMOVE_INPUT_IMU_VALUES; i++) {
+        values[i] = (int16_t)((imu[2 * i] | (imu[2 * i + 1] << 8)) ^ bias);
+    }
+#endif
 
-int
-psmove_poll(PSMove *move)
-{
-    int res = 0;
+    if (psmove_input_formats[model].single_frame) {
+        memcpy(decoded->imu[Sensor_Accelerometer][Frame_SecondHalf],
+                decoded->imu[Sensor_Accelerometer][Frame_FirstHalf], sizeof(decoded->imu[0][0]));
+        memcpy(decoded->imu[Sensor_Gyroscope][Frame_SecondHalf],
+                decoded->imu[Sensor_Gyroscope][Frame_FirstHalf], sizeof(decoded->imu[0][0]));
+    }
 
-    psmove_return_val_if_fail(move != NULL, 0);
+    if (psmove_input_formats[model].magnetometer) {
+        const PSMove_ZCM1_Data_Input *zcm1 = &input->zcm1;
 
-    /* store old sequence number before reading */
-    int oldseq = (move->input.common.buttons4 & 0x0F);
+        decoded->magnetometer[0] = TWELVE_BIT_SIGNED(((zcm1->common.templow_mXhigh & 0x0F) << 8) |
+                zcm1->mXlow);
+        decoded->magnetometer[1] = TWELVE_BIT_SIGNED((zcm1->mYhigh << 4) |
+                (zcm1->mYlow_mZhigh & 0xF0) >> 4);
+        decoded->magnetometer[2] = TWELVE_BIT_SIGNED(((zcm1->mYlow_mZhigh & 0x0F) << 8) |
+                zcm1->mZlow);
+    } else {
+        memset(decoded->magnetometer, 0, sizeof(decoded->magnetometer));
+    }
 
-    switch (move->type) {
-        case PSMove_HIDAPI:
-            switch (move->model) {
-                case Model_ZCM1:
-                    res = hid_read(move->handle, (unsigned char*)(&(move->input.zcm1)), sizeof(move->input.zcm1));
-                    break;
-                case Model_ZCM2:
-                    res = hid_read(move->handle, (unsigned char*)(&(move->input.zcm2)), sizeof(move->input.zcm2));
-                    break;
-                default:
-                    PSMOVE_ERROR("Unknown PS Move model");
-                    break;
-            }
-            break;
-        case PSMove_MOVED:
-            if (moved_client_send(move->client, MOVED_REQ_READ_INPUT, (char)move->remote_id, NULL, 0)) {
-                /**
-                 * The input buffer is stored at offset 1 (the first byte
-                 * contains the return value of the remote psmove_poll())
-                 **/
+    /**
+     * On the Move Motion Controller's PCB there is a voltage divider which
+     * contains a thermistor. An ADC reads the voltage across the thermistor
+     * (which changes its resistance with the temperature) and reports the
+     * raw value (plus an offset) as the value we see in the Input Report.
+     *
+     * The offset can be changed if the controller is running in Debug mode,
+     * but it seems to default to 0.
+     **/
+    decoded->temperature = (input->common.temphigh << 4) |
+            ((input->common.templow_mXhigh & 0xF0) >> 4);
+}
 
-                size_t input_data_size = 0;
-                switch (move->model) {
-                    case Model_ZCM1:
-                        input_data_size = sizeof(move->input.zcm1);
-                        memcpy(&(move->input.zcm1), move->client->response_buf.read_input.data, input_data_size);
-                        break;
-                    case Model_ZCM2:
-                        input_data_size = sizeof(move->input.zcm2);
-                        memcpy(&(move->input.zcm2), move->client->response_buf.read_input.data, input_data_size);
-                        break;
-                    default:
-                        PSMOVE_ERROR("Unknown PS Move model");
-                        break;
-                }
+/* Set affine to transform * calibration (with calibration as 3x4 matrix) */
+static void
+psmove_affine_transform_set(PSMove_Affine_Transform *affine,
+        const float calibration[3][4], const PSMove_3AxisTransform *transform)
+{
+    int row, column, i;
 
-                if (move->client->response_buf.read_input.poll_return_value != 0) {
-                    res = input_data_size;
-                }
+    memset(affine, 0, sizeof(*affine));
+
+    for (row = 0; row < 3; row++) {
+        for (column = 0; column < 4; column++) {
+            float sum = 0.f;
+            for (i = 0; i < 3; i++) {
+                sum += transform->m[row * 3 + i] * calibration[i][column];
             }
-            break;
-        default:
-            PSMOVE_ERROR("Unknown device type");
+            affine->columns[column][row] = sum;
+        }
     }
+}
 
-    if ((move->model == Model_ZCM1 && res == sizeof(move->input.zcm1)) ||
-        (move->model == Model_ZCM2 && res == sizeof(move->input.zcm2))) {
-        /* Sanity check: The first byte should be PSMove_Req_GetInput */
-        psmove_return_val_if_fail(move->input.common.type == PSMove_Req_GetInput, 0);
+/* Map both frames of raw values: out = matrix * raw + offset */
+static void
+psmove_affine_transform_apply(const PSMove_Affine_Transform *affine,
+        const int16_t (*raw)[3], float (*out)[4])
+{
+    int frame;
 
-        /**
-         * buttons4's 4 least significant bits contain the sequence number,
-         * so we add 1 to signal "success" and add the sequence number for
-         * consumers to utilize the data
-         **/
-        int seq = (move->input.common.buttons4 & 0x0F);
-        if (seq != ((oldseq + 1) % 16)) {
-            PSMOVE_DEBUG("Dropped frames (seq %d -> %d)", oldseq, seq);
+#if defined(PSMOVE_DECODE_SSE2)
+    __m128 c0 = _mm_loadu_ps(affine->columns[0]);
+    __m128 c1 = _mm_loadu_ps(affine->columns[1]);
+    __m128 c2 = _mm_loadu_ps(affine->columns[2]);
+    __m128 c3 = _mm_loadu_ps(affine->columns[3]);
+
+    for (frame = 0; frame < 2; frame++) {
+        __m128 result = _mm_add_ps(c3, _mm_mul_ps(c0, _mm_set1_ps(raw[frame][0])));
+        result = _mm_add_ps(result, _mm_mul_ps(c1, _mm_set1_ps(raw[frame][1])));
+        result = _mm_add_ps(result, _mm_mul_ps(c2, _mm_set1_ps(raw[frame][2])));
+        _mm_storeu_ps(out[frame], result);
+    }
+#elif defined(PSMOVE_DECODE_NEON)
+    float32x4_t c0 = vld1q_f32(affine->columns[0]);
+    float32x4_t c1 = vld1q_f32(affine->columns[1]);
+    float32x4_t c2 = vld1q_f32(affine->columns[2]);
+    float32x4_t c3 = vld1q_f32(affine->columns[3]);
+
+    for (frame = 0; frame < 2; frame++) {
+        float32x4_t result = vmlaq_n_f32(c3, c0, (float)raw[frame][0]);
+        result = vmlaq_n_f32(result, c1, (float)raw[frame][1]);
+        result = vmlaq_n_f32(result, c2, (float)raw[frame][2]);
+        vst1q_f32(out[frame], result);
+    }
+#else
+    int row;
+
+    for (frame = 0; frame < 2; frame++) {
+        for (row = 0; row < 4; row++) {
+            out[frame][row] = affine->columns[3][row] +
+                affine->columns[0][row] * (float)raw[frame][0] +
+                affine->columns[1][row] * (float)raw[frame][1] +
+                affine->columns[2][row] * (float)raw[frame][2];
         }
+    }
+#endif
+}
+
+/* Convert affine to fixed-point, the matrix has to be within -2..2 */
+static void
+psmove_fixed_affine_transform_set(PSMove_Fixed_Affine_Transform *fixed,
+        const PSMove_Affine_Transform *affine)
+{
+    int row, column;
 
-        if (move->orientation_enabled) {
-            psmove_orientation_update(move->orientation);
+    for (row = 0; row < 3; row++) {
+        for (column = 0; column < 3; column++) {
+            float value = affine->columns[column][row];
+            if (fabsf(value) >= 2.f) {
+                PSMOVE_WARNING("Calibration out of range for fixed-point: %f", value);
+            }
+            fixed->matrix[row][column] = psmove_q30_from_float(value);
         }
 
-        return 1 + seq;
+        fixed->offset[row] = psmove_q16_from_float(affine->columns[3][row]);
     }
+}
 
-    return 0;
+/* Map both frames of raw values: out = matrix * raw + offset */
+static void
+psmove_fixed_affine_transform_apply(const PSMove_Fixed_Affine_Transform *fixed,
+        const int16_t (*raw)[3], psmove_q16 (*out)[3])
+{
+    int frame, row;
+
+    for (frame = 0; frame < 2; frame++) {
+        for (row = 0; row < 3; row++) {
+            /* 2.30 * integer, rounded to 16.16 */
+            int64_t sum = (int64_t)fixed->matrix[row][0] * raw[frame][0] +
+                (int64_t)fixed->matrix[row][1] * raw[frame][1] +
+                (int64_t)fixed->matrix[row][2] * raw[frame][2];
+            out[frame][row] = (psmove_q16)((sum + ((int64_t)1 << 13)) >> 14) + fixed->offset[row];
+        }
+    }
 }
 
-bool
-psmove_get_ext_data(PSMove *move, PSMove_Ext_Data *data)
+/* Apply calibration and sensor data transform to the decoded input report */
+static void
+psmove_calibrate_input(PSMove *move)
 {
-    psmove_return_val_if_fail(move != NULL, false);
-    psmove_return_val_if_fail(data != NULL, false);
+    const int16_t (*accelerometer)[3] = move->decoded.imu[Sensor_Accelerometer];
+    const int16_t (*gyroscope)[3] = move->decoded.imu[Sensor_Gyroscope];
 
-    switch (move->model) {
-        case Model_ZCM1:
-            assert(sizeof(*data) >= sizeof(move->input.zcm1.extdata));
-            memcpy(data, move->input.zcm1.extdata, sizeof(move->input.zcm1.extdata));
-            return true;
-        case Model_ZCM2:
-            // EXT data not supported on ZCM2
-            return false;
-        default:
-            PSMOVE_ERROR("Unknown PS Move model");
-            return false;
+    if (move->fixed_point) {
+        psmove_fixed_affine_transform_apply(&move->mapped_fixed[Sensor_Accelerometer],
+                accelerometer, move->calibrated.mapped_fixed[Sensor_Accelerometer]);
+        psmove_fixed_affine_transform_apply(&move->mapped_fixed[Sensor_Gyroscope],
+                gyroscope, move->calibrated.mapped_fixed[Sensor_Gyroscope]);
+
+        psmove_fixed_affine_transform_apply(&move->transformed_fixed[Sensor_Accelerometer],
+                accelerometer, move->calibrated.transformed_fixed[Sensor_Accelerometer]);
+        psmove_fixed_affine_transform_apply(&move->transformed_fixed[Sensor_Gyroscope],
+                gyroscope, move->calibrated.transformed_fixed[Sensor_Gyroscope]);
+    } else {
+        psmove_affine_transform_apply(&move->mapped_affine[Sensor_Accelerometer],
+                accelerometer, move->calibrated.mapped[Sensor_Accelerometer]);
+        psmove_affine_transform_apply(&move->mapped_affine[Sensor_Gyroscope],
+                gyroscope, move->calibrated.mapped[Sensor_Gyroscope]);
+
+        psmove_affine_transform_apply(&move->transformed_affine[Sensor_Accelerometer],
+                accelerometer, move->calibrated.transformed[Sensor_Accelerometer]);
+        psmove_affine_transform_apply(&move->transformed_affine[Sensor_Gyroscope],
+                gyroscope, move->calibrated.transformed[Sensor_Gyroscope]);
     }
 }
 
-unsigned int
-psmove_get_buttons(PSMove *move)
+/* One frame of calibrated sensor values, without or with the sensor data transform */
+static void
+psmove_get_calibrated_frame(PSMove *move, bool transformed, enum PSMove_Sensor sensor,
+        enum PSMove_Frame frame, float *out)
 {
-    psmove_return_val_if_fail(move != NULL, 0);
+    if (move->fixed_point) {
+        const psmove_q16 *values = transformed ?
+            move->calibrated.transformed_fixed[sensor][frame] : move->calibrated.mapped_fixed[sensor][frame];
 
-    /**
-     * See also: enum PSMove_Button in include/psmove.h
-     *
+        out[0] = psmove_q16_to_float(values[0]);
+        out[1] = psmove_q16_to_float(values[1]);
+        out[2] = psmove_q16_to_float(values[2]);
+    } else {
+        const float *values = transformed ?
+            move->calibrated.transformed[sensor][frame] : move->calibrated.mapped[sensor][frame];
+
+        out[0] = values[0];
+        out[1] = values[1];
+        out[2] = values[2];
+    }
+}
+
+/**
+ * Combine calibration and sensor data transform into one affine transform
+ * per sensor, so that psmove_calibrate_input() does all the mapping at once.
+ * Must be called whenever the calibration or sensor data transform changes.
+ **/
+static void
+psmove_update_input_transforms(PSMove *move)
+{
+    float calibration[2][3][4] = {
+        { {1.f, 0.f, 0.f, 0.f}, {0.f, 1.f, 0.f, 0.f}, {0.f, 0.f, 1.f, 0.f} },
+        { {1.f, 0.f, 0.f, 0.f}, {0.f, 1.f, 0.f, 0.f}, {0.f, 0.f, 1.f, 0.f} },
+    };
+    int sensor;
+
+    if (move->calibration) {
+        psmove_calibration_get_accelerometer_affine(move->calibration,
+                calibration[Sensor_Accelerometer]);
+        psmove_calibration_get_gyroscope_affine(move->calibration,
+                calibration[Sensor_Gyroscope]);
+    }
+
+    for (sensor = Sensor_Accelerometer; sensor <= Sensor_Gyroscope; sensor++) {
+        psmove_affine_transform_set(&move->mapped_affine[sensor],
+                calibration[sensor], k_psmove_sensor_transform_identity);
+        psmove_affine_transform_set(&move->transformed_affine[sensor],
+                calibration[sensor], &move->sensor_transform);
+        if (move->fixed_point) {
+            psmove_fixed_affine_transform_set(&move->mapped_fixed[sensor], &move->mapped_affine[sensor]);
+            psmove_fixed_affine_transform_set(&move->transformed_fixed[sensor], &move->transformed_affine[sensor]);
+        }
+    }
+
+    psmove_calibrate_input(move);
+}
+
+/* Raw 16-bit device timestamp of the current input report */
+static unsigned short
+psmove_get_input_timestamp(PSMove *move)
+{
+    switch (move->model) {
+        case Model_ZCM1:
+            return (move->input.common.timehigh << 8) | move->input.zcm1.timelow;
+        case Model_ZCM2:
+            return (move->input.common.timehigh << 8) | move->input.zcm2.timelow;
+        default:
+            return 0;
+    }
+}
+
+/* Decode and calibrate the current input report into sample */
+static void
+psmove_fill_sample(PSMove *move, int seq, PSMove_Sample *sample)
+{
+    int frame;
+
+    sample->seq = seq;
+    sample->buttons = psmove_get_buttons(move);
+    sample->trigger = psmove_get_trigger(move);
+    sample->timestamp = psmove_get_input_timestamp(move);
+    sample->time_us = psmove_clock_get_sample_time_us(move->clock);
+    sample->latency_us = psmove_clock_get_latency_us(move->clock);
+
+    for (frame=Frame_FirstHalf; frame<=Frame_SecondHalf; frame++) {
+        float a[3], g[3];
+        psmove_get_calibrated_frame(move, false, Sensor_Accelerometer, (enum PSMove_Frame)frame, a);
+        psmove_get_calibrated_frame(move, false, Sensor_Gyroscope, (enum PSMove_Frame)frame, g);
+
+        sample->accelerometer[frame] = psmove_3axisvector_xyz(a[0], a[1], a[2]);
+        sample->gyroscope[frame] = psmove_3axisvector_xyz(g[0], g[1], g[2]);
+    }
+
+    if (move->orientation_enabled) {
+        psmove_orientation_get_quaternion(move->orientation, &sample->orientation[0],
+                &sample->orientation[1], &sample->orientation[2], &sample->orientation[3]);
+    } else {
+        sample->orientation[0] = 1.f;
+        sample->orientation[1] = sample->orientation[2] = sample->orientation[3] = 0.f;
+    }
+}
+
+/* Add the current report to the history (if enabled) */
+static void
+psmove_update_history(PSMove *move, int seq)
+{
+    PSMove_Sample sample;
+
+    move->history_pending_seq = 0;
+
+    if (move->history) {
+        psmove_fill_sample(move, seq, &sample);
+        psmove_history_push(move->history, &sample);
+    }
+}
+
+void
+psmove_set_rate_limiting(PSMove *move, bool enabled)
+{
+    psmove_return_if_fail(move != NULL);
+    move->leds_rate_limiting = enabled;
+}
+
+/* Upper bounds (in ms) of the buckets of PSMove_Stats.interval_histogram */
+static const uint32_t
+psmove_stats_interval_buckets_ms[PSMOVE_STATS_INTERVAL_BUCKETS - 1] = {
+    2, 4, 8, 12, 16, 24, 32, 64, 128,
+};
+
+/* Add the time since the previous report to the statistics */
+static void
+psmove_update_interval_stats(PSMove *move, uint64_t arrival_us)
+{
+    uint64_t interval_us = 0;
+    size_t bucket = 0;
+
+    if (arrival_us > move->stats_last_arrival_us) {
+        interval_us = arrival_us - move->stats_last_arrival_us;
+    }
+
+    while (bucket < ARRAY_LENGTH(psmove_stats_interval_buckets_ms) &&
+            interval_us >= psmove_stats_interval_buckets_ms[bucket] * 1000) {
+        bucket++;
+    }
+
+    move->stats.interval_histogram[bucket]++;
+    if (interval_us > move->stats.max_interval_us) {
+        move->stats.max_interval_us = (uint32_t)interval_us;
+    }
+}
+
+/* Add reports dropped by a full reader queue to the statistics */
+static void
+psmove_update_reader_stats(PSMove *move)
+{
+    if (move->reader) {
+        unsigned int overflows = psmove_reader_get_overflow_count(move->reader);
+        move->stats.reports_overflowed += overflows - move->stats_reader_overflows;
+        move->stats_reader_overflows = overflows;
+    }
+}
+
+bool
+psmove_set_threaded_reading(PSMove *move, bool enabled)
+{
+    psmove_return_val_if_fail(move != NULL, false);
+
+    if (move->type != PSMove_HIDAPI) {
+        /* Remote controllers are read by moved, replays need no reading */
+        return !enabled;
+    }
+
+    if (!enabled) {
+        if (move->reader) {
+            psmove_update_reader_stats(move);
+            psmove_reader_free(move->reader);
+            move->reader = NULL;
+            move->stats_reader_overflows = 0;
+        }
+        return true;
+    }
+
+    if (move->reader) {
+        return true;
+    }
+
+    size_t report_size = 0;
+    switch (move->model) {
+        case Model_ZCM1:
+            report_size = sizeof(move->input.zcm1);
+            break;
+        case Model_ZCM2:
+            report_size = sizeof(move->input.zcm2);
+            break;
+        default:
+            PSMOVE_ERROR("Unknown PS Move model");
+            return false;
+    }
+
+    move->reader = psmove_reader_new(move->handle, report_size);
+    return (move->reader != NULL);
+}
+
+/**
+ * Host time at which a recorded report is delivered by psmove_poll(): The
+ * capture timeline is scaled by the replay speed (0 = immediately).
+ **/
+static uint64_t
+psmove_replay_get_due_us(PSMove *move, const PSMoveCapture_Record *record)
+{
+    if (move->replay_speed <= 0.f) {
+        return 0;
+    }
+
+    return move->replay_start_us + (uint64_t)((double)record->time_us / move->replay_speed);
+}
+
+/**
+ * Milliseconds until the next recorded input report of a replay is due,
+ * or -1 if the replay is finished.
+ **/
+static int
+psmove_replay_get_wait_ms(PSMove *move)
+{
+    if (psmove_is_replay_finished(move)) {
+        return -1;
+    }
+
+    uint64_t due_us = psmove_replay_get_due_us(move, psmove_capture_reader_peek(move->replay));
+    uint64_t now_us = psmove_port_get_time_us();
+    if (due_us <= now_us) {
+        return 0;
+    }
+
+    uint64_t wait_ms = (due_us - now_us + 999) / 1000;
+    return (wait_ms > INT_MAX) ? INT_MAX : (int)wait_ms;
+}
+
+/**
+ * Read the next recorded input report of a replay into the input buffer if
+ * it is due. The arrival time is reported on the capture timeline (relative
+ * to the replay start), so timing stays faithful at any replay speed.
+ *
+ * Returns the size of the report, or 0 if no report is due (yet).
+ **/
+static int
+psmove_replay_read(PSMove *move, uint64_t *arrival_us)
+{
+    size_t input_data_size = (move->model == Model_ZCM1) ?
+        sizeof(move->input.zcm1) : sizeof(move->input.zcm2);
+
+    const PSMoveCapture_Record *record;
+    while ((record = psmove_capture_reader_peek(move->replay)) != NULL) {
+        if (record->type != CaptureRecord_Input) {
+            /* Outputs are recorded for reference only */
+            psmove_capture_reader_advance(move->replay);
+            continue;
+        }
+
+        if (psmove_replay_get_due_us(move, record) > psmove_port_get_time_us()) {
+            return 0;
+        }
+
+        if (record->length != input_data_size) {
+            PSMOVE_WARNING("Skipping recorded report of unexpected size (%d bytes)", (int)record->length);
+            psmove_capture_reader_advance(move->replay);
+            continue;
+        }
+
+        memcpy(&(move->input), record->data, input_data_size);
+        *arrival_us = move->replay_start_us + record->time_us;
+        psmove_capture_reader_advance(move->replay);
+
+        return (int)input_data_size;
+    }
+
+    return 0;
+}
+
+bool
+_psmove_wait_any_fd(PSMove **moves, size_t count, int fd, int timeout_ms)
+{
+    PSMoveReader **readers = NULL;
+    size_t i;
+    bool result;
+
+    psmove_return_val_if_fail(moves != NULL || count == 0, false);
+
+    if (count > 0) {
+        readers = (PSMoveReader **)calloc(count, sizeof(PSMoveReader *));
+        if (readers == NULL) {
+            PSMOVE_WARNING("Cannot allocate reader list for %d controllers", (int)count);
+            return false;
+        }
+    }
+
+    for (i=0; i<count; i++) {
+        if (moves[i] == NULL) {
+            continue;
+        }
+
+        if (moves[i]->type == PSMove_MOVED) {
+            /* Remote controllers can't notify us, so they must be polled */
+            if (timeout_ms < 0 || timeout_ms > PSMOVE_MAX_REMOTE_WAIT_MS) {
+                timeout_ms = PSMOVE_MAX_REMOTE_WAIT_MS;
+            }
+            continue;
+        }
+
+        if (moves[i]->type == PSMove_REPLAY) {
+            /* Sleep until the next recorded report is due */
+            int due_ms = psmove_replay_get_wait_ms(moves[i]);
+            if (due_ms >= 0 && (timeout_ms < 0 || timeout_ms > due_ms)) {
+                timeout_ms = due_ms;
+            }
+            continue;
+        }
+
+        if (moves[i]->reader == NULL && !psmove_set_threaded_reading(moves[i], true)) {
+            PSMOVE_WARNING("Cannot wait for controller without threaded reading");
+            timeout_ms = 0;
+            continue;
+        }
+
+        readers[i] = moves[i]->reader;
+    }
+
+    result = psmove_reader_wait(readers, count, fd, timeout_ms);
+
+    free(readers);
+
+    return result;
+}
+
+bool
+psmove_wait_any(PSMove **moves, size_t count, int timeout_ms)
+{
+    return _psmove_wait_any_fd(moves, count, -1, timeout_ms);
+}
+
+static int
+_psmove_poll(PSMove *move, bool update_orientation)
+{
+    int res = 0;
+    uint64_t arrival_us = 0;
+
+    psmove_return_val_if_fail(move != NULL, 0);
+
+    /* store old sequence number before reading */
+    int oldseq = (move->input.common.buttons4 & 0x0F);
+
+    switch (move->type) {
+        case PSMove_HIDAPI:
+            switch (move->model) {
+                case Model_ZCM1:
+                    if (move->reader) {
+                        res = psmove_reader_pop(move->reader, (unsigned char*)(&(move->input.zcm1)), sizeof(move->input.zcm1), &arrival_us);
+                    } else {
+                        res = hid_read(move->handle, (unsigned char*)(&(move->input.zcm1)), sizeof(move->input.zcm1));
+                        arrival_us = psmove_port_get_time_us();
+                    }
+                    break;
+                case Model_ZCM2:
+                    if (move->reader) {
+                        res = psmove_reader_pop(move->reader, (unsigned char*)(&(move->input.zcm2)), sizeof(move->input.zcm2), &arrival_us);
+                    } else {
+                        res = hid_read(move->handle, (unsigned char*)(&(move->input.zcm2)), sizeof(move->input.zcm2));
+                        arrival_us = psmove_port_get_time_us();
+                    }
+                    break;
+                default:
+                    PSMOVE_ERROR("Unknown PS Move model");
+                    break;
+            }
+            break;
+        case PSMove_MOVED:
+            if (moved_client_send(move->client, MOVED_REQ_READ_INPUT, (char)move->remote_id, NULL, 0)) {
+                /**
+                 * The input buffer is stored at offset 1 (the first byte
+                 * contains the return value of the remote psmove_poll())
+                 **/
+
+                size_t input_data_size = 0;
+                switch (move->model) {
+                    case Model_ZCM1:
+                        input_data_size = sizeof(move->input.zcm1);
+                        memcpy(&(move->input.zcm1), move->client->response_buf.read_input.data, input_data_size);
+                        break;
+                    case Model_ZCM2:
+                        input_data_size = sizeof(move->input.zcm2);
+                        memcpy(&(move->input.zcm2), move->client->response_buf.read_input.data, input_data_size);
+                        break;
+                    default:
+                        PSMOVE_ERROR("Unknown PS Move model");
+                        break;
+                }
+
+                if (move->client->response_buf.read_input.poll_return_value != 0) {
+                    res = input_data_size;
+                    arrival_us = psmove_port_get_time_us();
+                }
+            }
+            break;
+        case PSMove_REPLAY:
+            res = psmove_replay_read(move, &arrival_us);
+            break;
+        default:
+            PSMOVE_ERROR("Unknown device type");
+    }
+
+    if ((move->model == Model_ZCM1 && res == sizeof(move->input.zcm1)) ||
+        (move->model == Model_ZCM2 && res == sizeof(move->input.zcm2))) {
+        /* Sanity check: The first byte should be PSMove_Req_GetInput */
+        psmove_return_val_if_fail(move->input.common.type == PSMove_Req_GetInput, 0);
+
+        if (move->recorder) {
+            psmove_capture_writer_write(move->recorder, CaptureRecord_Input,
+                    arrival_us, (unsigned char *)&(move->input), res);
+        }
+
+        /**
+         * buttons4's 4 least significant bits contain the sequence number,
+         * so we add 1 to signal "success" and add the sequence number for
+         * consumers to utilize the data
+         **/
+        int seq = (move->input.common.buttons4 & 0x0F);
+        move->reports_lost_before_input = 0;
+        if (move->stats_last_arrival_us != 0) {
+            if (seq != ((oldseq + 1) % 16)) {
+                PSMOVE_DEBUG("Dropped frames (seq %d -> %d)", oldseq, seq);
+
+                /* Lower bound, we can't see if a multiple of 16 got lost */
+                move->reports_lost_before_input = (seq - oldseq - 1 + 16) % 16;
+                move->stats.gaps_detected++;
+                move->stats.reports_lost += move->reports_lost_before_input;
+            }
+
+            psmove_update_interval_stats(move, arrival_us);
+        }
+        move->stats.reports_received++;
+        move->stats_last_arrival_us = arrival_us;
+
+        psmove_decode_input(&move->input, move->model, &move->decoded);
+        psmove_calibrate_input(move);
+
+        if (move->magnetometer_fit && psmove_magnetometer_fit_add(move->magnetometer_fit,
+                    move->decoded.magnetometer)) {
+            psmove_magnetometer_fit_get(move->magnetometer_fit, &move->magnetometer_ellipsoid);
+        }
+
+        if (move->calibration && psmove_calibration_update_gyroscope_bias(move->calibration,
+                    move->decoded.imu[Sensor_Accelerometer], move->decoded.imu[Sensor_Gyroscope],
+                    move->decoded.temperature)) {
+            /* Bias for a new temperature (or a new estimate) */
+            psmove_update_input_transforms(move);
+        }
+
+        psmove_clock_update(move->clock, psmove_get_input_timestamp(move), arrival_us);
+
+        if (update_orientation) {
+            if (move->orientation_enabled) {
+                psmove_orientation_update(move->orientation);
+            }
+
+            psmove_update_history(move, 1 + seq);
+        } else {
+            /* The caller updates the orientation, then the history */
+            move->history_pending_seq = 1 + seq;
+        }
+
+        return 1 + seq;
+    }
+
+    return 0;
+}
+
+int
+psmove_poll(PSMove *move)
+{
+    return _psmove_poll(move, true);
+}
+
+size_t
+psmove_poll_many(PSMove **moves, size_t count, int *results)
+{
+    PSMoveOrientation *orientations[PSMOVE_POLL_MANY_BATCH_SIZE];
+    size_t orientation_count = 0;
+    size_t received = 0;
+    size_t i;
+
+    psmove_return_val_if_fail(moves != NULL || count == 0, 0);
+
+    for (i=0; i<count; i++) {
+        int seq = 0;
+
+        if (moves[i] != NULL) {
+            seq = _psmove_poll(moves[i], false);
+        }
+
+        if (results) {
+            results[i] = seq;
+        }
+
+        if (!seq) {
+            continue;
+        }
+
+        received++;
+
+        /* Orientations are updated together after polling */
+        if (moves[i]->orientation_enabled) {
+            orientations[orientation_count++] = moves[i]->orientation;
+
+            if (orientation_count == PSMOVE_POLL_MANY_BATCH_SIZE) {
+                psmove_orientation_update_batch(orientations, orientation_count);
+                orientation_count = 0;
+            }
+        }
+    }
+
+    psmove_orientation_update_batch(orientations, orientation_count);
+
+    for (i=0; i<count; i++) {
+        if (moves[i] != NULL && moves[i]->history_pending_seq) {
+            psmove_update_history(moves[i], moves[i]->history_pending_seq);
+        }
+    }
+
+    return received;
+}
+
+bool
+psmove_get_ext_data(PSMove *move, PSMove_Ext_Data *data)
+{
+    psmove_return_val_if_fail(move != NULL, false);
+    psmove_return_val_if_fail(data != NULL, false);
+
+    switch (move->model) {
+        case Model_ZCM1:
+            assert(sizeof(*data) >= sizeof(move->input.zcm1.extdata));
+            memcpy(data, move->input.zcm1.extdata, sizeof(move->input.zcm1.extdata));
+            return true;
+        case Model_ZCM2:
+            // EXT data not supported on ZCM2
+            return false;
+        default:
+            PSMOVE_ERROR("Unknown PS Move model");
+            return false;
+    }
+}
+
+size_t
+psmove_poll_batch(PSMove *move, PSMove_Sample *out, size_t max)
+{
+    size_t count = 0;
+
+    psmove_return_val_if_fail(move != NULL, 0);
+    psmove_return_val_if_fail(out != NULL || max == 0, 0);
+
+    while (count < max) {
+        int seq = psmove_poll(move);
+        if (!seq) {
+            break;
+        }
+
+        psmove_fill_sample(move, seq, &out[count++]);
+    }
+
+    return count;
+}
+
+bool
+psmove_set_history_size(PSMove *move, size_t size)
+{
+    PSMoveHistory *history = NULL;
+
+    psmove_return_val_if_fail(move != NULL, false);
+
+    if (size > 0) {
+        history = psmove_history_new(size);
+        if (history == NULL) {
+            return false;
+        }
+    }
+
+    if (move->history) {
+        psmove_history_free(move->history);
+    }
+
+    move->history = history;
+
+    return true;
+}
+
+size_t
+psmove_get_history(PSMove *move, PSMove_Sample *out, size_t max)
+{
+    psmove_return_val_if_fail(move != NULL, 0);
+    psmove_return_val_if_fail(move->history != NULL, 0);
+
+    return psmove_history_get_last(move->history, out, max);
+}
+
+bool
+psmove_get_history_at(PSMove *move, uint64_t time_us, PSMove_Sample *out)
+{
+    psmove_return_val_if_fail(move != NULL, false);
+    psmove_return_val_if_fail(move->history != NULL, false);
+
+    return psmove_history_get_at(move->history, time_us, out);
+}
+
+bool
+psmove_get_stats(PSMove *move, PSMove_Stats *stats)
+{
+    psmove_return_val_if_fail(move != NULL, false);
+    psmove_return_val_if_fail(stats != NULL, false);
+
+    psmove_update_reader_stats(move);
+    *stats = move->stats;
+
+    return true;
+}
+
+void
+psmove_reset_stats(PSMove *move)
+{
+    psmove_return_if_fail(move != NULL);
+
+    psmove_update_reader_stats(move);
+    memset(&move->stats, 0, sizeof(move->stats));
+}
+
+uint64_t
+psmove_get_device_timestamp(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, 0);
+
+    return psmove_clock_get_device_ticks(move->clock);
+}
+
+uint64_t
+psmove_get_sample_time_us(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, 0);
+
+    return psmove_clock_get_sample_time_us(move->clock);
+}
+
+uint64_t
+psmove_get_arrival_time_us(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, 0);
+
+    return psmove_clock_get_arrival_time_us(move->clock);
+}
+
+uint32_t
+psmove_get_latency_us(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, 0);
+
+    return psmove_clock_get_latency_us(move->clock);
+}
+
+unsigned int
+psmove_get_buttons(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, 0);
+
+    /**
+     * See also: enum PSMove_Button in include/psmove.h
+     *
      * Source:
      * https://github.com/nitsch/moveonpc/wiki/Input-report
      *
@@ -1687,18 +2736,7 @@ psmove_get_temperature(PSMove *move)
 {
     psmove_return_val_if_fail(move != NULL, 0);
 
-    /**
-     * On the Move Motion Controller's PCB there is a voltage divider which
-     * contains a thermistor. An ADC reads the voltage across the thermistor
-     * (which changes its resistance with the temperature) and reports the
-     * raw value (plus an offset) as the value we see in the Input Report.
-     *
-     * The offset can be changed if the controller is running in Debug mode,
-     * but it seems to default to 0.
-     **/
-
-    return ((move->input.common.temphigh << 4) |
-            ((move->input.common.templow_mXhigh & 0xF0) >> 4));
+    return move->decoded.temperature;
 }
 
 float
@@ -1748,206 +2786,119 @@ psmove_get_trigger(PSMove *move)
 {
     psmove_return_val_if_fail(move != NULL, 0);
 
-    switch (move->model) {
-        case Model_ZCM1:
-            return (move->input.common.trigger + move->input.common.trigger2) / 2;
-        case Model_ZCM2:
-            return move->input.common.trigger;
-        default:
-            PSMOVE_ERROR("Unknown PS Move model");
-            return 0;
-    }
-}
-
-struct Vector3Int {
-    int x, y, z;
-};
-
-void
-psmove_get_half_frame(PSMove *move, enum PSMove_Sensor sensor,
-        enum PSMove_Frame frame, int *x, int *y, int *z)
-{
-    psmove_return_if_fail(move != NULL);
-    psmove_return_if_fail(sensor == Sensor_Accelerometer || sensor == Sensor_Gyroscope);
-    psmove_return_if_fail(frame == Frame_FirstHalf || frame == Frame_SecondHalf);
-
-    struct Vector3Int result = {0, 0, 0};
-
-    int base = 0;
-
-    switch (move->model) {
-        case Model_ZCM1:
-            switch (sensor) {
-                case Sensor_Accelerometer:
-                    base = offsetof(PSMove_Data_Input_Common, aXlow);
-                    break;
-                case Sensor_Gyroscope:
-                    base = offsetof(PSMove_Data_Input_Common, gXlow);
-                    break;
-                default:
-                    PSMOVE_WARNING("Unknown sensor type");
-                    return;
-            }
-
-            if (frame == Frame_SecondHalf) {
-                base += 6;
-            }
-
-            result.x = psmove_decode_16bit((void*)&move->input.common, base + 0);
-            result.y = psmove_decode_16bit((void*)&move->input.common, base + 2);
-            result.z = psmove_decode_16bit((void*)&move->input.common, base + 4);
-            break;
-        case Model_ZCM2:
-            switch (sensor) {
-                case Sensor_Accelerometer:
-                    base = offsetof(PSMove_Data_Input_Common, aXlow);
-                    break;
-                case Sensor_Gyroscope:
-                    base = offsetof(PSMove_Data_Input_Common, gXlow);
-                    break;
-                default:
-                    PSMOVE_WARNING("Unknown sensor type");
-                    return;
-            }
-
-            // NOTE: Only one frame on the ZCM2
-
-            result.x = psmove_decode_16bit_twos_complement((void*)&move->input.common, base + 0);
-            result.y = psmove_decode_16bit_twos_complement((void*)&move->input.common, base + 2);
-            result.z = psmove_decode_16bit_twos_complement((void*)&move->input.common, base + 4);
-            break;
+    switch (move->model) {
+        case Model_ZCM1:
+            return (move->input.common.trigger + move->input.common.trigger2) / 2;
+        case Model_ZCM2:
+            return move->input.common.trigger;
         default:
             PSMOVE_ERROR("Unknown PS Move model");
-            break;
+            return 0;
     }
+}
+
+/* Average of both frames of sensor (rounded down, like the older ZCM1 code) */
+static void
+psmove_get_averaged_frames(PSMove *move, enum PSMove_Sensor sensor,
+        int *x, int *y, int *z)
+{
+    const int16_t *first = move->decoded.imu[sensor][Frame_FirstHalf];
+    const int16_t *second = move->decoded.imu[sensor][Frame_SecondHalf];
 
     if (x) {
-        *x = result.x;
+        *x = ((first[0] + second[0] + 0x10000) >> 1) - 0x8000;
     }
 
     if (y) {
-        *y = result.y;
+        *y = ((first[1] + second[1] + 0x10000) >> 1) - 0x8000;
     }
 
     if (z) {
-        *z = result.z;
+        *z = ((first[2] + second[2] + 0x10000) >> 1) - 0x8000;
     }
 }
 
 void
-psmove_get_accelerometer(PSMove *move, int *ax, int *ay, int *az)
+psmove_get_half_frame(PSMove *move, enum PSMove_Sensor sensor,
+        enum PSMove_Frame frame, int *x, int *y, int *z)
 {
     psmove_return_if_fail(move != NULL);
+    psmove_return_if_fail(sensor == Sensor_Accelerometer || sensor == Sensor_Gyroscope);
+    psmove_return_if_fail(frame == Frame_FirstHalf || frame == Frame_SecondHalf);
 
-    struct Vector3Int result = {0, 0, 0};
-
-    switch (move->model) {
-        case Model_ZCM1:
-            result.x = ((move->input.common.aXlow + move->input.common.aXlow2) +
-                   ((move->input.common.aXhigh + move->input.common.aXhigh2) << 8)) / 2 - 0x8000;
-
-            result.y = ((move->input.common.aYlow + move->input.common.aYlow2) +
-                   ((move->input.common.aYhigh + move->input.common.aYhigh2) << 8)) / 2 - 0x8000;
-
-            result.z = ((move->input.common.aZlow + move->input.common.aZlow2) +
-                   ((move->input.common.aZhigh + move->input.common.aZhigh2) << 8)) / 2 - 0x8000;
-            break;
-        case Model_ZCM2:
-            result.x = (int16_t) (move->input.common.aXlow + (move->input.common.aXhigh << 8));
-            result.y = (int16_t) (move->input.common.aYlow + (move->input.common.aYhigh << 8));
-            result.z = (int16_t) (move->input.common.aZlow + (move->input.common.aZhigh << 8));
-            break;
-        default:
-            PSMOVE_ERROR("Unknown PS Move model");
-            break;
-    }
+    const int16_t *values = move->decoded.imu[sensor][frame];
 
-    if (ax) {
-        *ax = result.x;
+    if (x) {
+        *x = values[0];
     }
 
-    if (ay) {
-        *ay = result.y;
+    if (y) {
+        *y = values[1];
     }
 
-    if (az) {
-        *az = result.z;
+    if (z) {
+        *z = values[2];
     }
 }
 
 void
-psmove_get_gyroscope(PSMove *move, int *gx, int *gy, int *gz)
+psmove_get_accelerometer(PSMove *move, int *ax, int *ay, int *az)
 {
     psmove_return_if_fail(move != NULL);
 
-    struct Vector3Int result = {0, 0, 0};
-
-    switch (move->model) {
-        case Model_ZCM1:
-            result.x = ((move->input.common.gXlow + move->input.common.gXlow2) +
-                   ((move->input.common.gXhigh + move->input.common.gXhigh2) << 8)) / 2 - 0x8000;
-
-            result.y = ((move->input.common.gYlow + move->input.common.gYlow2) +
-                   ((move->input.common.gYhigh + move->input.common.gYhigh2) << 8)) / 2 - 0x8000;
-
-            result.z = ((move->input.common.gZlow + move->input.common.gZlow2) +
-                   ((move->input.common.gZhigh + move->input.common.gZhigh2) << 8)) / 2 - 0x8000;
-            break;
-        case Model_ZCM2:
-            result.x = (int16_t) (move->input.common.gXlow + (move->input.common.gXhigh << 8));
-            result.y = (int16_t) (move->input.common.gYlow + (move->input.common.gYhigh << 8));
-            result.z = (int16_t) (move->input.common.gZlow + (move->input.common.gZhigh << 8));
-            break;
-        default:
-            PSMOVE_ERROR("Unknown PS Move model");
-            break;
-    }
-
-    if (gx) {
-        *gx = result.x;
-    }
+    psmove_get_averaged_frames(move, Sensor_Accelerometer, ax, ay, az);
+}
 
-    if (gy) {
-        *gy = result.y;
-    }
+void
+psmove_get_gyroscope(PSMove *move, int *gx, int *gy, int *gz)
+{
+    psmove_return_if_fail(move != NULL);
 
-    if (gz) {
-        *gz = result.z;
-    }
+    psmove_get_averaged_frames(move, Sensor_Gyroscope, gx, gy, gz);
 }
 
 void
 psmove_get_accelerometer_frame(PSMove *move, enum PSMove_Frame frame,
         float *ax, float *ay, float *az)
 {
-    int raw_input[3];
-
     psmove_return_if_fail(move != NULL);
     psmove_return_if_fail(frame == Frame_FirstHalf ||
             frame == Frame_SecondHalf);
 
-    psmove_get_half_frame(move, Sensor_Accelerometer, frame,
-            raw_input, raw_input+1, raw_input+2);
+    float values[3];
+    psmove_get_calibrated_frame(move, false, Sensor_Accelerometer, frame, values);
 
-    psmove_calibration_map_accelerometer(move->calibration, raw_input,
-            ax, ay, az);
+    if (ax) {
+        *ax = values[0];
+    }
+    if (ay) {
+        *ay = values[1];
+    }
+    if (az) {
+        *az = values[2];
+    }
 }
 
 void
 psmove_get_gyroscope_frame(PSMove *move, enum PSMove_Frame frame,
         float *gx, float *gy, float *gz)
 {
-    int raw_input[3];
-
     psmove_return_if_fail(move != NULL);
     psmove_return_if_fail(frame == Frame_FirstHalf ||
             frame == Frame_SecondHalf);
 
-    psmove_get_half_frame(move, Sensor_Gyroscope, frame,
-            raw_input, raw_input+1, raw_input+2);
+    float values[3];
+    psmove_get_calibrated_frame(move, false, Sensor_Gyroscope, frame, values);
 
-    psmove_calibration_map_gyroscope(move->calibration, raw_input,
-            gx, gy, gz);
+    if (gx) {
+        *gx = values[0];
+    }
+    if (gy) {
+        *gy = values[1];
+    }
+    if (gz) {
+        *gz = values[2];
+    }
 }
 
 void
@@ -1955,30 +2906,25 @@ psmove_get_magnetometer_3axisvector(PSMove *move, PSMove_3AxisVector *out_m)
 {
     psmove_return_if_fail(move != NULL);
 
-	PSMove_3AxisVector m;
-	int mx, my, mz;
-    psmove_get_magnetometer(move, &mx, &my, &mz);
-	m= psmove_3axisvector_xyz((float)mx, (float)my, (float)mz);
+    if (out_m) {
+        int mx, my, mz;
+        psmove_get_magnetometer(move, &mx, &my, &mz);
 
-    /* Update minimum and max components */
-	move->magnetometer_min = psmove_3axisvector_min_vector(&move->magnetometer_min, &m);
-	move->magnetometer_max = psmove_3axisvector_max_vector(&move->magnetometer_max, &m);
+        /* Map the fitted ellipsoid to the unit sphere: soft_iron * (raw - hard_iron) */
+        const PSMove_MagnetometerEllipsoid *ellipsoid = &move->magnetometer_ellipsoid;
+        const float *w = ellipsoid->soft_iron;
+        float dx = (float)mx - ellipsoid->hard_iron[0];
+        float dy = (float)my - ellipsoid->hard_iron[1];
+        float dz = (float)mz - ellipsoid->hard_iron[2];
 
-    /* Map [min..max] to [-1..+1] */
-	if (out_m)
-	{
-		PSMove_3AxisVector range = psmove_3axisvector_subtract(&move->magnetometer_max, &move->magnetometer_min);
-		PSMove_3AxisVector offset = psmove_3axisvector_subtract(&m, &move->magnetometer_min);
-		
-		// 2*(raw-move->magnetometer_min)/(move->magnetometer_max - move->magnetometer_min) - <1,1,1>
-		*out_m = psmove_3axisvector_divide_by_vector_with_default(&offset, &range, k_psmove_vector_zero);
-		*out_m = psmove_3axisvector_scale(out_m, 2.f);
-		*out_m = psmove_3axisvector_subtract(out_m, k_psmove_vector_one);
-
-		// The magnetometer y-axis is flipped compared to the accelerometer and gyro.
-		// Flip it back around to get it into the same space.
-		out_m->y = -out_m->y;	
-	}
+        out_m->x = w[0] * dx + w[1] * dy + w[2] * dz;
+        out_m->y = w[3] * dx + w[4] * dy + w[5] * dz;
+        out_m->z = w[6] * dx + w[7] * dy + w[8] * dz;
+
+        // The magnetometer y-axis is flipped compared to the accelerometer and gyro.
+        // Flip it back around to get it into the same space.
+        out_m->y = -out_m->y;
+    }
 }
 
 void
@@ -2027,37 +2973,16 @@ psmove_get_magnetometer(PSMove *move, int *mx, int *my, int *mz)
 {
     psmove_return_if_fail(move != NULL);
 
-    struct Vector3Int result = {0, 0, 0};
-
-    switch (move->model) {
-        case Model_ZCM1:
-            result.x = TWELVE_BIT_SIGNED(((move->input.common.templow_mXhigh & 0x0F) << 8) |
-                    move->input.zcm1.mXlow);
-
-            result.y = TWELVE_BIT_SIGNED((move->input.zcm1.mYhigh << 4) |
-                   (move->input.zcm1.mYlow_mZhigh & 0xF0) >> 4);
-
-            result.z = TWELVE_BIT_SIGNED(((move->input.zcm1.mYlow_mZhigh & 0x0F) << 8) |
-                    move->input.zcm1.mZlow);
-            break;
-        case Model_ZCM2:
-            // NOTE: This model does not have magnetometers
-            break;
-        default:
-            PSMOVE_ERROR("Unknown PS Move model");
-            break;
-    }
-
     if (mx) {
-        *mx = result.x;
+        *mx = move->decoded.magnetometer[0];
     }
 
     if (my) {
-        *my = result.y;
+        *my = move->decoded.magnetometer[1];
     }
 
     if (mz) {
-        *mz = result.z;
+        *mz = move->decoded.magnetometer[2];
     }
 }
 
@@ -2092,6 +3017,35 @@ psmove_get_orientation(PSMove *move,
     psmove_orientation_get_quaternion(move->orientation, w, x, y, z);
 }
 
+void
+psmove_get_predicted_orientation(PSMove *move, uint64_t time_us,
+        float *w, float *x, float *y, float *z)
+{
+    psmove_return_if_fail(move != NULL);
+    psmove_return_if_fail(move->orientation != NULL);
+
+    /* The orientation is the one at the sampling time of the last report */
+    uint64_t sample_time_us = psmove_clock_get_sample_time_us(move->clock);
+    uint64_t horizon_us = 0;
+    if (time_us > sample_time_us) {
+        horizon_us = time_us - sample_time_us;
+        if (horizon_us > move->prediction_horizon_us) {
+            horizon_us = move->prediction_horizon_us;
+        }
+    }
+
+    psmove_orientation_get_predicted_quaternion(move->orientation,
+            (float)horizon_us / 1000000.f, w, x, y, z);
+}
+
+void
+psmove_set_orientation_prediction_horizon(PSMove *move, uint32_t horizon_us)
+{
+    psmove_return_if_fail(move != NULL);
+
+    move->prediction_horizon_us = horizon_us;
+}
+
 void
 psmove_reset_orientation(PSMove *move)
 {
@@ -2107,12 +3061,18 @@ psmove_reset_magnetometer_calibration(PSMove *move)
     psmove_return_if_fail(move != NULL);
 
 	move->magnetometer_calibration_direction = *k_psmove_vector_zero;
-    move->magnetometer_min.x =
-        move->magnetometer_min.y =
-        move->magnetometer_min.z = FLT_MAX;
-    move->magnetometer_max.x =
-        move->magnetometer_max.y =
-        move->magnetometer_max.z = FLT_MIN;
+    memset(&move->magnetometer_ellipsoid, 0, sizeof(move->magnetometer_ellipsoid));
+
+    if (!psmove_input_formats[move->model].magnetometer) {
+        return;
+    }
+
+    /* Collect readings from the next psmove_poll() calls for a new fit */
+    if (move->magnetometer_fit) {
+        psmove_magnetometer_fit_reset(move->magnetometer_fit);
+    } else {
+        move->magnetometer_fit = psmove_magnetometer_fit_new();
+    }
 }
 
 char *
@@ -2135,9 +3095,23 @@ psmove_get_magnetometer_calibration_filename(PSMove *move)
 }
 
 
+/* Layout of CalibrationSection_Magnetometer in the calibration store (min/max of earlier versions) */
+struct PSMove_MagnetometerSection {
+    float mx, my, mz;
+    float xmin, xmax;
+    float ymin, ymax;
+    float zmin, zmax;
+};
+
+/* Layout of CalibrationSection_MagnetometerEllipsoid in the calibration store */
+struct PSMove_MagnetometerEllipsoidSection {
+    float mx, my, mz;
+    PSMove_MagnetometerEllipsoid ellipsoid;
+};
+
 /**
- * Magic value for basic sanity checks (and in the future
- * endianness conversion, if needed).
+ * Magic value of the magnetometer calibration files of earlier versions
+ * (before the calibration store), which are imported into the store.
  *
  * If written in little-endian, this will spell "MvCl" as in "Move Calibration".
  **/
@@ -2146,58 +3120,60 @@ PSMOVE_CALIBRATION_MAGIC = 0x6c43764d;
 
 struct PSMove_CalibrationData {
     uint32_t endian_magic; // PSMOVE_CALIBRATION_MAGIC
-    float mx, my, mz;
-    float xmin, xmax;
-    float ymin, ymax;
-    float zmin, zmax;
+    struct PSMove_MagnetometerSection section;
 };
 
+/* Key of the controller in the calibration store (result must be freed) */
+static char *
+psmove_get_calibration_store_key(PSMove *move)
+{
+    char *serial = psmove_get_serial(move);
+    psmove_return_val_if_fail(serial != NULL, NULL);
+
+    return _psmove_normalize_btaddr_inplace(serial, true, '_');
+}
+
 void
 psmove_save_magnetometer_calibration(PSMove *move)
 {
     psmove_return_if_fail(move != NULL);
-    char *filename = psmove_get_magnetometer_calibration_filename(move);
-    FILE *fp = fopen(filename, "wb");
-    psmove_free_mem(filename);
-    psmove_return_if_fail(fp != NULL);
+    char *key = psmove_get_calibration_store_key(move);
+    psmove_return_if_fail(key != NULL);
+
+    if (move->magnetometer_fit) {
+        /* Use all readings collected so far, then stop collecting */
+        psmove_magnetometer_fit_update(move->magnetometer_fit);
+        if (!psmove_magnetometer_fit_get(move->magnetometer_fit, &move->magnetometer_ellipsoid)) {
+            PSMOVE_WARNING("Not enough magnetometer readings for an ellipsoid fit, saving range only");
+        }
+
+        psmove_magnetometer_fit_free(move->magnetometer_fit);
+        move->magnetometer_fit = NULL;
+    }
 
-    struct PSMove_CalibrationData data = {
-        .endian_magic = PSMOVE_CALIBRATION_MAGIC,
+    struct PSMove_MagnetometerEllipsoidSection section = {
         .mx = move->magnetometer_calibration_direction.x,
         .my = move->magnetometer_calibration_direction.y,
         .mz = move->magnetometer_calibration_direction.z,
-        .xmin = move->magnetometer_min.x,
-        .xmax = move->magnetometer_max.x,
-        .ymin = move->magnetometer_min.y,
-        .ymax = move->magnetometer_max.y,
-        .zmin = move->magnetometer_min.z,
-        .zmax = move->magnetometer_max.z,
+        .ellipsoid = move->magnetometer_ellipsoid,
     };
 
-    int res = fwrite(&data, 1, sizeof(data), fp);
-    if (res != sizeof(data)) {
-        PSMOVE_WARNING("Error writing calibration data to file (res=%d).", res);
+    if (!psmove_calibration_store_put(key, CalibrationSection_MagnetometerEllipsoid, &section, sizeof(section))) {
+        PSMOVE_WARNING("Error writing magnetometer calibration data for %s", key);
     }
 
-    fclose(fp);
+    psmove_free_mem(key);
 }
 
-bool
-psmove_load_magnetometer_calibration(PSMove *move)
+/* Load the magnetometer calibration file of an earlier version */
+static bool
+psmove_load_magnetometer_calibration_file(PSMove *move, struct PSMove_MagnetometerSection *section)
 {
-    if (move == NULL) {
-        return false;
-    }
-
-    psmove_reset_magnetometer_calibration(move);
     char *filename = psmove_get_magnetometer_calibration_filename(move);
     FILE *fp = fopen(filename, "rb");
     psmove_free_mem(filename);
 
     if (fp == NULL) {
-        char *addr = psmove_get_serial(move);
-        PSMOVE_WARNING("Magnetometer in %s not yet calibrated.", addr);
-        psmove_free_mem(addr);
         return false;
     }
 
@@ -2210,31 +3186,99 @@ psmove_load_magnetometer_calibration(PSMove *move)
 
     if (res != sizeof(data) || data.endian_magic != PSMOVE_CALIBRATION_MAGIC) {
         PSMOVE_WARNING("Error reading calibration file (res=%d, magic=0x%08x)", res, data.endian_magic);
-        psmove_reset_magnetometer_calibration(move);
         return false;
     }
 
-    move->magnetometer_calibration_direction.x = data.mx;
-    move->magnetometer_calibration_direction.y = data.my;
-    move->magnetometer_calibration_direction.z = data.mz;
-    move->magnetometer_min.x = data.xmin;
-    move->magnetometer_max.x = data.xmax;
-    move->magnetometer_min.y = data.ymin;
-    move->magnetometer_max.y = data.ymax;
-    move->magnetometer_min.z = data.zmin;
-    move->magnetometer_max.z = data.zmax;
+    *section = data.section;
+    return true;
+}
+
+bool
+psmove_load_magnetometer_calibration(PSMove *move)
+{
+    if (move == NULL) {
+        return false;
+    }
+
+    psmove_reset_magnetometer_calibration(move);
+
+    char *key = psmove_get_calibration_store_key(move);
+    if (key == NULL) {
+        return false;
+    }
+
+    struct PSMove_MagnetometerEllipsoidSection section;
+    memset(&section, 0, sizeof(section));
+
+    if (psmove_calibration_store_get(key, CalibrationSection_MagnetometerEllipsoid,
+                &section, sizeof(section)) != sizeof(section)) {
+        struct PSMove_MagnetometerSection old_section;
+        memset(&old_section, 0, sizeof(old_section));
+
+        if (psmove_calibration_store_get(key, CalibrationSection_Magnetometer,
+                    &old_section, sizeof(old_section)) != sizeof(old_section) &&
+                !psmove_load_magnetometer_calibration_file(move, &old_section)) {
+            PSMOVE_WARNING("Magnetometer in %s not yet calibrated.", key);
+            psmove_free_mem(key);
+            return false;
+        }
+
+        /* Found a min/max calibration of an earlier version, convert it */
+        float min[3] = { old_section.xmin, old_section.ymin, old_section.zmin };
+        float max[3] = { old_section.xmax, old_section.ymax, old_section.zmax };
+
+        section.mx = old_section.mx;
+        section.my = old_section.my;
+        section.mz = old_section.mz;
+        psmove_magnetometer_ellipsoid_from_box(&section.ellipsoid, min, max);
+
+        psmove_calibration_store_put(key, CalibrationSection_MagnetometerEllipsoid, &section, sizeof(section));
+    }
+
+    psmove_free_mem(key);
+
+    move->magnetometer_calibration_direction.x = section.mx;
+    move->magnetometer_calibration_direction.y = section.my;
+    move->magnetometer_calibration_direction.z = section.mz;
+    move->magnetometer_ellipsoid = section.ellipsoid;
+
+    /* Calibrated, no need to collect readings */
+    if (move->magnetometer_fit) {
+        psmove_magnetometer_fit_free(move->magnetometer_fit);
+        move->magnetometer_fit = NULL;
+    }
 
     return true;
 }
 
+bool
+psmove_reload_calibration(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, false);
+
+    if (move->type == PSMove_REPLAY) {
+        /* Replays use the calibration from the capture */
+        return false;
+    }
+
+    psmove_calibration_store_reload();
+
+    bool result = move->calibration && psmove_calibration_reload(move->calibration);
+    psmove_update_input_transforms(move);
+
+    if (move->model != Model_ZCM2) {
+        result = psmove_load_magnetometer_calibration(move) && result;
+    }
+
+    return result;
+}
+
 float
 psmove_get_magnetometer_calibration_range(PSMove *move)
 {
     psmove_return_val_if_fail(move != NULL, 0);
 
-	PSMove_3AxisVector diff = psmove_3axisvector_subtract(&move->magnetometer_max, &move->magnetometer_min);
-
-    return psmove_3axisvector_min_component(&diff);
+    return move->magnetometer_ellipsoid.range;
 }
 
 void
@@ -2246,6 +3290,34 @@ psmove_set_orientation_fusion_type(PSMove *move, enum PSMoveOrientation_Fusion_T
 	psmove_orientation_set_fusion_type(move->orientation, fusion_type);
 }
 
+bool
+psmove_get_orientation_covariance(PSMove *move, float *covariance)
+{
+    psmove_return_val_if_fail(move != NULL, false);
+    psmove_return_val_if_fail(move->orientation != NULL, false);
+
+    return psmove_orientation_get_covariance(move->orientation, covariance);
+}
+
+void
+psmove_set_gyroscope_bias_estimation(PSMove *move, bool enabled)
+{
+    psmove_return_if_fail(move != NULL);
+    psmove_return_if_fail(move->calibration != NULL);
+
+    psmove_calibration_set_gyroscope_bias_estimation(move->calibration, enabled);
+    psmove_update_input_transforms(move);
+}
+
+bool
+psmove_get_gyroscope_bias(PSMove *move, PSMove_3AxisVector *out_bias)
+{
+    psmove_return_val_if_fail(move != NULL, false);
+    psmove_return_val_if_fail(move->orientation != NULL, false);
+
+    return psmove_orientation_get_gyroscope_bias(move->orientation, out_bias);
+}
+
 void
 psmove_set_calibration_pose(PSMove *move, enum PSMove_CalibrationPose_Type calibration_pose)
 {
@@ -2336,6 +3408,11 @@ void
 psmove_set_sensor_data_transform(PSMove *move, const PSMove_3AxisTransform *transform)
 {
     psmove_return_if_fail(move != NULL);
+    psmove_return_if_fail(transform != NULL);
+
+    move->sensor_transform = *transform;
+    psmove_update_input_transforms(move);
+
     psmove_return_if_fail(move->orientation != NULL);
 
 	psmove_orientation_set_sensor_data_transform(move->orientation, transform);
@@ -2352,9 +3429,13 @@ psmove_get_transformed_magnetometer_direction(PSMove *move, PSMove_3AxisVector *
 void
 psmove_get_transformed_accelerometer_frame_3axisvector(PSMove *move, enum PSMove_Frame frame, PSMove_3AxisVector *out_a)
 {
-	psmove_return_if_fail(move != NULL);
+    psmove_return_if_fail(move != NULL);
+    psmove_return_if_fail(frame == Frame_FirstHalf || frame == Frame_SecondHalf);
+    psmove_return_if_fail(out_a != NULL);
 
-	*out_a= psmove_orientation_get_accelerometer_vector(move->orientation, frame);
+    float values[3];
+    psmove_get_calibrated_frame(move, true, Sensor_Accelerometer, frame, values);
+    *out_a = psmove_3axisvector_xyz(values[0], values[1], values[2]);
 }
 
 void
@@ -2368,9 +3449,52 @@ psmove_get_transformed_accelerometer_frame_direction(PSMove *move, enum PSMove_F
 void
 psmove_get_transformed_gyroscope_frame_3axisvector(PSMove *move, enum PSMove_Frame frame, PSMove_3AxisVector *out_w)
 {
-	psmove_return_if_fail(move != NULL);
+    psmove_return_if_fail(move != NULL);
+    psmove_return_if_fail(frame == Frame_FirstHalf || frame == Frame_SecondHalf);
+    psmove_return_if_fail(out_w != NULL);
+
+    float values[3];
+    psmove_get_calibrated_frame(move, true, Sensor_Gyroscope, frame, values);
+    *out_w = psmove_3axisvector_xyz(values[0], values[1], values[2]);
+}
+
+void
+_psmove_set_fixed_point(PSMove *move, bool enabled)
+{
+    psmove_return_if_fail(move != NULL);
+
+    move->fixed_point = enabled;
 
-	*out_w= psmove_orientation_get_gyroscope_vector(move->orientation, frame);
+    /* Convert the transforms (if needed) and re-calibrate the current report */
+    psmove_update_input_transforms(move);
+}
+
+bool
+_psmove_get_fixed_point(PSMove *move)
+{
+    psmove_return_val_if_fail(move != NULL, false);
+
+    return move->fixed_point;
+}
+
+void
+_psmove_get_transformed_accelerometer_frame_fixed(PSMove *move, enum PSMove_Frame frame, int32_t *out_a)
+{
+    psmove_return_if_fail(move != NULL);
+    psmove_return_if_fail(frame == Frame_FirstHalf || frame == Frame_SecondHalf);
+    psmove_return_if_fail(out_a != NULL);
+
+    memcpy(out_a, move->calibrated.transformed_fixed[Sensor_Accelerometer][frame], 3 * sizeof(int32_t));
+}
+
+void
+_psmove_get_transformed_gyroscope_frame_fixed(PSMove *move, enum PSMove_Frame frame, int32_t *out_w)
+{
+    psmove_return_if_fail(move != NULL);
+    psmove_return_if_fail(frame == Frame_FirstHalf || frame == Frame_SecondHalf);
+    psmove_return_if_fail(out_w != NULL);
+
+    memcpy(out_w, move->calibrated.transformed_fixed[Sensor_Gyroscope][frame], 3 * sizeof(int32_t));
 }
 
 void
@@ -2380,6 +3504,10 @@ psmove_disconnect(PSMove *move)
 
     switch (move->type) {
         case PSMove_HIDAPI:
+            if (move->reader) {
+                /* Stop the reader thread before its handle goes away */
+                psmove_reader_free(move->reader);
+            }
             hid_close(move->handle);
             if (move->handle_addr) {// _WIN32 only
                 hid_close(move->handle_addr);
@@ -2388,8 +3516,13 @@ psmove_disconnect(PSMove *move)
         case PSMove_MOVED:
             // XXX: Close connection?
             break;
+        case PSMove_REPLAY:
+            psmove_capture_reader_free(move->replay);
+            break;
     }
 
+    psmove_stop_recording(move);
+
     if (move->orientation) {
         psmove_orientation_free(move->orientation);
     }
@@ -2398,6 +3531,18 @@ psmove_disconnect(PSMove *move)
         psmove_calibration_free(move->calibration);
     }
 
+    if (move->clock) {
+        psmove_clock_free(move->clock);
+    }
+
+    if (move->history) {
+        psmove_history_free(move->history);
+    }
+
+    if (move->magnetometer_fit) {
+        psmove_magnetometer_fit_free(move->magnetometer_fit);
+    }
+
     free(move->serial_number);
     free(move->device_path);
     if (move->device_path_addr) { // _WIN32 only
@@ -2416,6 +3561,12 @@ psmove_util_get_ticks()
     return psmove_port_get_time_ms();
 }
 
+uint64_t
+psmove_util_get_time_us()
+{
+    return psmove_port_get_time_us();
+}
+
 const char *
 psmove_util_get_data_dir()
 {
@@ -31,6 +31,7 @@
 
 #include "psmove_private.h"
 #include "psmove_calibration.h"
+#include "psmove_calibration_store.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -38,8 +39,29 @@
 #include <assert.h>
 #include <math.h>
 
+/* Calibration files of earlier versions, imported into the calibration store */
 #define PSMOVE_CALIBRATION_EXTENSION ".calibration"
 
+/* One gyroscope bias table entry per degree Celsius (-10..70, see _psmove_temperature_to_celsius()) */
+#define PSMOVE_GYRO_BIAS_MIN_CELSIUS (-10)
+#define PSMOVE_GYRO_BIAS_TEMPERATURES 81
+
+/* Number of half-frames (about one second) the controller has to be at rest for a bias estimate */
+#define PSMOVE_GYRO_BIAS_WINDOW 176
+
+/* Maximum spread of the gyroscope (rad/s) and accelerometer (g) readings while at rest */
+#define PSMOVE_GYRO_BIAS_MAX_GYRO_RANGE 0.05f
+#define PSMOVE_GYRO_BIAS_MAX_ACCEL_RANGE 0.03f
+
+/* Estimates further from the factory drift (rad/s) are taken as slow rotation, not bias */
+#define PSMOVE_GYRO_BIAS_MAX_OFFSET 0.15f
+
+/* Estimates are averaged until an entry has this many, then blended in with 1/N weight */
+#define PSMOVE_GYRO_BIAS_MAX_WEIGHT 32
+
+/* Update the mapping if the bias changes by more than this many raw units */
+#define PSMOVE_GYRO_BIAS_MIN_CHANGE 0.1f
+
 enum _PSMoveCalibrationFlag {
     CalibrationFlag_None = 0,
     CalibrationFlag_HaveUSB,
@@ -51,6 +73,9 @@ struct _PSMoveCalibration {
     char usb_calibration[PSMOVE_MAX_CALIBRATION_BLOB_SIZE];
     int flags;
 
+    /* Key in the calibration store (normalized serial), NULL if not persisted */
+    char *store_key;
+
     char *filename;
 
     /**
@@ -72,6 +97,33 @@ struct _PSMoveCalibration {
 
     /* Pre-calculated raw drift values for gyroscope mapping */
     int dx, dy, dz;
+
+    /* Raw gyroscope drift used for the mapping (dx, dy, dz or from the bias table) */
+    float gyro_bias[3];
+
+    /* Temperature-indexed gyroscope bias table (raw readings at rest) */
+    struct {
+        float bias[3];
+        uint32_t count;
+    } gyro_bias_table[PSMOVE_GYRO_BIAS_TEMPERATURES];
+
+    /* Has the bias table changed since it was saved? */
+    bool gyro_bias_table_changed;
+
+    /* Estimate the gyroscope bias while the controller is at rest? */
+    bool gyro_bias_estimation;
+
+    /* Temperature (table index) of the current gyro_bias, -1 if none */
+    int gyro_bias_temperature;
+
+    /* Readings since the controller came to rest (all at the same temperature) */
+    struct {
+        int count;
+        int temperature;
+        float gyro_sum[3];
+        int gyro_min[3], gyro_max[3];
+        int accel_min[3], accel_max[3];
+    } gyro_bias_window;
 };
 
 
@@ -90,6 +142,12 @@ struct _PSMoveCalibration {
 int
 psmove_calibration_read_from_usb(PSMoveCalibration *calibration);
 
+/* Layout of CalibrationSection_USB in the store (and of the old calibration files) */
+typedef struct {
+    char usb_calibration[PSMOVE_MAX_CALIBRATION_BLOB_SIZE];
+    int flags;
+} PSMoveCalibration_USBSection;
+
 /**
  * Load the calibration from persistent storage.
  *
@@ -106,6 +164,22 @@ psmove_calibration_load(PSMoveCalibration *calibration);
 int
 psmove_calibration_save(PSMoveCalibration *calibration);
 
+/**
+ * Load the gyroscope bias table from persistent storage.
+ *
+ * Returns nonzero on success, zero on error.
+ **/
+int
+psmove_calibration_load_gyroscope_bias(PSMoveCalibration *calibration);
+
+/**
+ * Save the gyroscope bias table to persistent storage.
+ *
+ * Returns nonzero on success, zero on error.
+ **/
+int
+psmove_calibration_save_gyroscope_bias(PSMoveCalibration *calibration);
+
 
 
 
@@ -405,56 +479,15 @@ psmove_calibration_dump_usb(PSMoveCalibration *calibration)
 
 
 
-PSMoveCalibration *
-psmove_calibration_new(PSMove *move)
+/**
+ * Pre-calculate values used for mapping input from the USB calibration
+ * blob (or set up pass-through mapping if there is no calibration data).
+ **/
+static void
+psmove_calibration_precalculate(PSMoveCalibration *calibration)
 {
-    PSMove_Data_BTAddr addr;
-    char *serial;
-
-    enum PSMove_Model_Type model = psmove_get_model(move);
-
-    PSMoveCalibration *calibration =
-        (PSMoveCalibration*)calloc(1, sizeof(PSMoveCalibration));
-
-    calibration->move = move;
-
-    if (psmove_connection_type(move) == Conn_USB) {
-        _psmove_read_btaddrs(move, NULL, &addr);
-        serial = _psmove_btaddr_to_string(addr);
-    } else {
-        serial = psmove_get_serial(move);
-    }
-
-    if (!serial) {
-        PSMOVE_ERROR("Could not determine serial from controller");
-        free(calibration);
-        return NULL;
-    }
-
-    serial = _psmove_normalize_btaddr_inplace(serial, true, '_');
-
-    char *template = malloc(strlen(serial) +
-            strlen(PSMOVE_CALIBRATION_EXTENSION) + 1);
-    strcpy(template, serial);
-    strcat(template, PSMOVE_CALIBRATION_EXTENSION);
-
-    calibration->filename = psmove_util_get_file_path(template);
-    calibration->system_filename = psmove_util_get_system_file_path(template);
-
-    free(template);
-    psmove_free_mem(serial);
-
-    /* Try to load the calibration data from disk, or from USB */
-    psmove_calibration_load(calibration);
-    if (!psmove_calibration_supported(calibration)) {
-        if (psmove_connection_type(move) == Conn_USB) {
-            PSMOVE_DEBUG("Storing calibration from USB");
-            psmove_calibration_read_from_usb(calibration);
-            psmove_calibration_save(calibration);
-        }
-    }
+    enum PSMove_Model_Type model = psmove_get_model(calibration->move);
 
-    /* Pre-calculate values used for mapping input */
     if (psmove_calibration_supported(calibration)) {
         /* Accelerometer reading (high/low) for each axis */
         int axlow, axhigh, aylow, ayhigh, azlow, azhigh;
@@ -610,9 +643,116 @@ psmove_calibration_new(PSMove *move)
         calibration->dz = 0;
     }
 
+    calibration->gyro_bias[0] = (float)calibration->dx;
+    calibration->gyro_bias[1] = (float)calibration->dy;
+    calibration->gyro_bias[2] = (float)calibration->dz;
+    calibration->gyro_bias_temperature = -1;
+}
+
+PSMoveCalibration *
+psmove_calibration_new(PSMove *move)
+{
+    PSMove_Data_BTAddr addr;
+    char *serial;
+
+    PSMoveCalibration *calibration =
+        (PSMoveCalibration*)calloc(1, sizeof(PSMoveCalibration));
+
+    calibration->move = move;
+
+    if (psmove_connection_type(move) == Conn_USB) {
+        _psmove_read_btaddrs(move, NULL, &addr);
+        serial = _psmove_btaddr_to_string(addr);
+    } else {
+        serial = psmove_get_serial(move);
+    }
+
+    if (!serial) {
+        PSMOVE_ERROR("Could not determine serial from controller");
+        free(calibration);
+        return NULL;
+    }
+
+    serial = _psmove_normalize_btaddr_inplace(serial, true, '_');
+
+    char *template = malloc(strlen(serial) +
+            strlen(PSMOVE_CALIBRATION_EXTENSION) + 1);
+    strcpy(template, serial);
+    strcat(template, PSMOVE_CALIBRATION_EXTENSION);
+
+    calibration->filename = psmove_util_get_file_path(template);
+    calibration->system_filename = psmove_util_get_system_file_path(template);
+
+    free(template);
+
+    calibration->store_key = serial;
+
+    /* Try to load the calibration data from disk, or from USB */
+    psmove_calibration_load(calibration);
+    if (!psmove_calibration_supported(calibration)) {
+        if (psmove_connection_type(move) == Conn_USB) {
+            PSMOVE_DEBUG("Storing calibration from USB");
+            psmove_calibration_read_from_usb(calibration);
+            psmove_calibration_save(calibration);
+        }
+    }
+
+    psmove_calibration_precalculate(calibration);
+
+    calibration->gyro_bias_estimation = true;
+    psmove_calibration_load_gyroscope_bias(calibration);
+
+    return calibration;
+}
+
+PSMoveCalibration *
+psmove_calibration_new_from_usb_data(PSMove *move, const char *data, size_t size)
+{
+    psmove_return_val_if_fail(move != NULL, NULL);
+    psmove_return_val_if_fail(data != NULL || size == 0, NULL);
+
+    PSMoveCalibration *calibration =
+        (PSMoveCalibration*)calloc(1, sizeof(PSMoveCalibration));
+
+    calibration->move = move;
+
+    if (size > 0) {
+        if (size > sizeof(calibration->usb_calibration)) {
+            PSMOVE_WARNING("Calibration blob too large (%d bytes)", (int)size);
+        } else {
+            memcpy(calibration->usb_calibration, data, size);
+            calibration->flags |= CalibrationFlag_HaveUSB;
+        }
+    }
+
+    psmove_calibration_precalculate(calibration);
+
+    /* Estimated, but not persisted (there is no controller to store it for) */
+    calibration->gyro_bias_estimation = true;
+
     return calibration;
 }
 
+int
+psmove_calibration_get_usb_data(PSMoveCalibration *calibration,
+        const char **data, size_t *size)
+{
+    psmove_return_val_if_fail(calibration != NULL, 0);
+    psmove_return_val_if_fail(data != NULL, 0);
+    psmove_return_val_if_fail(size != NULL, 0);
+
+    if (!psmove_calibration_supported(calibration)) {
+        return 0;
+    }
+
+    *data = calibration->usb_calibration;
+    *size = (psmove_get_model(calibration->move) == Model_ZCM1)
+        ? PSMOVE_ZCM1_CALIBRATION_BLOB_SIZE
+        : PSMOVE_ZCM2_CALIBRATION_BLOB_SIZE;
+
+    return 1;
+}
+
 int
 psmove_calibration_read_from_usb(PSMoveCalibration *calibration)
 {
@@ -661,6 +801,18 @@ psmove_calibration_dump(PSMoveCalibration *calibration)
         printf("Have USB calibration:\n");
         psmove_calibration_dump_usb(calibration);
     }
+
+    printf("Store key: %s\n", calibration->store_key ? calibration->store_key : "(none)");
+    for (int i=0; i<PSMOVE_GYRO_BIAS_TEMPERATURES; i++) {
+        if (calibration->gyro_bias_table[i].count > 0) {
+            printf("# Gyro bias at %d °C: (%.1f | %.1f | %.1f), %u estimates\n",
+                    i + PSMOVE_GYRO_BIAS_MIN_CELSIUS,
+                    calibration->gyro_bias_table[i].bias[0],
+                    calibration->gyro_bias_table[i].bias[1],
+                    calibration->gyro_bias_table[i].bias[2],
+                    calibration->gyro_bias_table[i].count);
+        }
+    }
 }
 
 void
@@ -689,30 +841,294 @@ psmove_calibration_map_gyroscope(PSMoveCalibration *calibration,
     psmove_return_if_fail(raw_input != NULL);
 
     if (gx) {
-        *gx = (float)(raw_input[0] - calibration->dx) * calibration->gx;
+        *gx = ((float)raw_input[0] - calibration->gyro_bias[0]) * calibration->gx;
     }
 
     if (gy) {
-        *gy = (float)(raw_input[1] - calibration->dy) * calibration->gy;
+        *gy = ((float)raw_input[1] - calibration->gyro_bias[1]) * calibration->gy;
     }
 
     if (gz) {
-        *gz = (float)(raw_input[2] - calibration->dz) * calibration->gz;
+        *gz = ((float)raw_input[2] - calibration->gyro_bias[2]) * calibration->gz;
+    }
+}
+
+void
+psmove_calibration_get_accelerometer_affine(PSMoveCalibration *calibration,
+        float affine[3][4])
+{
+    psmove_return_if_fail(calibration != NULL);
+    psmove_return_if_fail(affine != NULL);
+
+    memset(affine, 0, sizeof(float) * 3 * 4);
+
+    affine[0][0] = calibration->ax;
+    affine[1][1] = calibration->ay;
+    affine[2][2] = calibration->az;
+
+    affine[0][3] = calibration->bx;
+    affine[1][3] = calibration->by;
+    affine[2][3] = calibration->bz;
+}
+
+void
+psmove_calibration_get_gyroscope_affine(PSMoveCalibration *calibration,
+        float affine[3][4])
+{
+    psmove_return_if_fail(calibration != NULL);
+    psmove_return_if_fail(affine != NULL);
+
+    memset(affine, 0, sizeof(float) * 3 * 4);
+
+    affine[0][0] = calibration->gx;
+    affine[1][1] = calibration->gy;
+    affine[2][2] = calibration->gz;
+
+    /* (raw - d) * g = g * raw - d * g */
+    affine[0][3] = -calibration->gyro_bias[0] * calibration->gx;
+    affine[1][3] = -calibration->gyro_bias[1] * calibration->gy;
+    affine[2][3] = -calibration->gyro_bias[2] * calibration->gz;
+}
+
+/**
+ * Get the bias for a temperature (table index) from the bias table,
+ * interpolated between the nearest entries if there is none for it.
+ *
+ * Returns nonzero on success, zero if the table is empty.
+ **/
+static int
+psmove_calibration_lookup_gyroscope_bias(PSMoveCalibration *calibration,
+        int temperature, float *bias)
+{
+    int below = temperature;
+    int above = temperature;
+    int i;
+
+    while (below >= 0 && calibration->gyro_bias_table[below].count == 0) {
+        below--;
+    }
+
+    while (above < PSMOVE_GYRO_BIAS_TEMPERATURES && calibration->gyro_bias_table[above].count == 0) {
+        above++;
+    }
+
+    if (below < 0 && above == PSMOVE_GYRO_BIAS_TEMPERATURES) {
+        return 0;
+    }
+
+    if (below < 0) {
+        below = above;
+    } else if (above == PSMOVE_GYRO_BIAS_TEMPERATURES) {
+        above = below;
+    }
+
+    for (i=0; i<3; i++) {
+        float low = calibration->gyro_bias_table[below].bias[i];
+        float high = calibration->gyro_bias_table[above].bias[i];
+
+        if (above == below) {
+            bias[i] = low;
+        } else {
+            bias[i] = low + (high - low) * (float)(temperature - below) / (float)(above - below);
+        }
+    }
+
+    return 1;
+}
+
+/* Start a new at-rest window with the given readings */
+static void
+psmove_calibration_restart_gyroscope_bias_window(PSMoveCalibration *calibration,
+        int temperature, const int16_t *accelerometer, const int16_t *gyroscope)
+{
+    int i;
+
+    calibration->gyro_bias_window.count = 1;
+    calibration->gyro_bias_window.temperature = temperature;
+
+    for (i=0; i<3; i++) {
+        calibration->gyro_bias_window.gyro_sum[i] = (float)gyroscope[i];
+        calibration->gyro_bias_window.gyro_min[i] = gyroscope[i];
+        calibration->gyro_bias_window.gyro_max[i] = gyroscope[i];
+        calibration->gyro_bias_window.accel_min[i] = accelerometer[i];
+        calibration->gyro_bias_window.accel_max[i] = accelerometer[i];
     }
 }
 
+/* Add readings to the at-rest window, restarting it if the controller moved */
+static void
+psmove_calibration_add_to_gyroscope_bias_window(PSMoveCalibration *calibration,
+        int temperature, const int16_t *accelerometer, const int16_t *gyroscope)
+{
+    const float gyro_gain[3] = { calibration->gx, calibration->gy, calibration->gz };
+    const float accel_gain[3] = { calibration->ax, calibration->ay, calibration->az };
+    int gyro_min[3], gyro_max[3], accel_min[3], accel_max[3];
+    int i;
+
+    if (calibration->gyro_bias_window.count == 0 ||
+            calibration->gyro_bias_window.temperature != temperature) {
+        psmove_calibration_restart_gyroscope_bias_window(calibration,
+                temperature, accelerometer, gyroscope);
+        return;
+    }
+
+    for (i=0; i<3; i++) {
+        gyro_min[i] = calibration->gyro_bias_window.gyro_min[i];
+        gyro_max[i] = calibration->gyro_bias_window.gyro_max[i];
+        accel_min[i] = calibration->gyro_bias_window.accel_min[i];
+        accel_max[i] = calibration->gyro_bias_window.accel_max[i];
+
+        if (gyroscope[i] < gyro_min[i]) {
+            gyro_min[i] = gyroscope[i];
+        } else if (gyroscope[i] > gyro_max[i]) {
+            gyro_max[i] = gyroscope[i];
+        }
+
+        if (accelerometer[i] < accel_min[i]) {
+            accel_min[i] = accelerometer[i];
+        } else if (accelerometer[i] > accel_max[i]) {
+            accel_max[i] = accelerometer[i];
+        }
+
+        if ((float)(gyro_max[i] - gyro_min[i]) * fabsf(gyro_gain[i]) > PSMOVE_GYRO_BIAS_MAX_GYRO_RANGE ||
+                (float)(accel_max[i] - accel_min[i]) * fabsf(accel_gain[i]) > PSMOVE_GYRO_BIAS_MAX_ACCEL_RANGE) {
+            psmove_calibration_restart_gyroscope_bias_window(calibration,
+                    temperature, accelerometer, gyroscope);
+            return;
+        }
+    }
+
+    calibration->gyro_bias_window.count++;
+
+    for (i=0; i<3; i++) {
+        calibration->gyro_bias_window.gyro_sum[i] += (float)gyroscope[i];
+        calibration->gyro_bias_window.gyro_min[i] = gyro_min[i];
+        calibration->gyro_bias_window.gyro_max[i] = gyro_max[i];
+        calibration->gyro_bias_window.accel_min[i] = accel_min[i];
+        calibration->gyro_bias_window.accel_max[i] = accel_max[i];
+    }
+}
+
+/* Add the mean of a completed at-rest window to the bias table */
+static void
+psmove_calibration_add_gyroscope_bias_estimate(PSMoveCalibration *calibration)
+{
+    const float gyro_gain[3] = { calibration->gx, calibration->gy, calibration->gz };
+    const float factory[3] = { (float)calibration->dx, (float)calibration->dy, (float)calibration->dz };
+    int temperature = calibration->gyro_bias_window.temperature;
+    float mean[3];
+    int i;
+
+    for (i=0; i<3; i++) {
+        mean[i] = calibration->gyro_bias_window.gyro_sum[i] / (float)calibration->gyro_bias_window.count;
+
+        /* Turning slowly (but steadily) also looks like being at rest */
+        if (fabsf((mean[i] - factory[i]) * gyro_gain[i]) > PSMOVE_GYRO_BIAS_MAX_OFFSET) {
+            return;
+        }
+    }
+
+    if (calibration->gyro_bias_table[temperature].count < PSMOVE_GYRO_BIAS_MAX_WEIGHT) {
+        calibration->gyro_bias_table[temperature].count++;
+    }
+
+    for (i=0; i<3; i++) {
+        float *bias = &calibration->gyro_bias_table[temperature].bias[i];
+        *bias += (mean[i] - *bias) / (float)calibration->gyro_bias_table[temperature].count;
+    }
+
+    /* Saved when closing, this runs on the input path */
+    calibration->gyro_bias_table_changed = true;
+}
+
 int
-psmove_calibration_supported(PSMoveCalibration *calibration)
+psmove_calibration_update_gyroscope_bias(PSMoveCalibration *calibration,
+        const int16_t (*accelerometer)[3], const int16_t (*gyroscope)[3], int temperature)
 {
     psmove_return_val_if_fail(calibration != NULL, 0);
+    psmove_return_val_if_fail(accelerometer != NULL, 0);
+    psmove_return_val_if_fail(gyroscope != NULL, 0);
 
-    return (calibration->flags & CalibrationFlag_HaveUSB) != 0;
+    if (!calibration->gyro_bias_estimation || !psmove_calibration_supported(calibration)) {
+        return 0;
+    }
+
+    int index = (int)_psmove_temperature_to_celsius(temperature) - PSMOVE_GYRO_BIAS_MIN_CELSIUS;
+    if (index < 0) {
+        index = 0;
+    } else if (index >= PSMOVE_GYRO_BIAS_TEMPERATURES) {
+        index = PSMOVE_GYRO_BIAS_TEMPERATURES - 1;
+    }
+
+    bool updated = false;
+    int frame;
+
+    for (frame=0; frame<2; frame++) {
+        psmove_calibration_add_to_gyroscope_bias_window(calibration, index,
+                accelerometer[frame], gyroscope[frame]);
+
+        if (calibration->gyro_bias_window.count >= PSMOVE_GYRO_BIAS_WINDOW) {
+            psmove_calibration_add_gyroscope_bias_estimate(calibration);
+            calibration->gyro_bias_window.count = 0;
+            updated = true;
+        }
+    }
+
+    if (!updated && index == calibration->gyro_bias_temperature) {
+        return 0;
+    }
+
+    float bias[3];
+    if (!psmove_calibration_lookup_gyroscope_bias(calibration, index, bias)) {
+        return 0;
+    }
+
+    calibration->gyro_bias_temperature = index;
+
+    int i;
+    for (i=0; i<3; i++) {
+        if (fabsf(bias[i] - calibration->gyro_bias[i]) > PSMOVE_GYRO_BIAS_MIN_CHANGE) {
+            break;
+        }
+    }
+
+    if (i == 3) {
+        return 0;
+    }
+
+    memcpy(calibration->gyro_bias, bias, sizeof(bias));
+    return 1;
+}
+
+void
+psmove_calibration_set_gyroscope_bias_estimation(PSMoveCalibration *calibration, bool enabled)
+{
+    psmove_return_if_fail(calibration != NULL);
+
+    calibration->gyro_bias_estimation = enabled;
+    calibration->gyro_bias_window.count = 0;
+    calibration->gyro_bias_temperature = -1;
+
+    if (!enabled) {
+        /* Back to the drift values from the USB calibration blob */
+        calibration->gyro_bias[0] = (float)calibration->dx;
+        calibration->gyro_bias[1] = (float)calibration->dy;
+        calibration->gyro_bias[2] = (float)calibration->dz;
+    }
 }
 
 int
-psmove_calibration_load(PSMoveCalibration *calibration)
+psmove_calibration_supported(PSMoveCalibration *calibration)
 {
     psmove_return_val_if_fail(calibration != NULL, 0);
+
+    return (calibration->flags & CalibrationFlag_HaveUSB) != 0;
+}
+
+/* Load the calibration file of an earlier version (without calibration store) */
+static int
+psmove_calibration_load_file(PSMoveCalibration *calibration)
+{
     FILE *fp;
 
     fp = fopen(calibration->filename, "rb");
@@ -720,7 +1136,7 @@ psmove_calibration_load(PSMoveCalibration *calibration)
         // use system file in case local is not available
         fp = fopen(calibration->system_filename, "rb");
         if (fp == NULL) {
-            PSMOVE_WARNING("No calibration file found (%s or %s)",
+            PSMOVE_WARNING("No calibration found (in the store, %s or %s)",
                     calibration->filename, calibration->system_filename);
             return 0;
         }
@@ -743,36 +1159,107 @@ psmove_calibration_load(PSMoveCalibration *calibration)
     return 1;
 }
 
+int
+psmove_calibration_load(PSMoveCalibration *calibration)
+{
+    psmove_return_val_if_fail(calibration != NULL, 0);
+    psmove_return_val_if_fail(calibration->store_key != NULL, 0);
+
+    PSMoveCalibration_USBSection section;
+
+    if (psmove_calibration_store_get(calibration->store_key, CalibrationSection_USB,
+                &section, sizeof(section)) == sizeof(section)) {
+        memcpy(calibration->usb_calibration, section.usb_calibration,
+                sizeof(calibration->usb_calibration));
+        calibration->flags = section.flags;
+        return 1;
+    }
+
+    if (!psmove_calibration_load_file(calibration)) {
+        return 0;
+    }
+
+    /* Found an old calibration file, move it into the store */
+    PSMOVE_DEBUG("Importing %s into the calibration store", calibration->filename);
+    psmove_calibration_save(calibration);
+
+    return 1;
+}
+
 int
 psmove_calibration_save(PSMoveCalibration *calibration)
 {
     psmove_return_val_if_fail(calibration != NULL, 0);
+    psmove_return_val_if_fail(calibration->store_key != NULL, 0);
 
-    FILE *fp;
+    PSMoveCalibration_USBSection section;
+    memset(&section, 0, sizeof(section));
+    memcpy(section.usb_calibration, calibration->usb_calibration,
+            sizeof(section.usb_calibration));
+    section.flags = calibration->flags;
 
-    fp = fopen(calibration->filename, "wb");
-    if (fp == NULL) {
+    if (!psmove_calibration_store_put(calibration->store_key, CalibrationSection_USB,
+                &section, sizeof(section))) {
         PSMOVE_ERROR("Unable to write USB calibration");
         return 0;
     }
 
-    if (fwrite(calibration->usb_calibration,
-               sizeof(calibration->usb_calibration),
-               1, fp) != 1) {
-        PSMOVE_ERROR("Unable to write USB calibration");
-        fclose(fp);
+    return 1;
+}
+
+int
+psmove_calibration_load_gyroscope_bias(PSMoveCalibration *calibration)
+{
+    psmove_return_val_if_fail(calibration != NULL, 0);
+    psmove_return_val_if_fail(calibration->store_key != NULL, 0);
+
+    /* Not an error if missing, the table will be built while the controller is used */
+    size_t size = psmove_calibration_store_get(calibration->store_key, CalibrationSection_GyroBias,
+            calibration->gyro_bias_table, sizeof(calibration->gyro_bias_table));
+
+    if (size != sizeof(calibration->gyro_bias_table)) {
+        if (size != 0) {
+            PSMOVE_WARNING("Ignoring gyroscope bias table of wrong size (%d bytes)", (int)size);
+        }
+        memset(calibration->gyro_bias_table, 0, sizeof(calibration->gyro_bias_table));
         return 0;
     }
 
-    if (fwrite(&(calibration->flags),
-               sizeof(calibration->flags),
-               1, fp) != 1) {
-        PSMOVE_ERROR("Unable to write USB calibration");
-        fclose(fp);
+    return 1;
+}
+
+int
+psmove_calibration_save_gyroscope_bias(PSMoveCalibration *calibration)
+{
+    psmove_return_val_if_fail(calibration != NULL, 0);
+    psmove_return_val_if_fail(calibration->store_key != NULL, 0);
+
+    if (!psmove_calibration_store_put(calibration->store_key, CalibrationSection_GyroBias,
+                calibration->gyro_bias_table, sizeof(calibration->gyro_bias_table))) {
+        PSMOVE_ERROR("Unable to write gyroscope bias table");
         return 0;
     }
 
-    fclose(fp);
+    return 1;
+}
+
+int
+psmove_calibration_reload(PSMoveCalibration *calibration)
+{
+    psmove_return_val_if_fail(calibration != NULL, 0);
+
+    if (calibration->store_key == NULL) {
+        /* Created from a USB calibration blob, nothing to reload */
+        return 0;
+    }
+
+    if (!psmove_calibration_load(calibration)) {
+        return 0;
+    }
+
+    psmove_calibration_precalculate(calibration);
+    psmove_calibration_load_gyroscope_bias(calibration);
+
     return 1;
 }
 
@@ -781,8 +1268,13 @@ psmove_calibration_free(PSMoveCalibration *calibration)
 {
     psmove_return_if_fail(calibration != NULL);
 
+    if (calibration->gyro_bias_table_changed && calibration->store_key != NULL) {
+        psmove_calibration_save_gyroscope_bias(calibration);
+    }
+
     psmove_free_mem(calibration->filename);
     psmove_free_mem(calibration->system_filename);
+    psmove_free_mem(calibration->store_key);
     free(calibration);
 }
 
@@ -53,6 +53,32 @@ typedef struct _PSMoveCalibration PSMoveCalibration;
 ADDAPI PSMoveCalibration *
 ADDCALL psmove_calibration_new(PSMove *move);
 
+/**
+ * Create a new calibration object from a USB calibration blob
+ *
+ * move ... a valid PSMove * instance.
+ * data ... the calibration blob (as returned by psmove_calibration_get_usb_data())
+ * size ... size of the calibration blob in bytes
+ *
+ * Nothing is loaded from or saved to disk. This is used for replaying
+ * captures recorded with the calibration of another controller.
+ **/
+ADDAPI PSMoveCalibration *
+ADDCALL psmove_calibration_new_from_usb_data(PSMove *move, const char *data, size_t size);
+
+/**
+ * Load the calibration again from the calibration store
+ *
+ * calibration ... a valid PSMoveCalibration * instance.
+ *
+ * This picks up calibration data stored by another process (after the store
+ * has been mapped again with psmove_calibration_store_reload()).
+ *
+ * Returns nonzero on success, zero if there is no stored calibration.
+ **/
+ADDAPI int
+ADDCALL psmove_calibration_reload(PSMoveCalibration *calibration);
+
 /**
  * Check if a calibration object has the necessary calibration data.
  *
@@ -63,6 +89,19 @@ ADDCALL psmove_calibration_new(PSMove *move);
 ADDAPI int
 ADDCALL psmove_calibration_supported(PSMoveCalibration *calibration);
 
+/**
+ * Get the USB calibration blob of a calibration object.
+ *
+ * calibration ... a valid PSMoveCalibration * instance.
+ * data ... receives a pointer to the blob (owned by the calibration object)
+ * size ... receives the size of the blob in bytes
+ *
+ * Returns nonzero on success, zero if there is no calibration data.
+ **/
+ADDAPI int
+ADDCALL psmove_calibration_get_usb_data(PSMoveCalibration *calibration,
+        const char **data, size_t *size);
+
 /**
  * Map raw accelerometer values to g values
  *
@@ -89,6 +128,55 @@ ADDAPI void
 ADDCALL psmove_calibration_map_gyroscope(PSMoveCalibration *calibration,
         int *raw_input, float *gx, float *gy, float *gz);
 
+/**
+ * Get the accelerometer mapping of psmove_calibration_map_accelerometer()
+ * as an affine transform
+ *
+ * calibration ... a valid PSMoveCalibration * instance.
+ * affine ... receives the 3x4 transform: the calibrated value of axis i
+ *            is affine[i][0..2] * raw (dot product) + affine[i][3]
+ **/
+ADDAPI void
+ADDCALL psmove_calibration_get_accelerometer_affine(PSMoveCalibration *calibration,
+        float affine[3][4]);
+
+/**
+ * Get the gyroscope mapping of psmove_calibration_map_gyroscope() as an
+ * affine transform (see psmove_calibration_get_accelerometer_affine())
+ **/
+ADDAPI void
+ADDCALL psmove_calibration_get_gyroscope_affine(PSMoveCalibration *calibration,
+        float affine[3][4]);
+
+/**
+ * Feed the raw readings of an input report into the gyroscope bias estimation
+ *
+ * calibration ... a valid PSMoveCalibration * instance.
+ * accelerometer ... raw accelerometer values, indexed by [enum PSMove_Frame][axis]
+ * gyroscope ... raw gyroscope values, indexed by [enum PSMove_Frame][axis]
+ * temperature ... the raw temperature of the report (psmove_get_temperature())
+ *
+ * While the controller is at rest, the mean gyroscope reading is added to a
+ * temperature-indexed bias table (persisted in the calibration store).
+ * The gyroscope mapping uses the bias for the current temperature from that
+ * table, interpolated between the nearest temperatures if necessary.
+ *
+ * Returns nonzero if the gyroscope mapping changed, zero otherwise.
+ **/
+ADDAPI int
+ADDCALL psmove_calibration_update_gyroscope_bias(PSMoveCalibration *calibration,
+        const int16_t (*accelerometer)[3], const int16_t (*gyroscope)[3], int temperature);
+
+/**
+ * Enable or disable the gyroscope bias estimation (enabled by default)
+ *
+ * When disabled, the gyroscope mapping uses the drift values from the USB
+ * calibration blob again.
+ **/
+ADDAPI void
+ADDCALL psmove_calibration_set_gyroscope_bias_estimation(PSMoveCalibration *calibration,
+        bool enabled);
+
 /**
  * Dump calibration information to stdout.
  *
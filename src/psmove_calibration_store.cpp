@@ -0,0 +1,396 @@
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+#include "psmove_calibration_store.h"
+#include "psmove_port.h"
+#include "psmove_private.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Magic value at the start of the store file (also detects byte order).
+ *
+ * If written in little-endian, this will spell "PMCS" as in "PS Move Calibration Store".
+ **/
+#define PSMOVE_CALIBRATION_STORE_MAGIC 0x53434d50
+
+/**
+ * Incompatible changes of the file layout increment the major version,
+ * readers refuse files with a different major version. Compatible additions
+ * (e.g. new header fields, readers use header_size to find the entries)
+ * increment the minor version.
+ **/
+#define PSMOVE_CALIBRATION_STORE_VERSION_MAJOR 1
+#define PSMOVE_CALIBRATION_STORE_VERSION_MINOR 0
+
+/* Section data is padded to a multiple of this */
+#define PSMOVE_CALIBRATION_STORE_ALIGNMENT 8
+
+namespace {
+
+struct StoreHeader {
+    uint32_t magic; // PSMOVE_CALIBRATION_STORE_MAGIC
+    uint16_t version_major;
+    uint16_t version_minor;
+    uint32_t header_size; // offset of the first entry
+    uint32_t entry_count;
+    uint64_t generation; // incremented on every change
+};
+
+/* Each entry is followed by size bytes of section data (plus padding) */
+struct StoreEntry {
+    char key[PSMOVE_CALIBRATION_STORE_KEY_SIZE];
+    uint32_t section; // enum PSMoveCalibrationStore_Section
+    uint32_t size;
+};
+
+size_t
+padded_size(size_t size)
+{
+    return (size + PSMOVE_CALIBRATION_STORE_ALIGNMENT - 1) &
+        ~(size_t)(PSMOVE_CALIBRATION_STORE_ALIGNMENT - 1);
+}
+
+struct CalibrationStore {
+    CalibrationStore() = default;
+    ~CalibrationStore();
+
+    CalibrationStore(const CalibrationStore &other) = delete;
+    CalibrationStore &operator=(const CalibrationStore &other) = delete;
+
+    void map();
+    void unmap();
+
+    const StoreHeader *header() const;
+
+    /* True if the mapped file is a store with a different major version */
+    bool incompatible() const;
+
+    /**
+     * Call fn(entry, section_data) for each valid entry, stops early if fn
+     * returns false. Returns false if the mapped file is not a valid store.
+     **/
+    template <typename Fn>
+    bool for_each_entry(Fn fn) const;
+
+    bool write(const std::vector<char> &contents);
+
+    std::mutex mutex;
+    bool initialized { false };
+
+    std::string filename; // user (writable) store file
+    std::string system_filename; // system-wide store file, used if there is no user file
+
+    const char *data { nullptr };
+    size_t size { 0 };
+    bool system { false }; // data is from system_filename
+};
+
+CalibrationStore &
+calibration_store()
+{
+    static CalibrationStore store;
+    return store;
+}
+
+CalibrationStore::~CalibrationStore()
+{
+    unmap();
+}
+
+void
+CalibrationStore::map()
+{
+    if (!initialized) {
+        char *path = psmove_util_get_file_path(PSMOVE_CALIBRATION_STORE_FILENAME);
+        if (path) {
+            filename = path;
+            psmove_free_mem(path);
+        }
+
+        path = psmove_util_get_system_file_path(PSMOVE_CALIBRATION_STORE_FILENAME);
+        if (path) {
+            system_filename = path;
+            psmove_free_mem(path);
+        }
+
+        initialized = true;
+    }
+
+    unmap();
+
+    data = (const char *)psmove_port_map_file(filename.c_str(), &size);
+    system = false;
+    if (data == nullptr && !system_filename.empty()) {
+        data = (const char *)psmove_port_map_file(system_filename.c_str(), &size);
+        system = (data != nullptr);
+    }
+
+    if (data != nullptr && header() == nullptr) {
+        PSMOVE_WARNING("Ignoring invalid or incompatible calibration store");
+    }
+}
+
+void
+CalibrationStore::unmap()
+{
+    if (data != nullptr) {
+        psmove_port_unmap_file(data, size);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+const StoreHeader *
+CalibrationStore::header() const
+{
+    if (data == nullptr || size < sizeof(StoreHeader)) {
+        return nullptr;
+    }
+
+    const StoreHeader *result = (const StoreHeader *)data;
+    if (result->magic != PSMOVE_CALIBRATION_STORE_MAGIC ||
+            result->version_major != PSMOVE_CALIBRATION_STORE_VERSION_MAJOR ||
+            result->header_size < sizeof(StoreHeader) ||
+            result->header_size > size) {
+        return nullptr;
+    }
+
+    return result;
+}
+
+bool
+CalibrationStore::incompatible() const
+{
+    if (data == nullptr || size < sizeof(StoreHeader)) {
+        return false;
+    }
+
+    const StoreHeader *result = (const StoreHeader *)data;
+    return (result->magic == PSMOVE_CALIBRATION_STORE_MAGIC &&
+            result->version_major != PSMOVE_CALIBRATION_STORE_VERSION_MAJOR);
+}
+
+template <typename Fn>
+bool
+CalibrationStore::for_each_entry(Fn fn) const
+{
+    const StoreHeader *h = header();
+    if (h == nullptr) {
+        return false;
+    }
+
+    size_t offset = padded_size(h->header_size);
+    for (uint32_t i=0; i<h->entry_count; i++) {
+        if (offset + sizeof(StoreEntry) > size) {
+            return false;
+        }
+
+        const StoreEntry *entry = (const StoreEntry *)(data + offset);
+        offset += sizeof(StoreEntry);
+
+        if (entry->size > size - offset || entry->key[PSMOVE_CALIBRATION_STORE_KEY_SIZE - 1] != '\0') {
+            return false;
+        }
+
+        if (!fn(entry, data + offset)) {
+            break;
+        }
+
+        offset += padded_size(entry->size);
+    }
+
+    return true;
+}
+
+bool
+CalibrationStore::write(const std::vector<char> &contents)
+{
+    if (filename.empty()) {
+        return false;
+    }
+
+    // Unique name, in case another process writes the store at the same time
+    char *temporary = psmove_port_write_temporary_file(filename.c_str(), contents.data(), contents.size());
+    if (temporary == nullptr) {
+        PSMOVE_ERROR("Unable to write calibration store (%s)", filename.c_str());
+        return false;
+    }
+
+    unmap();
+    bool ok = psmove_port_replace_file(temporary, filename.c_str());
+
+    if (!ok) {
+        PSMOVE_ERROR("Unable to write calibration store (%s)", filename.c_str());
+        remove(temporary);
+    }
+
+    free(temporary);
+
+    map();
+    return ok;
+}
+
+void
+append(std::vector<char> &contents, const void *data, size_t size)
+{
+    const char *bytes = (const char *)data;
+    contents.insert(contents.end(), bytes, bytes + size);
+    contents.resize(padded_size(contents.size()), '\0');
+}
+
+}; // end anonymous namespace
+
+size_t
+psmove_calibration_store_get(const char *key,
+        enum PSMoveCalibrationStore_Section section, void *data, size_t size)
+{
+    psmove_return_val_if_fail(key != NULL, 0);
+    psmove_return_val_if_fail(data != NULL || size == 0, 0);
+
+    CalibrationStore &store = calibration_store();
+    std::lock_guard<std::mutex> lock(store.mutex);
+
+    if (!store.initialized) {
+        store.map();
+    }
+
+    size_t result = 0;
+    store.for_each_entry([&] (const StoreEntry *entry, const char *entry_data) {
+        if (entry->section != (uint32_t)section || strcmp(entry->key, key) != 0) {
+            return true;
+        }
+
+        memcpy(data, entry_data, (entry->size < size) ? entry->size : size);
+        result = entry->size;
+        return false;
+    });
+
+    return result;
+}
+
+bool
+psmove_calibration_store_put(const char *key,
+        enum PSMoveCalibrationStore_Section section, const void *data, size_t size)
+{
+    psmove_return_val_if_fail(key != NULL, false);
+    psmove_return_val_if_fail(strlen(key) < PSMOVE_CALIBRATION_STORE_KEY_SIZE, false);
+    psmove_return_val_if_fail(data != NULL || size == 0, false);
+
+    CalibrationStore &store = calibration_store();
+    std::lock_guard<std::mutex> lock(store.mutex);
+
+    if (!store.initialized) {
+        store.map();
+    }
+
+    if (store.filename.empty()) {
+        return false;
+    }
+
+    // Other processes (e.g. psmove pair while an application is running)
+    // might have changed the store, merge with the current file contents
+    std::string lock_filename = store.filename + ".lock";
+    PSMoveFileLock *file_lock = psmove_port_lock_file(lock_filename.c_str());
+    if (file_lock == nullptr) {
+        PSMOVE_ERROR("Unable to lock calibration store (%s)", lock_filename.c_str());
+        return false;
+    }
+
+    store.map();
+
+    // Don't replace a store written by another (e.g. newer) version of the
+    // library, its entries can't be copied and would be lost
+    if (!store.system && store.incompatible()) {
+        PSMOVE_ERROR("Not overwriting calibration store with version %d (%s)",
+                (int)((const StoreHeader *)store.data)->version_major, store.filename.c_str());
+        psmove_port_unlock_file(file_lock);
+        return false;
+    }
+
+    StoreHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PSMOVE_CALIBRATION_STORE_MAGIC;
+    header.version_major = PSMOVE_CALIBRATION_STORE_VERSION_MAJOR;
+    header.version_minor = PSMOVE_CALIBRATION_STORE_VERSION_MINOR;
+    header.header_size = sizeof(header);
+
+    if (const StoreHeader *old_header = store.header()) {
+        header.generation = old_header->generation;
+    }
+    header.generation++;
+
+    // Copy all other entries, then add the new one at the end
+    std::vector<char> entries;
+    store.for_each_entry([&] (const StoreEntry *entry, const char *entry_data) {
+        if (entry->section != (uint32_t)section || strcmp(entry->key, key) != 0) {
+            append(entries, entry, sizeof(*entry));
+            append(entries, entry_data, entry->size);
+            header.entry_count++;
+        }
+        return true;
+    });
+
+    StoreEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    strcpy(entry.key, key);
+    entry.section = section;
+    entry.size = (uint32_t)size;
+
+    append(entries, &entry, sizeof(entry));
+    append(entries, data, size);
+    header.entry_count++;
+
+    std::vector<char> contents;
+    append(contents, &header, sizeof(header));
+    contents.insert(contents.end(), entries.begin(), entries.end());
+
+    bool result = store.write(contents);
+    psmove_port_unlock_file(file_lock);
+
+    return result;
+}
+
+uint64_t
+psmove_calibration_store_reload()
+{
+    CalibrationStore &store = calibration_store();
+    std::lock_guard<std::mutex> lock(store.mutex);
+
+    store.map();
+
+    const StoreHeader *header = store.header();
+    return header ? header->generation : 0;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "psmove.h"
+
+
+/* File name of the calibration store (see psmove_util_get_file_path()) */
+#define PSMOVE_CALIBRATION_STORE_FILENAME "calibration.store"
+
+/* Maximum length of a key (normalized serial number) including the terminator */
+#define PSMOVE_CALIBRATION_STORE_KEY_SIZE 32
+
+/**
+ * Section types of the calibration store. The layout of a section never
+ * changes, new layouts get a new section type instead.
+ **/
+enum PSMoveCalibrationStore_Section {
+    /* USB calibration blob and flags (see psmove_calibration.c) */
+    CalibrationSection_USB = 1,
+
+    /* Magnetometer calibration direction and range (only read for import, see psmove.c) */
+    CalibrationSection_Magnetometer = 2,
+
+    /* Temperature-indexed gyroscope bias table (see psmove_calibration.c) */
+    CalibrationSection_GyroBias = 3,
+
+    /* Magnetometer calibration direction and ellipsoid fit (see psmove.c) */
+    CalibrationSection_MagnetometerEllipsoid = 4,
+};
+
+
+/**
+ * Get a section of the calibration for a controller from the store
+ *
+ * key ... the normalized serial number of the controller
+ * section ... the section type
+ * data ... buffer that receives (up to) size bytes of the section
+ *
+ * The store file is memory-mapped once (on first use, read into memory on
+ * Windows), so looking up the calibrations of many controllers does not open
+ * any more files.
+ *
+ * Returns the size of the stored section, or 0 if it is not in the store.
+ **/
+ADDAPI size_t
+ADDCALL psmove_calibration_store_get(const char *key,
+        enum PSMoveCalibrationStore_Section section, void *data, size_t size);
+
+/**
+ * Add or replace a section of the calibration for a controller in the store
+ *
+ * The store is rewritten to a temporary file that then atomically replaces
+ * the store file, so other processes never see a partially written store.
+ * Writers are serialized with a lock file next to the store, and the new
+ * section is merged into the current store file, so that sections written
+ * by other processes in the meantime are kept. A store written by another
+ * (e.g. newer) version of the library with a different layout is never
+ * replaced.
+ *
+ * Returns true on success.
+ **/
+ADDAPI bool
+ADDCALL psmove_calibration_store_put(const char *key,
+        enum PSMoveCalibrationStore_Section section, const void *data, size_t size);
+
+/**
+ * Map the store file again to pick up changes made by other processes
+ *
+ * Returns the generation of the store (incremented on every change).
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_calibration_store_reload();
+
+#ifdef __cplusplus
+}
+#endif
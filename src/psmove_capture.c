@@ -0,0 +1,406 @@
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+#include "psmove_private.h"
+#include "psmove_capture.h"
+#include "math/psmove_vector.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PSMOVE_CAPTURE_MAGIC_SIZE 8
+#define PSMOVE_CAPTURE_MAX_SERIAL_SIZE 255
+
+/* Size of the fixed part of a record (type, length, time delta) */
+#define PSMOVE_CAPTURE_RECORD_HEADER_SIZE 6
+
+/* Size of a float32 vector with n components */
+#define PSMOVE_CAPTURE_FLOATS_SIZE(n) ((n) * 4)
+
+struct _PSMoveCaptureWriter {
+    FILE *fp;
+    bool started;
+    uint64_t last_us;
+};
+
+struct _PSMoveCaptureReader {
+    FILE *fp;
+    char serial[PSMOVE_CAPTURE_MAX_SERIAL_SIZE + 1];
+    enum PSMove_Model_Type model;
+    char *calibration;
+    size_t calibration_size;
+    PSMove_3AxisVector magnetometer_direction;
+
+    PSMoveCapture_Record record;
+    bool have_record;
+    bool finished;
+};
+
+static void
+psmove_capture_put_u16(unsigned char *out, uint16_t value)
+{
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+}
+
+static void
+psmove_capture_put_u32(unsigned char *out, uint32_t value)
+{
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+static void
+psmove_capture_put_floats(unsigned char *out, const float *values, int count)
+{
+    union {
+        uint32_t u32;
+        float f;
+    } v;
+
+    int i;
+    for (i=0; i<count; i++) {
+        v.f = values[i];
+        psmove_capture_put_u32(out + 4 * i, v.u32);
+    }
+}
+
+static uint16_t
+psmove_capture_get_u16(const unsigned char *in)
+{
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t
+psmove_capture_get_u32(const unsigned char *in)
+{
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) |
+        ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static void
+psmove_capture_get_floats(const unsigned char *in, float *values, int count)
+{
+    union {
+        uint32_t u32;
+        float f;
+    } v;
+
+    int i;
+    for (i=0; i<count; i++) {
+        v.u32 = psmove_capture_get_u32(in + 4 * i);
+        values[i] = v.f;
+    }
+}
+
+PSMoveCaptureWriter *
+psmove_capture_writer_new(const char *filename, const char *serial,
+        enum PSMove_Model_Type model, const char *calibration, size_t calibration_size,
+        const PSMove_3AxisVector *magnetometer_direction)
+{
+    psmove_return_val_if_fail(filename != NULL, NULL);
+    psmove_return_val_if_fail(serial != NULL, NULL);
+    psmove_return_val_if_fail(calibration != NULL || calibration_size == 0, NULL);
+
+    size_t serial_length = strlen(serial);
+    if (serial_length > PSMOVE_CAPTURE_MAX_SERIAL_SIZE || calibration_size > 0xFFFF) {
+        PSMOVE_WARNING("Serial or calibration too long for capture file");
+        return NULL;
+    }
+
+    FILE *fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        PSMOVE_WARNING("Cannot open capture file for writing: %s", filename);
+        return NULL;
+    }
+
+    unsigned char header[PSMOVE_CAPTURE_MAGIC_SIZE + 4];
+    memcpy(header, PSMOVE_CAPTURE_MAGIC, PSMOVE_CAPTURE_MAGIC_SIZE);
+    psmove_capture_put_u16(header + PSMOVE_CAPTURE_MAGIC_SIZE, PSMOVE_CAPTURE_VERSION);
+    header[PSMOVE_CAPTURE_MAGIC_SIZE + 2] = (unsigned char)model;
+    header[PSMOVE_CAPTURE_MAGIC_SIZE + 3] = (unsigned char)serial_length;
+
+    unsigned char size[2];
+    psmove_capture_put_u16(size, (uint16_t)calibration_size);
+
+    float direction[3] = { 0.f, 0.f, 0.f };
+    if (magnetometer_direction != NULL) {
+        direction[0] = magnetometer_direction->x;
+        direction[1] = magnetometer_direction->y;
+        direction[2] = magnetometer_direction->z;
+    }
+
+    unsigned char direction_data[PSMOVE_CAPTURE_FLOATS_SIZE(3)];
+    psmove_capture_put_floats(direction_data, direction, 3);
+
+    if (fwrite(header, sizeof(header), 1, fp) != 1 ||
+            fwrite(serial, 1, serial_length, fp) != serial_length ||
+            fwrite(size, sizeof(size), 1, fp) != 1 ||
+            fwrite(calibration, 1, calibration_size, fp) != calibration_size ||
+            fwrite(direction_data, sizeof(direction_data), 1, fp) != 1) {
+        PSMOVE_WARNING("Cannot write capture header: %s", filename);
+        fclose(fp);
+        return NULL;
+    }
+
+    PSMoveCaptureWriter *writer = (PSMoveCaptureWriter *)calloc(1, sizeof(PSMoveCaptureWriter));
+    writer->fp = fp;
+    return writer;
+}
+
+bool
+psmove_capture_writer_write(PSMoveCaptureWriter *writer,
+        enum PSMoveCapture_Record_Type type, uint64_t time_us,
+        const unsigned char *data, size_t length)
+{
+    psmove_return_val_if_fail(writer != NULL, false);
+    psmove_return_val_if_fail(data != NULL, false);
+    psmove_return_val_if_fail(length <= PSMOVE_CAPTURE_MAX_RECORD_SIZE, false);
+
+    if (!writer->started) {
+        writer->started = true;
+        writer->last_us = time_us;
+    }
+
+    /* Host time is monotonic, but clamp anyway so the delta always fits */
+    uint64_t delta_us = (time_us > writer->last_us) ? (time_us - writer->last_us) : 0;
+    if (delta_us > UINT32_MAX) {
+        delta_us = UINT32_MAX;
+    }
+    writer->last_us += delta_us;
+
+    unsigned char header[PSMOVE_CAPTURE_RECORD_HEADER_SIZE];
+    header[0] = (unsigned char)type;
+    header[1] = (unsigned char)length;
+    psmove_capture_put_u32(header + 2, (uint32_t)delta_us);
+
+    return (fwrite(header, sizeof(header), 1, writer->fp) == 1 &&
+            fwrite(data, 1, length, writer->fp) == length);
+}
+
+bool
+psmove_capture_writer_write_reference(PSMoveCaptureWriter *writer,
+        uint64_t time_us, const float quaternion[4])
+{
+    psmove_return_val_if_fail(quaternion != NULL, false);
+
+    unsigned char data[PSMOVE_CAPTURE_FLOATS_SIZE(4)];
+    psmove_capture_put_floats(data, quaternion, 4);
+
+    return psmove_capture_writer_write(writer, CaptureRecord_Reference, time_us, data, sizeof(data));
+}
+
+void
+psmove_capture_writer_free(PSMoveCaptureWriter *writer)
+{
+    psmove_return_if_fail(writer != NULL);
+
+    fclose(writer->fp);
+    free(writer);
+}
+
+PSMoveCaptureReader *
+psmove_capture_reader_new(const char *filename)
+{
+    psmove_return_val_if_fail(filename != NULL, NULL);
+
+    FILE *fp = fopen(filename, "rb");
+    if (fp == NULL) {
+        PSMOVE_WARNING("Cannot open capture file: %s", filename);
+        return NULL;
+    }
+
+    PSMoveCaptureReader *reader = (PSMoveCaptureReader *)calloc(1, sizeof(PSMoveCaptureReader));
+    reader->fp = fp;
+
+    unsigned char header[PSMOVE_CAPTURE_MAGIC_SIZE + 4];
+    unsigned char size[2];
+
+    if (fread(header, sizeof(header), 1, fp) != 1 ||
+            memcmp(header, PSMOVE_CAPTURE_MAGIC, PSMOVE_CAPTURE_MAGIC_SIZE) != 0) {
+        PSMOVE_WARNING("Not a capture file: %s", filename);
+        goto error;
+    }
+
+    uint16_t version = psmove_capture_get_u16(header + PSMOVE_CAPTURE_MAGIC_SIZE);
+    if (version < PSMOVE_CAPTURE_MIN_VERSION || version > PSMOVE_CAPTURE_VERSION) {
+        PSMOVE_WARNING("Unsupported capture file version: %s", filename);
+        goto error;
+    }
+
+    reader->model = (enum PSMove_Model_Type)header[PSMOVE_CAPTURE_MAGIC_SIZE + 2];
+    size_t serial_length = header[PSMOVE_CAPTURE_MAGIC_SIZE + 3];
+
+    if (fread(reader->serial, 1, serial_length, fp) != serial_length ||
+            fread(size, sizeof(size), 1, fp) != 1) {
+        PSMOVE_WARNING("Truncated capture header: %s", filename);
+        goto error;
+    }
+
+    reader->calibration_size = psmove_capture_get_u16(size);
+    if (reader->calibration_size > 0) {
+        reader->calibration = (char *)malloc(reader->calibration_size);
+        if (fread(reader->calibration, 1, reader->calibration_size, fp) != reader->calibration_size) {
+            PSMOVE_WARNING("Truncated capture calibration: %s", filename);
+            goto error;
+        }
+    }
+
+    if (version >= 2) {
+        unsigned char direction_data[PSMOVE_CAPTURE_FLOATS_SIZE(3)];
+        if (fread(direction_data, sizeof(direction_data), 1, fp) != 1) {
+            PSMOVE_WARNING("Truncated capture header: %s", filename);
+            goto error;
+        }
+
+        float direction[3];
+        psmove_capture_get_floats(direction_data, direction, 3);
+        reader->magnetometer_direction = psmove_3axisvector_xyz(direction[0], direction[1], direction[2]);
+    }
+    /* else: version 1 has no magnetometer calibration direction (zero = none) */
+
+    return reader;
+
+error:
+    psmove_capture_reader_free(reader);
+    return NULL;
+}
+
+const char *
+psmove_capture_reader_get_serial(PSMoveCaptureReader *reader)
+{
+    psmove_return_val_if_fail(reader != NULL, NULL);
+
+    return reader->serial;
+}
+
+enum PSMove_Model_Type
+psmove_capture_reader_get_model(PSMoveCaptureReader *reader)
+{
+    psmove_return_val_if_fail(reader != NULL, Model_ZCM1);
+
+    return reader->model;
+}
+
+const char *
+psmove_capture_reader_get_calibration(PSMoveCaptureReader *reader, size_t *size)
+{
+    psmove_return_val_if_fail(reader != NULL, NULL);
+
+    if (size != NULL) {
+        *size = reader->calibration_size;
+    }
+
+    return reader->calibration;
+}
+
+PSMove_3AxisVector
+psmove_capture_reader_get_magnetometer_direction(PSMoveCaptureReader *reader)
+{
+    psmove_return_val_if_fail(reader != NULL, *k_psmove_vector_zero);
+
+    return reader->magnetometer_direction;
+}
+
+const PSMoveCapture_Record *
+psmove_capture_reader_peek(PSMoveCaptureReader *reader)
+{
+    psmove_return_val_if_fail(reader != NULL, NULL);
+
+    if (reader->have_record) {
+        return &reader->record;
+    }
+
+    if (reader->finished) {
+        return NULL;
+    }
+
+    unsigned char header[PSMOVE_CAPTURE_RECORD_HEADER_SIZE];
+    if (fread(header, sizeof(header), 1, reader->fp) != 1) {
+        reader->finished = true;
+        return NULL;
+    }
+
+    PSMoveCapture_Record *record = &reader->record;
+    record->type = (enum PSMoveCapture_Record_Type)header[0];
+    record->length = header[1];
+    record->time_us += psmove_capture_get_u32(header + 2);
+
+    if (fread(record->data, 1, record->length, reader->fp) != record->length) {
+        PSMOVE_WARNING("Truncated capture record, stopping replay");
+        reader->finished = true;
+        return NULL;
+    }
+
+    reader->have_record = true;
+    return record;
+}
+
+void
+psmove_capture_reader_advance(PSMoveCaptureReader *reader)
+{
+    psmove_return_if_fail(reader != NULL);
+
+    if (!reader->have_record) {
+        /* Read (and drop) the next record */
+        psmove_capture_reader_peek(reader);
+    }
+
+    reader->have_record = false;
+}
+
+bool
+psmove_capture_record_get_reference(const PSMoveCapture_Record *record,
+        float quaternion[4])
+{
+    psmove_return_val_if_fail(record != NULL, false);
+    psmove_return_val_if_fail(quaternion != NULL, false);
+
+    if (record->type != CaptureRecord_Reference ||
+            record->length != PSMOVE_CAPTURE_FLOATS_SIZE(4)) {
+        return false;
+    }
+
+    psmove_capture_get_floats(record->data, quaternion, 4);
+    return true;
+}
+
+void
+psmove_capture_reader_free(PSMoveCaptureReader *reader)
+{
+    psmove_return_if_fail(reader != NULL);
+
+    fclose(reader->fp);
+    free(reader->calibration);
+    free(reader);
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-- includes -----
+#include "psmove.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+//-- pre-declarations -----
+struct _PSMoveCaptureWriter;
+typedef struct _PSMoveCaptureWriter PSMoveCaptureWriter;
+
+struct _PSMoveCaptureReader;
+typedef struct _PSMoveCaptureReader PSMoveCaptureReader;
+
+//-- constants -----
+
+/**
+ * Capture file format (all integers are little-endian):
+ *
+ *  Header:
+ *   8 bytes   magic (PSMOVE_CAPTURE_MAGIC)
+ *   uint16    format version (PSMOVE_CAPTURE_VERSION)
+ *   uint8     controller model (enum PSMove_Model_Type)
+ *   uint8     serial length, followed by the serial ("aa:bb:cc:dd:ee:ff")
+ *   uint16    calibration blob size (0 = none), followed by the blob
+ *   float32   magnetometer calibration direction (x, y, z; zero = none),
+ *             only since version 2
+ *
+ *  Records, until the end of the file:
+ *   uint8     record type (enum PSMoveCapture_Record_Type)
+ *   uint8     payload length, followed by the payload (raw report)
+ *   uint32    microseconds since the previous record (or the recording start)
+ **/
+#define PSMOVE_CAPTURE_MAGIC "PSMVCAPT"
+#define PSMOVE_CAPTURE_VERSION 2
+
+/* Oldest format version that can still be read */
+#define PSMOVE_CAPTURE_MIN_VERSION 1
+
+/* Maximum payload size of a record */
+#define PSMOVE_CAPTURE_MAX_RECORD_SIZE 255
+
+enum PSMoveCapture_Record_Type {
+    CaptureRecord_Input = 1, /* Input report read from the controller */
+    CaptureRecord_Output = 2, /* LED/rumble report written to the controller */
+    CaptureRecord_Reference = 3, /* Reference orientation (see below) */
+};
+
+typedef struct {
+    enum PSMoveCapture_Record_Type type;
+    uint64_t time_us; /* Microseconds since the start of the recording */
+    size_t length;
+    unsigned char data[PSMOVE_CAPTURE_MAX_RECORD_SIZE];
+} PSMoveCapture_Record;
+
+//-- interface -----
+
+/**
+ * Create a capture file and write its header. The calibration blob can
+ * be NULL (with calibration_size 0) if the controller has no calibration,
+ * the magnetometer calibration direction can be NULL if it's not known.
+ *
+ * Returns NULL if the file could not be written.
+ **/
+ADDAPI PSMoveCaptureWriter *
+ADDCALL psmove_capture_writer_new(const char *filename, const char *serial,
+        enum PSMove_Model_Type model, const char *calibration, size_t calibration_size,
+        const PSMove_3AxisVector *magnetometer_direction);
+
+/**
+ * Append a record of length bytes. time_us is the host time of the report
+ * (psmove_port_get_time_us()); the first record defines the recording start.
+ *
+ * Returns true on success.
+ **/
+ADDAPI bool
+ADDCALL psmove_capture_writer_write(PSMoveCaptureWriter *writer,
+        enum PSMoveCapture_Record_Type type, uint64_t time_us,
+        const unsigned char *data, size_t length);
+
+/**
+ * Append a reference orientation, e.g. from an optical motion capture
+ * system or a synthetic trace. The quaternion (w, x, y, z) is in the
+ * coordinate system of psmove_get_orientation() and applies to the input
+ * report that follows it. Used to measure the accuracy of sensor fusion.
+ **/
+ADDAPI bool
+ADDCALL psmove_capture_writer_write_reference(PSMoveCaptureWriter *writer,
+        uint64_t time_us, const float quaternion[4]);
+
+/**
+ * Flush and close the capture file.
+ **/
+ADDAPI void
+ADDCALL psmove_capture_writer_free(PSMoveCaptureWriter *writer);
+
+/**
+ * Open a capture file and read its header.
+ *
+ * Returns NULL if the file can't be read or is not a valid capture.
+ **/
+ADDAPI PSMoveCaptureReader *
+ADDCALL psmove_capture_reader_new(const char *filename);
+
+/**
+ * Serial number of the recorded controller (owned by the reader).
+ **/
+ADDAPI const char *
+ADDCALL psmove_capture_reader_get_serial(PSMoveCaptureReader *reader);
+
+/**
+ * Model of the recorded controller.
+ **/
+ADDAPI enum PSMove_Model_Type
+ADDCALL psmove_capture_reader_get_model(PSMoveCaptureReader *reader);
+
+/**
+ * Calibration blob of the recorded controller (owned by the reader), or
+ * NULL if the capture doesn't contain one.
+ **/
+ADDAPI const char *
+ADDCALL psmove_capture_reader_get_calibration(PSMoveCaptureReader *reader, size_t *size);
+
+/**
+ * Magnetometer calibration direction of the recorded controller (zero if
+ * the capture doesn't contain one).
+ **/
+ADDAPI PSMove_3AxisVector
+ADDCALL psmove_capture_reader_get_magnetometer_direction(PSMoveCaptureReader *reader);
+
+/**
+ * The next record (owned by the reader, valid until the next call to
+ * psmove_capture_reader_advance()), or NULL at the end of the capture.
+ * Calling this again without advancing returns the same record.
+ **/
+ADDAPI const PSMoveCapture_Record *
+ADDCALL psmove_capture_reader_peek(PSMoveCaptureReader *reader);
+
+/**
+ * Skip the record returned by psmove_capture_reader_peek().
+ **/
+ADDAPI void
+ADDCALL psmove_capture_reader_advance(PSMoveCaptureReader *reader);
+
+/**
+ * Decode the quaternion (w, x, y, z) of a CaptureRecord_Reference record.
+ *
+ * Returns false if the record is not a valid reference orientation.
+ **/
+ADDAPI bool
+ADDCALL psmove_capture_record_get_reference(const PSMoveCapture_Record *record,
+        float quaternion[4]);
+
+/**
+ * Close the capture file and free the reader.
+ **/
+ADDAPI void
+ADDCALL psmove_capture_reader_free(PSMoveCaptureReader *reader);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,179 @@
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#include "psmove_private.h"
+#include "psmove_clock.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+/* The device timestamp is a 16-bit counter */
+#define PSMOVE_CLOCK_WRAP 0x10000
+
+/* Minimum host time span (in microseconds) before estimating the tick rate */
+#define PSMOVE_CLOCK_MIN_SPAN_US (500 * 1000)
+
+/* Maximum increase (in microseconds) of the transport delay per report */
+#define PSMOVE_CLOCK_OFFSET_LEAK_US 2.0
+
+struct _PSMoveClock {
+    /* Number of reports seen so far */
+    uint64_t reports;
+
+    /* Raw and unwrapped device timestamp of the last report */
+    uint16_t last_raw;
+    uint64_t ticks;
+
+    /* Host arrival time of the first and the last report */
+    uint64_t first_arrival_us;
+    uint64_t arrival_us;
+
+    /* Estimated duration of one device tick, 0 if not yet known */
+    double tick_period_us;
+
+    /**
+     * Lowest observed difference between arrival time and device time,
+     * i.e. the device time plus this offset is the sampling time on the
+     * host clock. It is allowed to slowly increase to follow clock drift.
+     **/
+    double offset_us;
+
+    /* Sampling time of the last report on the host clock */
+    uint64_t sample_time_us;
+};
+
+
+PSMoveClock *
+psmove_clock_new()
+{
+    return (PSMoveClock *)calloc(1, sizeof(PSMoveClock));
+}
+
+void
+psmove_clock_update(PSMoveClock *clock, uint16_t device_timestamp,
+        uint64_t arrival_us)
+{
+    psmove_return_if_fail(clock != NULL);
+
+    if (clock->reports == 0) {
+        clock->first_arrival_us = arrival_us;
+    } else {
+        uint64_t delta = (uint16_t)(device_timestamp - clock->last_raw);
+
+        if (clock->tick_period_us > 0. && arrival_us > clock->arrival_us) {
+            /* Use the host clock to count wraps of the counter during long gaps */
+            double expected = (double)(arrival_us - clock->arrival_us) / clock->tick_period_us;
+            double wraps = floor((expected - (double)delta) / PSMOVE_CLOCK_WRAP + 0.5);
+            if (wraps > 0.) {
+                delta += (uint64_t)wraps * PSMOVE_CLOCK_WRAP;
+            }
+        }
+
+        clock->ticks += delta;
+    }
+
+    clock->last_raw = device_timestamp;
+    clock->arrival_us = arrival_us;
+    clock->reports++;
+
+    if (clock->ticks > 0 && arrival_us - clock->first_arrival_us >= PSMOVE_CLOCK_MIN_SPAN_US) {
+        double period = (double)(arrival_us - clock->first_arrival_us) / (double)clock->ticks;
+        double observed;
+
+        if (clock->tick_period_us > 0.) {
+            /* Keep the mapping of the current device time continuous */
+            clock->offset_us += (clock->tick_period_us - period) * (double)clock->ticks;
+            clock->tick_period_us = period;
+
+            observed = (double)arrival_us - (double)clock->ticks * period;
+            clock->offset_us = fmin(clock->offset_us + PSMOVE_CLOCK_OFFSET_LEAK_US, observed);
+        } else {
+            clock->tick_period_us = period;
+            clock->offset_us = (double)arrival_us - (double)clock->ticks * period;
+        }
+
+        clock->sample_time_us = (uint64_t)((double)clock->ticks * period + clock->offset_us);
+    } else {
+        clock->sample_time_us = arrival_us;
+    }
+}
+
+uint64_t
+psmove_clock_get_device_ticks(PSMoveClock *clock)
+{
+    psmove_return_val_if_fail(clock != NULL, 0);
+
+    return clock->ticks;
+}
+
+uint64_t
+psmove_clock_get_sample_time_us(PSMoveClock *clock)
+{
+    psmove_return_val_if_fail(clock != NULL, 0);
+
+    return clock->sample_time_us;
+}
+
+uint64_t
+psmove_clock_get_arrival_time_us(PSMoveClock *clock)
+{
+    psmove_return_val_if_fail(clock != NULL, 0);
+
+    return clock->arrival_us;
+}
+
+uint32_t
+psmove_clock_get_latency_us(PSMoveClock *clock)
+{
+    psmove_return_val_if_fail(clock != NULL, 0);
+
+    if (clock->arrival_us <= clock->sample_time_us) {
+        return 0;
+    }
+
+    return (uint32_t)(clock->arrival_us - clock->sample_time_us);
+}
+
+double
+psmove_clock_get_tick_period_us(PSMoveClock *clock)
+{
+    psmove_return_val_if_fail(clock != NULL, 0.);
+
+    return clock->tick_period_us;
+}
+
+void
+psmove_clock_free(PSMoveClock *clock)
+{
+    psmove_return_if_fail(clock != NULL);
+
+    free(clock);
+}
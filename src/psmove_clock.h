@@ -0,0 +1,106 @@
+#pragma once
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "psmove.h"
+
+
+struct _PSMoveClock;
+typedef struct _PSMoveClock PSMoveClock;
+
+
+/**
+ * Create a new clock that reconstructs the sampling time of input reports
+ * from the controller's 16-bit timestamp and the host arrival time.
+ **/
+ADDAPI PSMoveClock *
+ADDCALL psmove_clock_new();
+
+/**
+ * Feed the timestamp of a newly-received input report into the clock
+ *
+ * clock ... a valid PSMoveClock * instance.
+ * device_timestamp ... the raw 16-bit timestamp from the input report
+ * arrival_us ... the host time when the report arrived (psmove_port_get_time_us())
+ **/
+ADDAPI void
+ADDCALL psmove_clock_update(PSMoveClock *clock, uint16_t device_timestamp,
+        uint64_t arrival_us);
+
+/**
+ * Get the unwrapped (64-bit, monotonic) device timestamp of the last report
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_clock_get_device_ticks(PSMoveClock *clock);
+
+/**
+ * Get the sampling time of the last report, on the host monotonic clock
+ *
+ * The device clock is mapped onto the host clock using the estimated tick
+ * rate and the lowest observed transport delay. Until enough reports have
+ * been received to estimate the tick rate, this is the arrival time.
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_clock_get_sample_time_us(PSMoveClock *clock);
+
+/**
+ * Get the host arrival time of the last report (as passed to the update)
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_clock_get_arrival_time_us(PSMoveClock *clock);
+
+/**
+ * Get the estimated delay between sampling and arrival of the last report
+ **/
+ADDAPI uint32_t
+ADDCALL psmove_clock_get_latency_us(PSMoveClock *clock);
+
+/**
+ * Get the estimated duration of one device tick in microseconds
+ *
+ * Returns 0 if the tick rate has not been estimated yet.
+ **/
+ADDAPI double
+ADDCALL psmove_clock_get_tick_period_us(PSMoveClock *clock);
+
+/**
+ * Destroy a clock object and free the allocated memory
+ **/
+ADDAPI void
+ADDCALL psmove_clock_free(PSMoveClock *clock);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,235 @@
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#include "psmove_private.h"
+#include "psmove_history.h"
+#include "math/psmove_vector.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+struct _PSMoveHistory {
+    /* Ring buffer of size samples, next is where the next sample goes */
+    PSMove_Sample *samples;
+    size_t size;
+    size_t next;
+
+    /* Number of valid samples (up to size) */
+    size_t count;
+};
+
+/* Index of the i-th newest sample (0 is the newest one) */
+static size_t
+psmove_history_index(PSMoveHistory *history, size_t i)
+{
+    return (history->next + history->size - 1 - i) % history->size;
+}
+
+static float
+psmove_history_lerp(float a, float b, float t)
+{
+    return a + (b - a) * t;
+}
+
+/* Spherical interpolation between the (w, x, y, z) quaternions a and b */
+static void
+psmove_history_slerp(const float *a, const float *b, float t, float *out)
+{
+    float d = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+    float sign = 1.f;
+    float wa, wb;
+    float length;
+    int i;
+
+    /* q and -q are the same rotation, take the shorter path */
+    if (d < 0.f) {
+        d = -d;
+        sign = -1.f;
+    }
+
+    if (d > 0.9995f) {
+        /* Nearly the same orientation, linear interpolation is good enough */
+        wa = 1.f - t;
+        wb = t;
+    } else {
+        float theta = acosf(d);
+        float s = sinf(theta);
+        wa = sinf((1.f - t) * theta) / s;
+        wb = sinf(t * theta) / s;
+    }
+
+    length = 0.f;
+    for (i=0; i<4; i++) {
+        out[i] = wa * a[i] + sign * wb * b[i];
+        length += out[i] * out[i];
+    }
+
+    length = sqrtf(length);
+    if (length > 0.f) {
+        for (i=0; i<4; i++) {
+            out[i] /= length;
+        }
+    }
+}
+
+PSMoveHistory *
+psmove_history_new(size_t size)
+{
+    psmove_return_val_if_fail(size > 0, NULL);
+
+    PSMoveHistory *history = (PSMoveHistory *)calloc(1, sizeof(PSMoveHistory));
+    if (history == NULL) {
+        return NULL;
+    }
+
+    history->samples = (PSMove_Sample *)calloc(size, sizeof(PSMove_Sample));
+    if (history->samples == NULL) {
+        free(history);
+        return NULL;
+    }
+
+    history->size = size;
+
+    return history;
+}
+
+void
+psmove_history_push(PSMoveHistory *history, const PSMove_Sample *sample)
+{
+    psmove_return_if_fail(history != NULL);
+    psmove_return_if_fail(sample != NULL);
+
+    history->samples[history->next] = *sample;
+    history->next = (history->next + 1) % history->size;
+
+    if (history->count < history->size) {
+        history->count++;
+    }
+}
+
+size_t
+psmove_history_get_last(PSMoveHistory *history, PSMove_Sample *out, size_t max)
+{
+    size_t count;
+    size_t i;
+
+    psmove_return_val_if_fail(history != NULL, 0);
+    psmove_return_val_if_fail(out != NULL || max == 0, 0);
+
+    count = (max < history->count) ? max : history->count;
+
+    for (i=0; i<count; i++) {
+        out[i] = history->samples[psmove_history_index(history, count - 1 - i)];
+    }
+
+    return count;
+}
+
+bool
+psmove_history_get_at(PSMoveHistory *history, uint64_t time_us, PSMove_Sample *out)
+{
+    const PSMove_Sample *before;
+    const PSMove_Sample *after;
+    size_t i;
+    float t;
+    int frame;
+
+    psmove_return_val_if_fail(history != NULL, false);
+    psmove_return_val_if_fail(out != NULL, false);
+
+    if (history->count == 0) {
+        return false;
+    }
+
+    /* Search backwards from the newest sample, as callers usually ask for
+     * recent times (this also tolerates the sampling time stepping back
+     * slightly while the device clock estimate settles) */
+    after = &history->samples[psmove_history_index(history, 0)];
+    if (time_us > after->time_us) {
+        return false;
+    }
+
+    for (i=0; i<history->count; i++) {
+        before = &history->samples[psmove_history_index(history, i)];
+
+        if (before->time_us == time_us) {
+            *out = *before;
+            return true;
+        }
+
+        if (before->time_us < time_us) {
+            break;
+        }
+
+        after = before;
+    }
+
+    if (i == history->count) {
+        /* Older than the oldest sample */
+        return false;
+    }
+
+    t = (float)(time_us - before->time_us) / (float)(after->time_us - before->time_us);
+
+    *out = (t < 0.5f) ? *before : *after;
+    out->time_us = time_us;
+    out->latency_us = (uint32_t)psmove_history_lerp((float)before->latency_us, (float)after->latency_us, t);
+
+    for (frame=Frame_FirstHalf; frame<=Frame_SecondHalf; frame++) {
+        const PSMove_3AxisVector *a0 = &before->accelerometer[frame];
+        const PSMove_3AxisVector *a1 = &after->accelerometer[frame];
+        const PSMove_3AxisVector *g0 = &before->gyroscope[frame];
+        const PSMove_3AxisVector *g1 = &after->gyroscope[frame];
+
+        out->accelerometer[frame] = psmove_3axisvector_xyz(
+                psmove_history_lerp(a0->x, a1->x, t),
+                psmove_history_lerp(a0->y, a1->y, t),
+                psmove_history_lerp(a0->z, a1->z, t));
+        out->gyroscope[frame] = psmove_3axisvector_xyz(
+                psmove_history_lerp(g0->x, g1->x, t),
+                psmove_history_lerp(g0->y, g1->y, t),
+                psmove_history_lerp(g0->z, g1->z, t));
+    }
+
+    psmove_history_slerp(before->orientation, after->orientation, t, out->orientation);
+
+    return true;
+}
+
+void
+psmove_history_free(PSMoveHistory *history)
+{
+    psmove_return_if_fail(history != NULL);
+
+    free(history->samples);
+    free(history);
+}
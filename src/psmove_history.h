@@ -0,0 +1,87 @@
+#pragma once
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "psmove.h"
+
+
+struct _PSMoveHistory;
+typedef struct _PSMoveHistory PSMoveHistory;
+
+
+/**
+ * Create a new ring buffer that keeps the last size decoded samples
+ **/
+ADDAPI PSMoveHistory *
+ADDCALL psmove_history_new(size_t size);
+
+/**
+ * Append a sample, overwriting the oldest one if the buffer is full
+ *
+ * history ... a valid PSMoveHistory * instance.
+ * sample ... the sample to copy into the buffer
+ **/
+ADDAPI void
+ADDCALL psmove_history_push(PSMoveHistory *history, const PSMove_Sample *sample);
+
+/**
+ * Copy the most recent (up to max) samples to out, oldest first
+ *
+ * Returns the number of samples written to out.
+ **/
+ADDAPI size_t
+ADDCALL psmove_history_get_last(PSMoveHistory *history, PSMove_Sample *out, size_t max);
+
+/**
+ * Interpolate the state at time_us (on the sampling time clock) into out
+ *
+ * The sensor readings are interpolated linearly, the orientation spherically,
+ * buttons, trigger and the other discrete fields are taken from the sample
+ * nearest to time_us.
+ *
+ * Returns false if time_us is not between the oldest and the newest sample.
+ **/
+ADDAPI bool
+ADDCALL psmove_history_get_at(PSMoveHistory *history, uint64_t time_us, PSMove_Sample *out);
+
+/**
+ * Destroy a history object and free the allocated memory
+ **/
+ADDAPI void
+ADDCALL psmove_history_free(PSMoveHistory *history);
+
+#ifdef __cplusplus
+}
+#endif
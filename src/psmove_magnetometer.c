@@ -0,0 +1,637 @@
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#include "psmove_private.h"
+#include "psmove_magnetometer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Samples are kept per cell of a cube map around the center, cells per face edge */
+#define PSMOVE_MAGNETOMETER_FIT_CELLS 8
+#define PSMOVE_MAGNETOMETER_FIT_FACE_BINS (PSMOVE_MAGNETOMETER_FIT_CELLS * PSMOVE_MAGNETOMETER_FIT_CELLS)
+#define PSMOVE_MAGNETOMETER_FIT_BINS (6 * PSMOVE_MAGNETOMETER_FIT_FACE_BINS)
+
+/* Coverage needed for the ellipsoid fit: occupied bins in total and on each face */
+#define PSMOVE_MAGNETOMETER_FIT_MIN_BINS 32
+#define PSMOVE_MAGNETOMETER_FIT_MIN_FACE_BINS 2
+
+/* Occupied bins needed before readings off the fitted ellipsoid are rejected */
+#define PSMOVE_MAGNETOMETER_FIT_REJECT_MIN_BINS 96
+
+/* Readings closer than this to the center (raw units) have no useful direction */
+#define PSMOVE_MAGNETOMETER_FIT_MIN_DISTANCE 16.f
+
+/* Refit after this many samples, even if no new direction has been covered */
+#define PSMOVE_MAGNETOMETER_FIT_INTERVAL 32
+
+/* Refit interval once there is an ellipsoid fit (new directions don't trigger a refit then) */
+#define PSMOVE_MAGNETOMETER_FIT_ELLIPSOID_INTERVAL 256
+
+/* Readings off the fitted ellipsoid by more than this (relative to the radius) are outliers */
+#define PSMOVE_MAGNETOMETER_FIT_MAX_RESIDUAL .2f
+
+/* Samples with a residual this many times the median (but at least MIN_OUTLIER) are dropped on refit */
+#define PSMOVE_MAGNETOMETER_FIT_OUTLIER_FACTOR 4.f
+#define PSMOVE_MAGNETOMETER_FIT_MIN_OUTLIER .03f
+
+/* Excess of outliers over inliers after which the field is assumed to have changed and the fit starts over */
+#define PSMOVE_MAGNETOMETER_FIT_MAX_REJECTED 500
+
+/* Largest ratio of the ellipsoid axes accepted from a fit */
+#define PSMOVE_MAGNETOMETER_FIT_MAX_AXIS_RATIO 3.f
+
+typedef struct {
+    float m[3];
+    bool used;
+} PSMoveMagnetometerBin;
+
+struct _PSMoveMagnetometerFit {
+    PSMoveMagnetometerBin bins[PSMOVE_MAGNETOMETER_FIT_BINS];
+
+    /* Center of the cube map (the current hard iron offset) */
+    float center[3];
+    bool has_center;
+
+    int samples_since_update;
+
+    /* Incremented for each outlier, decremented for each accepted sample */
+    int rejected;
+
+    PSMove_MagnetometerEllipsoid calibration;
+    bool ellipsoid;
+
+    /* Occupied bins at the last fit */
+    int used_bins;
+
+    /* The two previous readings, for the median filter */
+    int16_t previous[2][3];
+    int previous_count;
+};
+
+static float
+psmove_magnetometer_median3(int16_t a, int16_t b, int16_t c)
+{
+    if (a > b) {
+        int16_t tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    /* a <= b */
+    if (c <= a) {
+        return a;
+    } else if (c >= b) {
+        return b;
+    } else {
+        return c;
+    }
+}
+
+static int
+psmove_magnetometer_fit_bin(const float center[3], const float m[3])
+{
+    float d[3] = { m[0] - center[0], m[1] - center[1], m[2] - center[2] };
+
+    int axis = 0;
+    for (int i=1; i<3; i++) {
+        if (fabsf(d[i]) > fabsf(d[axis])) {
+            axis = i;
+        }
+    }
+
+    float length = fabsf(d[axis]);
+    if (length < PSMOVE_MAGNETOMETER_FIT_MIN_DISTANCE) {
+        return -1;
+    }
+
+    int face = 2 * axis + ((d[axis] < 0.f) ? 1 : 0);
+    int cell[2];
+    for (int i=0; i<2; i++) {
+        /* Position on the face in -1..+1 */
+        float s = d[(axis + 1 + i) % 3] / length;
+        cell[i] = (int)((s + 1.f) * .5f * PSMOVE_MAGNETOMETER_FIT_CELLS);
+        if (cell[i] < 0) {
+            cell[i] = 0;
+        } else if (cell[i] >= PSMOVE_MAGNETOMETER_FIT_CELLS) {
+            cell[i] = PSMOVE_MAGNETOMETER_FIT_CELLS - 1;
+        }
+    }
+
+    return face * PSMOVE_MAGNETOMETER_FIT_FACE_BINS + cell[0] * PSMOVE_MAGNETOMETER_FIT_CELLS + cell[1];
+}
+
+/* Distance of m from the ellipsoid, relative to its radius */
+static float
+psmove_magnetometer_residual(const PSMove_MagnetometerEllipsoid *ellipsoid, const float m[3])
+{
+    const float *w = ellipsoid->soft_iron;
+    float d[3] = {
+        m[0] - ellipsoid->hard_iron[0],
+        m[1] - ellipsoid->hard_iron[1],
+        m[2] - ellipsoid->hard_iron[2],
+    };
+
+    float x = w[0] * d[0] + w[1] * d[1] + w[2] * d[2];
+    float y = w[3] * d[0] + w[4] * d[1] + w[5] * d[2];
+    float z = w[6] * d[0] + w[7] * d[1] + w[8] * d[2];
+
+    return sqrtf(x * x + y * y + z * z) - 1.f;
+}
+
+/* Solve the n x n system a * x = b in place (b becomes x), returns false if singular */
+static bool
+psmove_magnetometer_solve(double *a, double *b, int n)
+{
+    double largest = 0.;
+    for (int i=0; i<n; i++) {
+        largest = fmax(largest, fabs(a[i * n + i]));
+    }
+
+    for (int col=0; col<n; col++) {
+        int pivot = col;
+        for (int row=col+1; row<n; row++) {
+            if (fabs(a[row * n + col]) > fabs(a[pivot * n + col])) {
+                pivot = row;
+            }
+        }
+
+        if (fabs(a[pivot * n + col]) <= 1e-12 * largest) {
+            return false;
+        }
+
+        if (pivot != col) {
+            for (int i=0; i<n; i++) {
+                double tmp = a[col * n + i];
+                a[col * n + i] = a[pivot * n + i];
+                a[pivot * n + i] = tmp;
+            }
+            double tmp = b[col];
+            b[col] = b[pivot];
+            b[pivot] = tmp;
+        }
+
+        for (int row=col+1; row<n; row++) {
+            double factor = a[row * n + col] / a[col * n + col];
+            for (int i=col; i<n; i++) {
+                a[row * n + i] -= factor * a[col * n + i];
+            }
+            b[row] -= factor * b[col];
+        }
+    }
+
+    for (int row=n-1; row>=0; row--) {
+        for (int i=row+1; i<n; i++) {
+            b[row] -= a[row * n + i] * b[i];
+        }
+        b[row] /= a[row * n + row];
+    }
+
+    return true;
+}
+
+/* Eigenvalues and eigenvectors (columns of v) of the symmetric 3x3 matrix a (destroyed) */
+static void
+psmove_magnetometer_eigen(double a[3][3], double eigenvalues[3], double v[3][3])
+{
+    for (int i=0; i<3; i++) {
+        for (int j=0; j<3; j++) {
+            v[i][j] = (i == j) ? 1. : 0.;
+        }
+    }
+
+    /* Cyclic Jacobi rotations */
+    for (int sweep=0; sweep<32; sweep++) {
+        double off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        if (off < 1e-24) {
+            break;
+        }
+
+        for (int p=0; p<2; p++) {
+            for (int q=p+1; q<3; q++) {
+                if (a[p][q] == 0.) {
+                    continue;
+                }
+
+                double theta = (a[q][q] - a[p][p]) / (2. * a[p][q]);
+                double t = ((theta >= 0.) ? 1. : -1.) / (fabs(theta) + sqrt(theta * theta + 1.));
+                double c = 1. / sqrt(t * t + 1.);
+                double s = t * c;
+
+                for (int k=0; k<3; k++) {
+                    double akp = a[k][p];
+                    double akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+
+                for (int k=0; k<3; k++) {
+                    double apk = a[p][k];
+                    double aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+
+                for (int k=0; k<3; k++) {
+                    double vkp = v[k][p];
+                    double vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    for (int i=0; i<3; i++) {
+        eigenvalues[i] = a[i][i];
+    }
+}
+
+/**
+ * Least-squares fit of the general ellipsoid
+ *
+ *     a x^2 + b y^2 + c z^2 + 2 d xy + 2 e xz + 2 f yz + 2 g x + 2 h y + 2 i z = 1
+ *
+ * to the points, which are centered and scaled first for numerical stability.
+ **/
+static bool
+psmove_magnetometer_fit_ellipsoid(const float (*points)[3], int count, PSMove_MagnetometerEllipsoid *out)
+{
+    double mean[3] = { 0., 0., 0. };
+    for (int i=0; i<count; i++) {
+        for (int j=0; j<3; j++) {
+            mean[j] += points[i][j];
+        }
+    }
+    for (int j=0; j<3; j++) {
+        mean[j] /= count;
+    }
+
+    double scale = 0.;
+    for (int i=0; i<count; i++) {
+        for (int j=0; j<3; j++) {
+            scale += (points[i][j] - mean[j]) * (points[i][j] - mean[j]);
+        }
+    }
+    scale = sqrt(scale / count);
+    if (scale <= 0.) {
+        return false;
+    }
+
+    /* Normal equations of the design matrix rows d = (x^2, y^2, z^2, 2xy, 2xz, 2yz, 2x, 2y, 2z) */
+    double normal[9 * 9];
+    double p[9];
+    memset(normal, 0, sizeof(normal));
+    memset(p, 0, sizeof(p));
+
+    for (int i=0; i<count; i++) {
+        double x = (points[i][0] - mean[0]) / scale;
+        double y = (points[i][1] - mean[1]) / scale;
+        double z = (points[i][2] - mean[2]) / scale;
+        double d[9] = { x * x, y * y, z * z, 2. * x * y, 2. * x * z, 2. * y * z, 2. * x, 2. * y, 2. * z };
+
+        for (int row=0; row<9; row++) {
+            for (int col=row; col<9; col++) {
+                normal[row * 9 + col] += d[row] * d[col];
+            }
+            p[row] += d[row];
+        }
+    }
+
+    for (int row=1; row<9; row++) {
+        for (int col=0; col<row; col++) {
+            normal[row * 9 + col] = normal[col * 9 + row];
+        }
+    }
+
+    if (!psmove_magnetometer_solve(normal, p, 9)) {
+        return false;
+    }
+
+    double a[3][3] = {
+        { p[0], p[3], p[4] },
+        { p[3], p[1], p[5] },
+        { p[4], p[5], p[2] },
+    };
+
+    /* Center: a * center = -(g, h, i) */
+    double a_copy[9] = {
+        a[0][0], a[0][1], a[0][2],
+        a[1][0], a[1][1], a[1][2],
+        a[2][0], a[2][1], a[2][2],
+    };
+    double center[3] = { -p[6], -p[7], -p[8] };
+    if (!psmove_magnetometer_solve(a_copy, center, 3)) {
+        return false;
+    }
+
+    /* (u - center)^T a (u - center) = 1 + center^T a center */
+    double k = 1.;
+    for (int i=0; i<3; i++) {
+        for (int j=0; j<3; j++) {
+            k += center[i] * a[i][j] * center[j];
+        }
+    }
+    if (k <= 0.) {
+        return false;
+    }
+
+    for (int i=0; i<3; i++) {
+        for (int j=0; j<3; j++) {
+            a[i][j] /= k;
+        }
+    }
+
+    double eigenvalues[3];
+    double v[3][3];
+    psmove_magnetometer_eigen(a, eigenvalues, v);
+
+    double smallest = fmin(eigenvalues[0], fmin(eigenvalues[1], eigenvalues[2]));
+    double largest = fmax(eigenvalues[0], fmax(eigenvalues[1], eigenvalues[2]));
+    if (smallest <= 0. || largest > smallest * PSMOVE_MAGNETOMETER_FIT_MAX_AXIS_RATIO * PSMOVE_MAGNETOMETER_FIT_MAX_AXIS_RATIO) {
+        /* Not an ellipsoid, or implausibly flat (not enough directions covered) */
+        return false;
+    }
+
+    /* soft_iron = v * sqrt(eigenvalues) * v^T, back in raw units */
+    for (int i=0; i<3; i++) {
+        for (int j=0; j<3; j++) {
+            double sum = 0.;
+            for (int l=0; l<3; l++) {
+                sum += v[i][l] * sqrt(eigenvalues[l]) * v[j][l];
+            }
+            out->soft_iron[i * 3 + j] = (float)(sum / scale);
+        }
+
+        out->hard_iron[i] = (float)(mean[i] + scale * center[i]);
+    }
+
+    out->range = (float)(2. * scale / sqrt(largest));
+
+    return true;
+}
+
+/* Put the used samples into the bins of the cube map around center */
+static void
+psmove_magnetometer_fit_rebin(PSMoveMagnetometerFit *fit, const float center[3])
+{
+    PSMoveMagnetometerBin old_bins[PSMOVE_MAGNETOMETER_FIT_BINS];
+    memcpy(old_bins, fit->bins, sizeof(old_bins));
+    memset(fit->bins, 0, sizeof(fit->bins));
+
+    memcpy(fit->center, center, sizeof(fit->center));
+
+    for (int i=0; i<PSMOVE_MAGNETOMETER_FIT_BINS; i++) {
+        if (old_bins[i].used) {
+            int bin = psmove_magnetometer_fit_bin(fit->center, old_bins[i].m);
+            if (bin >= 0 && !fit->bins[bin].used) {
+                fit->bins[bin] = old_bins[i];
+            }
+        }
+    }
+}
+
+static int
+psmove_magnetometer_compare_float(const void *a, const void *b)
+{
+    float fa = *(const float *)a;
+    float fb = *(const float *)b;
+
+    return (fa > fb) - (fa < fb);
+}
+
+PSMoveMagnetometerFit *
+psmove_magnetometer_fit_new()
+{
+    PSMoveMagnetometerFit *fit = calloc(1, sizeof(PSMoveMagnetometerFit));
+    return fit;
+}
+
+void
+psmove_magnetometer_fit_reset(PSMoveMagnetometerFit *fit)
+{
+    psmove_return_if_fail(fit != NULL);
+
+    memset(fit, 0, sizeof(*fit));
+}
+
+bool
+psmove_magnetometer_fit_add(PSMoveMagnetometerFit *fit, const int16_t magnetometer[3])
+{
+    psmove_return_val_if_fail(fit != NULL, false);
+    psmove_return_val_if_fail(magnetometer != NULL, false);
+
+    /* Median of the last three readings, drops single-sample spikes */
+    if (fit->previous_count < 2) {
+        memcpy(fit->previous[fit->previous_count++], magnetometer, sizeof(fit->previous[0]));
+        return false;
+    }
+
+    float m[3];
+    for (int i=0; i<3; i++) {
+        m[i] = psmove_magnetometer_median3(fit->previous[0][i], fit->previous[1][i], magnetometer[i]);
+    }
+
+    memcpy(fit->previous[0], fit->previous[1], sizeof(fit->previous[0]));
+    memcpy(fit->previous[1], magnetometer, sizeof(fit->previous[1]));
+
+    if (fit->ellipsoid && fit->used_bins >= PSMOVE_MAGNETOMETER_FIT_REJECT_MIN_BINS &&
+            fabsf(psmove_magnetometer_residual(&fit->calibration, m)) > PSMOVE_MAGNETOMETER_FIT_MAX_RESIDUAL) {
+        if (++fit->rejected < PSMOVE_MAGNETOMETER_FIT_MAX_REJECTED) {
+            return false;
+        }
+
+        PSMOVE_WARNING("Magnetic field changed, restarting magnetometer calibration");
+        psmove_magnetometer_fit_reset(fit);
+    }
+
+    if (fit->rejected > 0) {
+        fit->rejected--;
+    }
+
+    if (!fit->has_center) {
+        /* First reading, the bins are arranged around it until the first fit */
+        memcpy(fit->center, m, sizeof(fit->center));
+        fit->has_center = true;
+        return false;
+    }
+
+    int bin = psmove_magnetometer_fit_bin(fit->center, m);
+    if (bin < 0) {
+        return false;
+    }
+
+    bool new_direction = !fit->bins[bin].used;
+    memcpy(fit->bins[bin].m, m, sizeof(fit->bins[bin].m));
+    fit->bins[bin].used = true;
+
+    int interval = fit->ellipsoid ? PSMOVE_MAGNETOMETER_FIT_ELLIPSOID_INTERVAL : PSMOVE_MAGNETOMETER_FIT_INTERVAL;
+    if ((new_direction && !fit->ellipsoid) || ++fit->samples_since_update >= interval) {
+        psmove_magnetometer_fit_update(fit);
+        return true;
+    }
+
+    return false;
+}
+
+void
+psmove_magnetometer_fit_update(PSMoveMagnetometerFit *fit)
+{
+    psmove_return_if_fail(fit != NULL);
+
+    float points[PSMOVE_MAGNETOMETER_FIT_BINS][3];
+    int bins[PSMOVE_MAGNETOMETER_FIT_BINS];
+    int face_count[6] = { 0, 0, 0, 0, 0, 0 };
+    float min[3] = { 0.f, 0.f, 0.f };
+    float max[3] = { 0.f, 0.f, 0.f };
+    int count = 0;
+
+    fit->samples_since_update = 0;
+
+    for (int i=0; i<PSMOVE_MAGNETOMETER_FIT_BINS; i++) {
+        if (!fit->bins[i].used) {
+            continue;
+        }
+
+        for (int j=0; j<3; j++) {
+            points[count][j] = fit->bins[i].m[j];
+            if (count == 0 || points[count][j] < min[j]) {
+                min[j] = points[count][j];
+            }
+            if (count == 0 || points[count][j] > max[j]) {
+                max[j] = points[count][j];
+            }
+        }
+
+        bins[count++] = i;
+        face_count[i / PSMOVE_MAGNETOMETER_FIT_FACE_BINS]++;
+    }
+
+    fit->used_bins = count;
+
+    if (count == 0) {
+        return;
+    }
+
+    bool covered = (count >= PSMOVE_MAGNETOMETER_FIT_MIN_BINS);
+    for (int i=0; i<6; i++) {
+        covered = covered && (face_count[i] >= PSMOVE_MAGNETOMETER_FIT_MIN_FACE_BINS);
+    }
+
+    PSMove_MagnetometerEllipsoid ellipsoid;
+    fit->ellipsoid = covered && psmove_magnetometer_fit_ellipsoid(points, count, &ellipsoid);
+
+    if (fit->ellipsoid) {
+        /* Drop the samples that are far off compared to the others, then fit again */
+        float residuals[PSMOVE_MAGNETOMETER_FIT_BINS];
+        float sorted[PSMOVE_MAGNETOMETER_FIT_BINS];
+        for (int i=0; i<count; i++) {
+            residuals[i] = sorted[i] = fabsf(psmove_magnetometer_residual(&ellipsoid, points[i]));
+        }
+        qsort(sorted, count, sizeof(float), psmove_magnetometer_compare_float);
+
+        float threshold = PSMOVE_MAGNETOMETER_FIT_OUTLIER_FACTOR * sorted[count / 2];
+        if (threshold < PSMOVE_MAGNETOMETER_FIT_MIN_OUTLIER) {
+            threshold = PSMOVE_MAGNETOMETER_FIT_MIN_OUTLIER;
+        }
+
+        int inliers = 0;
+        for (int i=0; i<count; i++) {
+            if (residuals[i] > threshold) {
+                fit->bins[bins[i]].used = false;
+            } else {
+                memcpy(points[inliers++], points[i], sizeof(points[i]));
+            }
+        }
+
+        if (inliers < count) {
+            PSMove_MagnetometerEllipsoid refined;
+            if (psmove_magnetometer_fit_ellipsoid(points, inliers, &refined)) {
+                ellipsoid = refined;
+            }
+        }
+
+        fit->calibration = ellipsoid;
+    } else {
+        psmove_magnetometer_ellipsoid_from_box(&fit->calibration, min, max);
+    }
+
+    /**
+     * Arrange the bins around the new center, but only once the samples span
+     * more than a small patch (before that, the box center is not better than
+     * the first reading and all samples would end up too close to it).
+     **/
+    if (fit->ellipsoid || fit->calibration.range > 2.f * PSMOVE_MAGNETOMETER_FIT_MIN_DISTANCE) {
+        psmove_magnetometer_fit_rebin(fit, fit->calibration.hard_iron);
+    }
+}
+
+bool
+psmove_magnetometer_fit_get(PSMoveMagnetometerFit *fit, PSMove_MagnetometerEllipsoid *out)
+{
+    psmove_return_val_if_fail(fit != NULL, false);
+    psmove_return_val_if_fail(out != NULL, false);
+
+    *out = fit->calibration;
+    return fit->ellipsoid;
+}
+
+void
+psmove_magnetometer_fit_free(PSMoveMagnetometerFit *fit)
+{
+    psmove_return_if_fail(fit != NULL);
+
+    free(fit);
+}
+
+void
+psmove_magnetometer_ellipsoid_from_box(PSMove_MagnetometerEllipsoid *ellipsoid,
+        const float min[3], const float max[3])
+{
+    psmove_return_if_fail(ellipsoid != NULL);
+
+    memset(ellipsoid, 0, sizeof(*ellipsoid));
+
+    for (int i=0; i<3; i++) {
+        float extent = max[i] - min[i];
+        if (extent < 0.f) {
+            extent = 0.f;
+        }
+
+        ellipsoid->hard_iron[i] = .5f * (min[i] + max[i]);
+        ellipsoid->soft_iron[i * 3 + i] = (extent > 0.f) ? (2.f / extent) : 0.f;
+
+        if (i == 0 || extent < ellipsoid->range) {
+            ellipsoid->range = extent;
+        }
+    }
+}
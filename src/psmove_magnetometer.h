@@ -0,0 +1,119 @@
+#pragma once
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "psmove.h"
+
+
+/**
+ * Hard- and soft-iron magnetometer calibration:
+ *
+ *     calibrated = soft_iron * (raw - hard_iron)
+ *
+ * maps the raw readings on the fitted ellipsoid to the unit sphere.
+ **/
+typedef struct {
+    float hard_iron[3]; /* center of the ellipsoid (raw units) */
+    float soft_iron[9]; /* symmetric 3x3 matrix, row-major */
+    float range; /* smallest diameter of the ellipsoid (raw units) */
+} PSMove_MagnetometerEllipsoid;
+
+struct _PSMoveMagnetometerFit;
+typedef struct _PSMoveMagnetometerFit PSMoveMagnetometerFit;
+
+
+/**
+ * Create a new, empty magnetometer ellipsoid fit
+ **/
+ADDAPI PSMoveMagnetometerFit *
+ADDCALL psmove_magnetometer_fit_new();
+
+/**
+ * Forget all samples and start over
+ **/
+ADDAPI void
+ADDCALL psmove_magnetometer_fit_reset(PSMoveMagnetometerFit *fit);
+
+/**
+ * Add a raw magnetometer reading
+ *
+ * Only a bounded set of samples is kept (the most recent sample per
+ * direction from the center). Once enough directions are covered,
+ * readings that are far off the fitted ellipsoid are rejected as outliers.
+ * The fit is updated every few samples and whenever a new direction has
+ * been covered.
+ *
+ * fit ... a valid PSMoveMagnetometerFit * instance.
+ * magnetometer ... the raw magnetometer reading
+ *
+ * Returns true if the fit has been updated.
+ **/
+ADDAPI bool
+ADDCALL psmove_magnetometer_fit_add(PSMoveMagnetometerFit *fit, const int16_t magnetometer[3]);
+
+/**
+ * Fit the ellipsoid to the current samples right away
+ **/
+ADDAPI void
+ADDCALL psmove_magnetometer_fit_update(PSMoveMagnetometerFit *fit);
+
+/**
+ * Get the current calibration
+ *
+ * Until enough directions are covered for the ellipsoid fit, this is a
+ * scaling of the bounding box of the samples to [-1..+1].
+ *
+ * Returns true if the result is an ellipsoid fit.
+ **/
+ADDAPI bool
+ADDCALL psmove_magnetometer_fit_get(PSMoveMagnetometerFit *fit, PSMove_MagnetometerEllipsoid *out);
+
+/**
+ * Destroy a fit object and free the allocated memory
+ **/
+ADDAPI void
+ADDCALL psmove_magnetometer_fit_free(PSMoveMagnetometerFit *fit);
+
+/**
+ * Calibration that scales the box [min..max] to [-1..+1] on each axis
+ * (the calibration of earlier versions)
+ **/
+ADDAPI void
+ADDCALL psmove_magnetometer_ellipsoid_from_box(PSMove_MagnetometerEllipsoid *ellipsoid,
+        const float min[3], const float max[3]);
+
+#ifdef __cplusplus
+}
+#endif
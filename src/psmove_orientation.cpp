@@ -40,9 +40,13 @@
 #include "math/psmove_quaternion.hpp"
 #include "math/psmove_alignment.hpp"
 #include "math/psmove_vector.h"
+#include "math/psmove_simd.hpp"
+#include "math/psmove_fixed.h"
 
 //-- constants -----
 #define SAMPLE_FREQUENCY 120.f
+#define k_max_report_delta_t 0.25f // longest gap between two reports to integrate over in seconds
+#define k_sample_interval_weight 0.05f // smoothing of the measured sample interval
 
 // Madgwick MARG Filter Constants
 #define gyroMeasDrift 3.14159265358979f * (0.9f / 180.0f) // gyroscope measurement error in rad/s/s (shown as 0.2f deg/s/s)
@@ -53,6 +57,20 @@
 // Complementary ARG Filter constants
 #define k_base_earth_frame_align_weight 0.02f
 
+// Error-state Kalman filter constants
+#define k_eskf_gyroscope_noise 0.02f // gyroscope noise density in rad/s/sqrt(Hz)
+#define k_eskf_gyroscope_bias_drift 0.0005f // gyroscope bias random walk in rad/s/sqrt(s)
+#define k_eskf_accelerometer_noise 0.2f // normalized accelerometer noise
+#define k_eskf_accelerometer_motion_noise 2.f // extra noise per g of linear acceleration
+#define k_eskf_magnetometer_noise 0.2f // normalized magnetometer noise
+#define k_eskf_initial_orientation_variance 0.1f // rad^2, converges quickly after a reset
+#define k_eskf_initial_gyroscope_bias_variance 0.0025f // (rad/s)^2
+#define k_eskf_outlier_threshold 16.27f // chi^2 (3 DOF, p=0.001) of a measurement that is ignored
+
+// Number of Madgwick IMU states fused together by psmove_orientation_update_batch()
+// (must be a multiple of PSMOVE_SIMD_WIDTH)
+#define ORIENTATION_BATCH_SIZE 16
+
 const PSMove_3AxisTransform g_psmove_zero_transform = {{{ {0,0,0}, {0,0,0}, {0,0,0} }}};
 const PSMove_3AxisTransform *k_psmove_zero_transform = &g_psmove_zero_transform;
 
@@ -84,15 +102,59 @@ struct _PSMovComplementaryMARGState
 };
 typedef struct _PSMovComplementaryMARGState PSMoveComplementaryMARGState;
 
+struct _PSMoveESKFState
+{
+    // Estimated gyroscope bias in rad/s (sensor data basis)
+    glm::vec3 gyroscope_bias;
+
+    // Covariance of the error state (orientation error in radians, gyroscope bias),
+    // stored as 3x3 blocks: |P_tt    P_tb|
+    //                       |P_tb^T  P_bb|
+    glm::mat3 P_tt;
+    glm::mat3 P_tb;
+    glm::mat3 P_bb;
+};
+typedef struct _PSMoveESKFState PSMoveESKFState;
+
+/* Madgwick IMU states gathered by psmove_orientation_update_batch(),
+   stored as structure-of-arrays with one lane per controller */
+struct _PSMoveOrientationBatch
+{
+    int count;
+    PSMoveOrientation *states[ORIENTATION_BATCH_SIZE];
+    glm::quat quaternion_backup[ORIENTATION_BATCH_SIZE];
+
+    float delta_t[2][ORIENTATION_BATCH_SIZE];
+
+    // Current orientation
+    float qw[ORIENTATION_BATCH_SIZE];
+    float qx[ORIENTATION_BATCH_SIZE];
+    float qy[ORIENTATION_BATCH_SIZE];
+    float qz[ORIENTATION_BATCH_SIZE];
+
+    // Gravity direction in the identity pose
+    float dx[ORIENTATION_BATCH_SIZE];
+    float dy[ORIENTATION_BATCH_SIZE];
+    float dz[ORIENTATION_BATCH_SIZE];
+
+    // Normalized accelerometer and gyroscope readings for each frame
+    float ax[2][ORIENTATION_BATCH_SIZE];
+    float ay[2][ORIENTATION_BATCH_SIZE];
+    float az[2][ORIENTATION_BATCH_SIZE];
+    float wx[2][ORIENTATION_BATCH_SIZE];
+    float wy[2][ORIENTATION_BATCH_SIZE];
+    float wz[2][ORIENTATION_BATCH_SIZE];
+};
+typedef struct _PSMoveOrientationBatch PSMoveOrientationBatch;
+
 struct _PSMoveOrientation {
     PSMove *move;
 
-    /* Current sampling frequency */
-    float sample_freq;
+    /* Sampling time of the previous report (psmove_get_sample_time_us), 0 before the first one */
+    uint64_t last_sample_time_us;
 
-    /* Sample frequency measurements */
-    long sample_freq_measure_start;
-    long sample_freq_measure_count;
+    /* Time between the two samples of a report, measured on reports without a gap */
+    float sample_interval;
 
     /* Output value as quaternion */
     glm::quat quaternion;
@@ -108,21 +170,44 @@ struct _PSMoveOrientation {
     /* Transforms the sensor data from PSMove Space to some user defined coordinate space */
     PSMove_3AxisTransform sensor_transform;
 
+    /* psmove_orientation_get_gravity_calibration_direction() in 2.30 fixed-point */
+    psmove_q30 gravity_direction_fixed[3];
+
+    /* Quaternion (w, x, y, z) of the fixed-point filter in 2.30 fixed-point */
+    psmove_q30 quaternion_fixed[4];
+
+    /* Only converted between quaternion and quaternion_fixed when needed */
+    bool quaternion_stale; // quaternion_fixed is newer
+    bool quaternion_fixed_stale; // quaternion is newer
+
+    /* beta in 2.30 fixed-point */
+    psmove_q30 beta_fixed;
+
     /* Per filter type data */
     enum PSMoveOrientation_Fusion_Type fusion_type;
     struct
     {
         PSMoveMadgwickMARGState madgwick_marg_state;
         PSMoveComplementaryMARGState complementary_marg_state;
+        PSMoveESKFState eskf_state;
     } fusion_state;
 };
 
 //-- prototypes -----
+static void _psmove_orientation_measure_delta_t(PSMoveOrientation *orientation_state, float *out_delta_t);
+static void _psmove_orientation_update_fixed_point_state(PSMoveOrientation *orientation_state);
+static void _psmove_orientation_sync_quaternion(PSMoveOrientation *orientation_state);
+static void _psmove_orientation_batch_flush(PSMoveOrientationBatch *batch);
+static void _psmove_orientation_fusion_imu_update_batch(PSMoveOrientationBatch *batch, int frame);
 static void _psmove_orientation_fusion_imu_update(
     PSMoveOrientation *orientation_state,
     float deltat,
     const glm::vec3 &sensor_gyroscope,
     const glm::vec3 &sensor_accelerometer);
+static void _psmove_orientation_fusion_imu_update_fixed(
+    PSMoveOrientation *orientation_state,
+    float delta_t,
+    enum PSMove_Frame frame);
 static void _psmove_orientation_fusion_madgwick_marg_update(
     PSMoveOrientation *orientation_state,
     float deltat,
@@ -135,6 +220,12 @@ static void _psmove_orientation_fusion_complementary_marg_update(
     const glm::vec3 &sensor_gyroscope,
     const glm::vec3 &sensor_acceleration,
     const glm::vec3 &sensor_magnetometer);
+static void _psmove_orientation_fusion_eskf_update(
+    PSMoveOrientation *orientation_state,
+    float delta_t,
+    const glm::vec3 &sensor_gyroscope,
+    const glm::vec3 &sensor_acceleration,
+    const glm::vec3 &sensor_magnetometer);
 
 //-- public methods -----
 PSMoveOrientation *
@@ -151,17 +242,17 @@ psmove_orientation_new(PSMove *move)
 
     orientation_state->move = move;
 
-    /* Initial sampling frequency */
-    orientation_state->sample_freq = SAMPLE_FREQUENCY;
-
-    /* Measurement */
-    orientation_state->sample_freq_measure_start = psmove_util_get_ticks();
-    orientation_state->sample_freq_measure_count = 0;
+    /* Initial sample interval (measurement starts with the first update) */
+    orientation_state->last_sample_time_us = 0;
+    orientation_state->sample_interval = 1.f / SAMPLE_FREQUENCY;
 
     /* Initial quaternion */
     orientation_state->quaternion = *k_psmove_quaternion_identity;
     orientation_state->reset_quaternion = *k_psmove_quaternion_identity;
 
+    orientation_state->quaternion_fixed_stale = true;
+    orientation_state->beta_fixed = psmove_q30_from_float(beta);
+
     /* Initialize data specific to the selected filter */
     switch (psmove_get_model(move)) {
         case Model_ZCM1:
@@ -212,6 +303,17 @@ psmove_orientation_set_fusion_type(PSMoveOrientation *orientation_state, enum PS
             marg_state->mg_weight = 1.f;
         }
         break;
+    case OrientationFusion_ESKF:
+        {
+            PSMoveESKFState *eskf_state = &orientation_state->fusion_state.eskf_state;
+
+            // Start with a large uncertainty, so the first measurements are trusted
+            eskf_state->gyroscope_bias = glm::vec3(0.f);
+            eskf_state->P_tt = glm::mat3(k_eskf_initial_orientation_variance);
+            eskf_state->P_tb = glm::mat3(0.f);
+            eskf_state->P_bb = glm::mat3(k_eskf_initial_gyroscope_bias_variance);
+        }
+        break;
     default:
         break;
     }
@@ -224,6 +326,7 @@ psmove_orientation_set_calibration_transform(PSMoveOrientation *orientation_stat
     psmove_return_if_fail(transform != NULL);
 
     orientation_state->calibration_transform= *transform;
+    _psmove_orientation_update_fixed_point_state(orientation_state);
 }
 
 void
@@ -233,6 +336,7 @@ psmove_orientation_set_sensor_data_transform(PSMoveOrientation *orientation_stat
     psmove_return_if_fail(transform != NULL);
 
     orientation_state->sensor_transform= *transform;
+    _psmove_orientation_update_fixed_point_state(orientation_state);
 }
 
 PSMove_3AxisVector
@@ -278,12 +382,9 @@ psmove_orientation_get_accelerometer_vector(PSMoveOrientation *orientation_state
 {
     psmove_return_val_if_fail(orientation_state != NULL, *k_psmove_vector_zero);
 
-    float ax, ay, az;
-    psmove_get_accelerometer_frame(orientation_state->move, frame, &ax, &ay, &az);
-
-    // Apply the "identity pose" transform
-    PSMove_3AxisVector a = psmove_3axisvector_xyz(ax, ay, az);
-    a= psmove_3axisvector_apply_transform(&a, &orientation_state->sensor_transform);
+    // Calibrated and transformed into the sensor data basis by psmove_poll()
+    PSMove_3AxisVector a;
+    psmove_get_transformed_accelerometer_frame_3axisvector(orientation_state->move, frame, &a);
 
     return a;
 }
@@ -306,12 +407,9 @@ psmove_orientation_get_gyroscope_vector(PSMoveOrientation *orientation_state, en
 {
     psmove_return_val_if_fail(orientation_state != NULL, *k_psmove_vector_zero);
 
-    float omega_x, omega_y, omega_z;
-    psmove_get_gyroscope_frame(orientation_state->move, frame, &omega_x, &omega_y, &omega_z);
-
-    // Apply the "identity pose" transform
-    PSMove_3AxisVector omega = psmove_3axisvector_xyz(omega_x, omega_y, omega_z);
-    omega= psmove_3axisvector_apply_transform(&omega, &orientation_state->sensor_transform);
+    // Calibrated and transformed into the sensor data basis by psmove_poll()
+    PSMove_3AxisVector omega;
+    psmove_get_transformed_gyroscope_frame_3axisvector(orientation_state->move, frame, &omega);
 
     return omega;
 }
@@ -337,27 +435,33 @@ psmove_orientation_update(PSMoveOrientation *orientation_state)
     psmove_return_if_fail(orientation_state != NULL);
 
     int frame_half;
-    long now = psmove_util_get_ticks();
 
-    if (now - orientation_state->sample_freq_measure_start >= 1000) 
+    if (orientation_state->fusion_type == OrientationFusion_MadgwickIMU &&
+            _psmove_get_fixed_point(orientation_state->move))
     {
-        float measured = ((float)orientation_state->sample_freq_measure_count) /
-            ((float)(now-orientation_state->sample_freq_measure_start))*1000.f;
-        PSMOVE_DEBUG("Measured sample_freq: %f", measured);
+        // Stays in fixed-point, the float quaternion is only converted when it's read
+        float delta_t[2];
+        _psmove_orientation_measure_delta_t(orientation_state, delta_t);
 
-        orientation_state->sample_freq = measured;
-        orientation_state->sample_freq_measure_start = now;
-        orientation_state->sample_freq_measure_count = 0;
+        for (frame_half=0; frame_half<2; frame_half++)
+        {
+            _psmove_orientation_fusion_imu_update_fixed(orientation_state, delta_t[frame_half], (enum PSMove_Frame)(frame_half));
+        }
+        return;
     }
 
-    /* We get 2 measurements per call to psmove_poll() */
-    orientation_state->sample_freq_measure_count += 2;
+    // The other filters work on the float quaternion
+    _psmove_orientation_sync_quaternion(orientation_state);
+    orientation_state->quaternion_fixed_stale = true;
 
     glm::quat quaternion_backup = orientation_state->quaternion;
-    float deltaT = 1.f / fmax(orientation_state->sample_freq, SAMPLE_FREQUENCY); // time delta = 1/frequency
+    float delta_t[2];
+    _psmove_orientation_measure_delta_t(orientation_state, delta_t);
 
     for (frame_half=0; frame_half<2; frame_half++) 
     {
+        float deltaT = delta_t[frame_half];
+
         switch (orientation_state->fusion_type)
         {
         case OrientationFusion_None:
@@ -415,6 +519,27 @@ psmove_orientation_update(PSMoveOrientation *orientation_state)
                     glm::vec3(m.x, m.y, m.z));
             }
             break;
+        case OrientationFusion_ESKF:
+            {
+                PSMove_3AxisVector m= 
+                    psmove_orientation_get_magnetometer_normalized_vector(orientation_state);
+                PSMove_3AxisVector a= 
+                    psmove_orientation_get_accelerometer_vector(orientation_state, (enum PSMove_Frame)(frame_half));
+                PSMove_3AxisVector omega= 
+                    psmove_orientation_get_gyroscope_vector(orientation_state, (enum PSMove_Frame)(frame_half));
+
+                // Apply the filter (with the raw accelerometer, its magnitude is used to detect motion)
+                _psmove_orientation_fusion_eskf_update(
+                    orientation_state,
+                    deltaT,
+                    /* Gyroscope */
+                    glm::vec3(omega.x, omega.y, omega.z),
+                    /* Accelerometer */
+                    glm::vec3(a.x, a.y, a.z),
+                    /* Magnetometer */
+                    glm::vec3(m.x, m.y, m.z));
+            }
+            break;
         }
 
         if (!psmove_quaternion_is_valid(orientation_state->quaternion)) 
@@ -425,12 +550,81 @@ psmove_orientation_update(PSMoveOrientation *orientation_state)
     }
 }
 
+void
+psmove_orientation_update_batch(PSMoveOrientation **orientation_states, size_t count)
+{
+    psmove_return_if_fail(orientation_states != NULL || count == 0);
+
+    PSMoveOrientationBatch batch;
+    batch.count = 0;
+
+    for (size_t i=0; i<count; i++)
+    {
+        PSMoveOrientation *orientation_state = orientation_states[i];
+
+        if (orientation_state == NULL)
+        {
+            continue;
+        }
+
+        // Only the (floating point) Madgwick IMU filter has a vectorized implementation
+        bool vectorized = (orientation_state->fusion_type == OrientationFusion_MadgwickIMU &&
+                !_psmove_get_fixed_point(orientation_state->move));
+        if (!vectorized)
+        {
+            psmove_orientation_update(orientation_state);
+            continue;
+        }
+
+        int lane = batch.count++;
+        batch.states[lane] = orientation_state;
+        batch.quaternion_backup[lane] = orientation_state->quaternion;
+        float delta_t[2];
+        _psmove_orientation_measure_delta_t(orientation_state, delta_t);
+
+        batch.qw[lane] = orientation_state->quaternion.w;
+        batch.qx[lane] = orientation_state->quaternion.x;
+        batch.qy[lane] = orientation_state->quaternion.y;
+        batch.qz[lane] = orientation_state->quaternion.z;
+
+        PSMove_3AxisVector identity_g = psmove_orientation_get_gravity_calibration_direction(orientation_state);
+        batch.dx[lane] = identity_g.x;
+        batch.dy[lane] = identity_g.y;
+        batch.dz[lane] = identity_g.z;
+
+        for (int frame=0; frame<2; frame++)
+        {
+            PSMove_3AxisVector a =
+                psmove_orientation_get_accelerometer_normalized_vector(orientation_state, (enum PSMove_Frame)(frame));
+            PSMove_3AxisVector omega =
+                psmove_orientation_get_gyroscope_vector(orientation_state, (enum PSMove_Frame)(frame));
+
+            batch.delta_t[frame][lane] = delta_t[frame];
+            batch.ax[frame][lane] = a.x;
+            batch.ay[frame][lane] = a.y;
+            batch.az[frame][lane] = a.z;
+            batch.wx[frame][lane] = omega.x;
+            batch.wy[frame][lane] = omega.y;
+            batch.wz[frame][lane] = omega.z;
+        }
+
+        if (batch.count == ORIENTATION_BATCH_SIZE)
+        {
+            _psmove_orientation_batch_flush(&batch);
+        }
+    }
+
+    _psmove_orientation_batch_flush(&batch);
+}
+
 void
 psmove_orientation_get_quaternion(PSMoveOrientation *orientation_state,
         float *q0, float *q1, float *q2, float *q3)
 {
     psmove_return_if_fail(orientation_state != NULL);
 
+    _psmove_orientation_sync_quaternion(orientation_state);
+
     const glm::quat &reset_quaternion = orientation_state->reset_quaternion;
     const glm::quat &current_quaternion = orientation_state->quaternion;
     glm::quat result= reset_quaternion * current_quaternion;
@@ -452,11 +646,105 @@ psmove_orientation_get_quaternion(PSMoveOrientation *orientation_state,
     }
 }
 
+void
+psmove_orientation_get_predicted_quaternion(PSMoveOrientation *orientation_state, float delta_t,
+        float *q0, float *q1, float *q2, float *q3)
+{
+    psmove_return_if_fail(orientation_state != NULL);
+
+    _psmove_orientation_sync_quaternion(orientation_state);
+
+    glm::quat predicted = orientation_state->quaternion;
+
+    if (delta_t > 0.f && orientation_state->fusion_type != OrientationFusion_None)
+    {
+        PSMove_3AxisVector first = psmove_orientation_get_gyroscope_vector(orientation_state, Frame_FirstHalf);
+        PSMove_3AxisVector second = psmove_orientation_get_gyroscope_vector(orientation_state, Frame_SecondHalf);
+        glm::vec3 omega(second.x, second.y, second.z);
+        glm::vec3 alpha = (omega - glm::vec3(first.x, first.y, first.z)) / orientation_state->sample_interval;
+
+        if (orientation_state->fusion_type == OrientationFusion_ESKF)
+        {
+            omega -= orientation_state->fusion_state.eskf_state.gyroscope_bias;
+        }
+
+        // Rotate on (in the sensor frame) with the angular acceleration between the two
+        // samples of the last report: angle = omega*t + alpha*t^2/2
+        glm::vec3 rotation = omega*delta_t + alpha*(0.5f*delta_t*delta_t);
+        predicted = glm::normalize(predicted * psmove_quaternion_from_rotation_vector(rotation));
+    }
+
+    glm::quat result = orientation_state->reset_quaternion * predicted;
+
+    if (q0) {
+        *q0 = result.w;
+    }
+
+    if (q1) {
+        *q1 = result.x;
+    }
+
+    if (q2) {
+        *q2 = result.y;
+    }
+
+    if (q3) {
+        *q3 = result.z;
+    }
+}
+
+bool
+psmove_orientation_get_covariance(PSMoveOrientation *orientation_state, float *covariance)
+{
+    psmove_return_val_if_fail(orientation_state != NULL, false);
+    psmove_return_val_if_fail(covariance != NULL, false);
+
+    if (orientation_state->fusion_type != OrientationFusion_ESKF)
+    {
+        return false;
+    }
+
+    const PSMoveESKFState *eskf_state = &orientation_state->fusion_state.eskf_state;
+
+    // 6x6 row-major; glm matrices are indexed [column][row]
+    for (int row=0; row<3; row++)
+    {
+        for (int column=0; column<3; column++)
+        {
+            covariance[row*6 + column] = eskf_state->P_tt[column][row];
+            covariance[row*6 + column + 3] = eskf_state->P_tb[column][row];
+            covariance[(row + 3)*6 + column] = eskf_state->P_tb[row][column];
+            covariance[(row + 3)*6 + column + 3] = eskf_state->P_bb[column][row];
+        }
+    }
+
+    return true;
+}
+
+bool
+psmove_orientation_get_gyroscope_bias(PSMoveOrientation *orientation_state, PSMove_3AxisVector *out_bias)
+{
+    psmove_return_val_if_fail(orientation_state != NULL, false);
+    psmove_return_val_if_fail(out_bias != NULL, false);
+
+    if (orientation_state->fusion_type != OrientationFusion_ESKF)
+    {
+        return false;
+    }
+
+    const glm::vec3 &bias = orientation_state->fusion_state.eskf_state.gyroscope_bias;
+    *out_bias = psmove_3axisvector_xyz(bias.x, bias.y, bias.z);
+
+    return true;
+}
+
 void
 psmove_orientation_reset_quaternion(PSMoveOrientation *orientation_state)
 {
     psmove_return_if_fail(orientation_state != NULL);
 
+    _psmove_orientation_sync_quaternion(orientation_state);
+
     glm::quat q_inverse = glm::conjugate(orientation_state->quaternion);
 
     psmove_quaternion_normalize_with_default(q_inverse, *k_psmove_quaternion_identity);
@@ -471,6 +759,132 @@ psmove_orientation_free(PSMoveOrientation *orientation_state)
     free(orientation_state);
 }
 
+// -- private methods -----
+static void
+_psmove_orientation_measure_delta_t(PSMoveOrientation *orientation_state, float *out_delta_t)
+{
+    // Measure on the reconstructed sampling clock instead of the wall clock, so that
+    // replayed captures give the same result at any replay speed. It follows the device
+    // timestamps (the arrival times until their tick rate is known), so the time between
+    // two reports also includes the reports lost in between.
+    uint64_t now = psmove_get_sample_time_us(orientation_state->move);
+    uint64_t last = orientation_state->last_sample_time_us;
+    orientation_state->last_sample_time_us = now;
+
+    if (last == 0)
+    {
+        // Nothing to measure against yet
+        out_delta_t[0] = out_delta_t[1] = orientation_state->sample_interval;
+        return;
+    }
+
+    if (now <= last)
+    {
+        // Arrived in the same burst, the time is integrated with the next report
+        out_delta_t[0] = out_delta_t[1] = 0.f;
+        return;
+    }
+
+    float report_delta_t = fminf((float)(now - last) / 1000000.f, k_max_report_delta_t);
+    float sample_interval = orientation_state->sample_interval;
+
+    // Sequence numbers can't show a multiple of 16 lost reports, the time can
+    bool reports_lost = (_psmove_get_reports_lost_before_input(orientation_state->move) > 0 ||
+        report_delta_t > 3.f * sample_interval);
+
+    if (reports_lost)
+    {
+        // The second sample is one interval after the first one, the first
+        // sample covers the whole gap since the previous report
+        out_delta_t[1] = fminf(sample_interval, report_delta_t / 2.f);
+        out_delta_t[0] = report_delta_t - out_delta_t[1];
+    }
+    else
+    {
+        // Both samples of a report are one sample interval apart
+        out_delta_t[0] = out_delta_t[1] = report_delta_t / 2.f;
+
+        orientation_state->sample_interval +=
+            (report_delta_t / 2.f - sample_interval) * k_sample_interval_weight;
+    }
+}
+
+static void
+_psmove_orientation_update_fixed_point_state(PSMoveOrientation *orientation_state)
+{
+    // The direction only changes with the transforms, so convert it once here
+    PSMove_3AxisVector identity_g= psmove_orientation_get_gravity_calibration_direction(orientation_state);
+    psmove_3axisvector_normalize_with_default(&identity_g, k_psmove_vector_zero);
+
+    orientation_state->gravity_direction_fixed[0] = psmove_q30_from_float(identity_g.x);
+    orientation_state->gravity_direction_fixed[1] = psmove_q30_from_float(identity_g.y);
+    orientation_state->gravity_direction_fixed[2] = psmove_q30_from_float(identity_g.z);
+}
+
+static void
+_psmove_orientation_sync_quaternion(PSMoveOrientation *orientation_state)
+{
+    // Update the float quaternion from the fixed-point filter before it's used
+    if (orientation_state->quaternion_stale)
+    {
+        const psmove_q30 *q = orientation_state->quaternion_fixed;
+        orientation_state->quaternion = glm::quat(psmove_q30_to_float(q[0]), psmove_q30_to_float(q[1]),
+            psmove_q30_to_float(q[2]), psmove_q30_to_float(q[3]));
+        orientation_state->quaternion_stale = false;
+    }
+}
+
+static void
+_psmove_orientation_batch_flush(PSMoveOrientationBatch *batch)
+{
+    if (batch->count == 0)
+    {
+        return;
+    }
+
+    // Pad the last SIMD vector with lanes that have no accelerometer reading and no
+    // rotation, so they take the gyro-only path and stay at the identity quaternion
+    int padded_count = (batch->count + PSMOVE_SIMD_WIDTH - 1) / PSMOVE_SIMD_WIDTH * PSMOVE_SIMD_WIDTH;
+    for (int lane=batch->count; lane<padded_count; lane++)
+    {
+        batch->qw[lane] = 1.f;
+        batch->qx[lane] = batch->qy[lane] = batch->qz[lane] = 0.f;
+        batch->dx[lane] = batch->dy[lane] = batch->dz[lane] = 0.f;
+
+        for (int frame=0; frame<2; frame++)
+        {
+            batch->delta_t[frame][lane] = 0.f;
+            batch->ax[frame][lane] = batch->ay[frame][lane] = batch->az[frame][lane] = 0.f;
+            batch->wx[frame][lane] = batch->wy[frame][lane] = batch->wz[frame][lane] = 0.f;
+        }
+    }
+
+    for (int frame=0; frame<2; frame++)
+    {
+        _psmove_orientation_fusion_imu_update_batch(batch, frame);
+
+        for (int lane=0; lane<batch->count; lane++)
+        {
+            glm::quat q(batch->qw[lane], batch->qx[lane], batch->qy[lane], batch->qz[lane]);
+
+            if (!psmove_quaternion_is_valid(q))
+            {
+                PSMOVE_WARNING("Orientation is NaN!");
+                q = batch->quaternion_backup[lane];
+
+                batch->qw[lane] = q.w;
+                batch->qx[lane] = q.x;
+                batch->qy[lane] = q.y;
+                batch->qz[lane] = q.z;
+            }
+
+            batch->states[lane]->quaternion = q;
+        }
+    }
+
+    batch->count = 0;
+}
+
 // -- Orientation Filters ----
 
 // This algorithm comes from Sebastian O.H. Madgwick's 2010 paper:
@@ -491,7 +905,7 @@ static void _psmove_orientation_fusion_imu_update(
     glm::quat omega = glm::quat(0.f, current_omega.x, current_omega.y, current_omega.z);
     glm::quat SEqDot_omega = (SEq * 0.5f) *omega;
 
-    if (is_nearly_equal(glm::dot(current_g, current_g), 0.f, k_normal_epsilon*k_normal_epsilon))
+    if (!is_nearly_equal(glm::dot(current_g, current_g), 0.f, k_normal_epsilon*k_normal_epsilon))
     {
         // Get the direction of the gravitational fields in the identity pose		
         PSMove_3AxisVector identity_g= psmove_orientation_get_gravity_calibration_direction(orientation_state);
@@ -536,6 +950,258 @@ static void _psmove_orientation_fusion_imu_update(
     orientation_state->quaternion= SEq_new;
 }
 
+// Fixed-point version of _psmove_orientation_fusion_imu_update() for hosts without a fast FPU.
+// Quaternions and directions are 2.30, the sensor readings 16.16 fixed-point.
+static void
+_psmove_orientation_fusion_imu_update_fixed(
+    PSMoveOrientation *orientation_state,
+    float delta_t,
+    enum PSMove_Frame frame)
+{
+    const psmove_q16 k_accelerometer_epsilon = (psmove_q16)(k_normal_epsilon * PSMOVE_Q16_ONE + .5f);
+
+    // Gradients shorter than this (in 8.56) count as zero, like is_nearly_zero() in the float filter
+    const int64_t k_gradient_epsilon = (int64_t)1 << 33;
+
+    psmove_q16 omega[3];
+    psmove_q16 a[3];
+    _psmove_get_transformed_gyroscope_frame_fixed(orientation_state->move, frame, omega);
+    _psmove_get_transformed_accelerometer_frame_fixed(orientation_state->move, frame, a);
+
+    const psmove_q30 *d = orientation_state->gravity_direction_fixed;
+    psmove_q30 *q = orientation_state->quaternion_fixed;
+
+    if (orientation_state->quaternion_fixed_stale)
+    {
+        // Continue from the float quaternion (initial, or from another filter)
+        q[0] = psmove_q30_from_float(orientation_state->quaternion.w);
+        q[1] = psmove_q30_from_float(orientation_state->quaternion.x);
+        q[2] = psmove_q30_from_float(orientation_state->quaternion.y);
+        q[3] = psmove_q30_from_float(orientation_state->quaternion.z);
+        orientation_state->quaternion_fixed_stale = false;
+    }
+
+    // Current orientation from earth frame to sensor frame
+    psmove_q30 qw = q[0], qx = q[1], qy = q[2], qz = q[3];
+    psmove_q30 dt = psmove_q30_from_float(delta_t);
+
+    // Eqn 12) q_dot = 0.5*q*omega, integrated right away: step= q*(0.5*omega*delta_t)
+    psmove_q30 hx = (psmove_q30)(((int64_t)omega[0] * dt) >> 17);
+    psmove_q30 hy = (psmove_q30)(((int64_t)omega[1] * dt) >> 17);
+    psmove_q30 hz = (psmove_q30)(((int64_t)omega[2] * dt) >> 17);
+
+    int64_t step_w = -(int64_t)psmove_q30_mul(qx, hx) - psmove_q30_mul(qy, hy) - psmove_q30_mul(qz, hz);
+    int64_t step_x = (int64_t)psmove_q30_mul(qw, hx) + psmove_q30_mul(qy, hz) - psmove_q30_mul(qz, hy);
+    int64_t step_y = (int64_t)psmove_q30_mul(qw, hy) + psmove_q30_mul(qz, hx) - psmove_q30_mul(qx, hz);
+    int64_t step_z = (int64_t)psmove_q30_mul(qw, hz) + psmove_q30_mul(qx, hy) - psmove_q30_mul(qy, hx);
+
+    uint32_t a_length = psmove_fixed_sqrt(
+        (uint64_t)((int64_t)a[0] * a[0] + (int64_t)a[1] * a[1] + (int64_t)a[2] * a[2]));
+
+    if (a_length > (uint32_t)k_accelerometer_epsilon)
+    {
+        // Normalize the accelerometer reading (16.16 -> 2.30)
+        psmove_q30 ax = (psmove_q30)(((int64_t)a[0] << 30) / a_length);
+        psmove_q30 ay = (psmove_q30)(((int64_t)a[1] << 30) / a_length);
+        psmove_q30 az = (psmove_q30)(((int64_t)a[2] << 30) / a_length);
+
+        // Eqn 15) Applied to the gravity vector: f = (q^-1 * d * q) - a
+        psmove_q30 ux = -qx, uy = -qy, uz = -qz;
+        psmove_q30 uvx = psmove_q30_mul(uy, d[2]) - psmove_q30_mul(uz, d[1]);
+        psmove_q30 uvy = psmove_q30_mul(uz, d[0]) - psmove_q30_mul(ux, d[2]);
+        psmove_q30 uvz = psmove_q30_mul(ux, d[1]) - psmove_q30_mul(uy, d[0]);
+        psmove_q30 uuvx = psmove_q30_mul(uy, uvz) - psmove_q30_mul(uz, uvy);
+        psmove_q30 uuvy = psmove_q30_mul(uz, uvx) - psmove_q30_mul(ux, uvz);
+        psmove_q30 uuvz = psmove_q30_mul(ux, uvy) - psmove_q30_mul(uy, uvx);
+
+        // (4.28, the difference of two unit vectors needs more than 2.30)
+        int64_t fx = ((int64_t)d[0] + 2 * ((int64_t)psmove_q30_mul(uvx, qw) + uuvx) - ax) >> 2;
+        int64_t fy = ((int64_t)d[1] + 2 * ((int64_t)psmove_q30_mul(uvy, qw) + uuvy) - ay) >> 2;
+        int64_t fz = ((int64_t)d[2] + 2 * ((int64_t)psmove_q30_mul(uvz, qw) + uuvz) - az) >> 2;
+
+        // Eqn 21) and 22) The objective function Jacobian (4.28)
+        int64_t two_dxq1 = (int64_t)psmove_q30_mul(d[0], qw) >> 1, two_dxq2 = (int64_t)psmove_q30_mul(d[0], qx) >> 1;
+        int64_t two_dxq3 = (int64_t)psmove_q30_mul(d[0], qy) >> 1, two_dxq4 = (int64_t)psmove_q30_mul(d[0], qz) >> 1;
+        int64_t two_dyq1 = (int64_t)psmove_q30_mul(d[1], qw) >> 1, two_dyq2 = (int64_t)psmove_q30_mul(d[1], qx) >> 1;
+        int64_t two_dyq3 = (int64_t)psmove_q30_mul(d[1], qy) >> 1, two_dyq4 = (int64_t)psmove_q30_mul(d[1], qz) >> 1;
+        int64_t two_dzq1 = (int64_t)psmove_q30_mul(d[2], qw) >> 1, two_dzq2 = (int64_t)psmove_q30_mul(d[2], qx) >> 1;
+        int64_t two_dzq3 = (int64_t)psmove_q30_mul(d[2], qy) >> 1, two_dzq4 = (int64_t)psmove_q30_mul(d[2], qz) >> 1;
+
+        // Eqn 34) gradient_F= J_g(SEq)*f(SEq, Sa) (8.56)
+        int64_t gradient[4] = {
+            (two_dyq4 - two_dzq3) * fx + (-two_dxq4 + two_dzq2) * fy + (two_dxq3 - two_dyq2) * fz,
+            (two_dyq3 + two_dzq4) * fx + (two_dxq3 - 2 * two_dyq2 + two_dzq1) * fy + (two_dxq4 - two_dyq1 - 2 * two_dzq2) * fz,
+            (-2 * two_dxq3 + two_dyq2 - two_dzq1) * fx + (two_dxq2 + two_dzq4) * fy + (two_dxq1 + two_dyq4 - 2 * two_dzq3) * fz,
+            (-2 * two_dxq4 + two_dyq1 + two_dzq2) * fx + (-two_dxq1 - 2 * two_dyq4 + two_dzq3) * fy + (two_dxq2 + two_dyq3) * fz,
+        };
+
+        int64_t gradient_max = 0;
+        for (int i=0; i<4; i++)
+        {
+            int64_t magnitude = (gradient[i] < 0) ? -gradient[i] : gradient[i];
+            if (magnitude > gradient_max)
+            {
+                gradient_max = magnitude;
+            }
+        }
+
+        if (gradient_max > k_gradient_epsilon)
+        {
+            // Only the direction is needed, so scale the largest component to 2^28..2^29
+            int shift = 0;
+            while ((gradient_max >> shift) >= ((int64_t)1 << 29))
+            {
+                shift++;
+            }
+
+            int64_t gradient_length_squared = 0;
+            for (int i=0; i<4; i++)
+            {
+                gradient[i] >>= shift;
+                gradient_length_squared += gradient[i] * gradient[i];
+            }
+
+            // normalize the gradient, then Eqn 43) step -= beta*delta_t*SEqHatDot
+            int64_t inverse_length = ((int64_t)1 << 60) / psmove_fixed_sqrt((uint64_t)gradient_length_squared);
+            psmove_q30 beta_dt = psmove_q30_mul(orientation_state->beta_fixed, dt);
+
+            step_w -= psmove_q30_mul(beta_dt, (psmove_q30)((gradient[0] * inverse_length) >> 30));
+            step_x -= psmove_q30_mul(beta_dt, (psmove_q30)((gradient[1] * inverse_length) >> 30));
+            step_y -= psmove_q30_mul(beta_dt, (psmove_q30)((gradient[2] * inverse_length) >> 30));
+            step_z -= psmove_q30_mul(beta_dt, (psmove_q30)((gradient[3] * inverse_length) >> 30));
+        }
+    }
+
+    // Eqn 42) SEq_new = SEq + SEqDot_est*delta_t
+    int64_t w = qw + step_w, x = qx + step_x, y = qy + step_y, z = qz + step_z;
+
+    orientation_state->quaternion_stale = true;
+
+    // Make sure the net quaternion is a pure rotation quaternion
+    uint32_t length = psmove_fixed_sqrt((uint64_t)(w*w + x*x + y*y + z*z));
+    if (length == 0)
+    {
+        q[0] = PSMOVE_Q30_ONE;
+        q[1] = q[2] = q[3] = 0;
+        return;
+    }
+
+    int64_t inverse_length = ((int64_t)1 << 60) / length;
+    q[0] = (psmove_q30)((w * inverse_length) >> 30);
+    q[1] = (psmove_q30)((x * inverse_length) >> 30);
+    q[2] = (psmove_q30)((y * inverse_length) >> 30);
+    q[3] = (psmove_q30)((z * inverse_length) >> 30);
+}
+
+// Same filter as _psmove_orientation_fusion_imu_update(), run on PSMOVE_SIMD_WIDTH
+// controllers at a time. Instead of branching, the gravity correction is computed for
+// every lane and masked out where there is no valid accelerometer reading.
+static void
+_psmove_orientation_fusion_imu_update_batch(PSMoveOrientationBatch *batch, int frame)
+{
+    const PSMoveSIMDFloat k_zero = psmove_simd_set(0.f);
+    const PSMoveSIMDFloat k_one = psmove_simd_set(1.f);
+    const PSMoveSIMDFloat k_half = psmove_simd_set(0.5f);
+    const PSMoveSIMDFloat k_two = psmove_simd_set(2.f);
+    const PSMoveSIMDFloat k_minus_beta = psmove_simd_set(-(beta));
+    const PSMoveSIMDFloat k_g_epsilon = psmove_simd_set(k_normal_epsilon*k_normal_epsilon);
+    const PSMoveSIMDFloat k_gradient_epsilon = psmove_simd_set(k_real_epsilon);
+
+    for (int i=0; i<batch->count; i+=PSMOVE_SIMD_WIDTH)
+    {
+        // Current orientation from earth frame to sensor frame
+        PSMoveSIMDFloat qw = psmove_simd_load(&batch->qw[i]);
+        PSMoveSIMDFloat qx = psmove_simd_load(&batch->qx[i]);
+        PSMoveSIMDFloat qy = psmove_simd_load(&batch->qy[i]);
+        PSMoveSIMDFloat qz = psmove_simd_load(&batch->qz[i]);
+
+        PSMoveSIMDFloat dx = psmove_simd_load(&batch->dx[i]);
+        PSMoveSIMDFloat dy = psmove_simd_load(&batch->dy[i]);
+        PSMoveSIMDFloat dz = psmove_simd_load(&batch->dz[i]);
+
+        PSMoveSIMDFloat ax = psmove_simd_load(&batch->ax[frame][i]);
+        PSMoveSIMDFloat ay = psmove_simd_load(&batch->ay[frame][i]);
+        PSMoveSIMDFloat az = psmove_simd_load(&batch->az[frame][i]);
+
+        PSMoveSIMDFloat wx = psmove_simd_load(&batch->wx[frame][i]);
+        PSMoveSIMDFloat wy = psmove_simd_load(&batch->wy[frame][i]);
+        PSMoveSIMDFloat wz = psmove_simd_load(&batch->wz[frame][i]);
+
+        PSMoveSIMDFloat delta_t = psmove_simd_load(&batch->delta_t[frame][i]);
+
+        // Eqn 12) q_dot = 0.5*q*omega
+        PSMoveSIMDFloat hw = qw*k_half, hx = qx*k_half, hy = qy*k_half, hz = qz*k_half;
+        PSMoveSIMDFloat dot_w = k_zero - hx*wx - hy*wy - hz*wz;
+        PSMoveSIMDFloat dot_x = hw*wx + hy*wz - hz*wy;
+        PSMoveSIMDFloat dot_y = hw*wy + hz*wx - hx*wz;
+        PSMoveSIMDFloat dot_z = hw*wz + hx*wy - hy*wx;
+
+        // Eqn 15) Applied to the gravity vector: f = (q^-1 * d * q) - a
+        PSMoveSIMDFloat ux = k_zero - qx, uy = k_zero - qy, uz = k_zero - qz;
+        PSMoveSIMDFloat uvx = uy*dz - uz*dy;
+        PSMoveSIMDFloat uvy = uz*dx - ux*dz;
+        PSMoveSIMDFloat uvz = ux*dy - uy*dx;
+        PSMoveSIMDFloat uuvx = uy*uvz - uz*uvy;
+        PSMoveSIMDFloat uuvy = uz*uvx - ux*uvz;
+        PSMoveSIMDFloat uuvz = ux*uvy - uy*uvx;
+        PSMoveSIMDFloat fx = dx + (uvx*qw + uuvx)*k_two - ax;
+        PSMoveSIMDFloat fy = dy + (uvy*qw + uuvy)*k_two - ay;
+        PSMoveSIMDFloat fz = dz + (uvz*qw + uuvz)*k_two - az;
+
+        // Eqn 21) and 22) The objective function Jacobian
+        PSMoveSIMDFloat two_dxq1 = k_two*dx*qw, two_dxq2 = k_two*dx*qx, two_dxq3 = k_two*dx*qy, two_dxq4 = k_two*dx*qz;
+        PSMoveSIMDFloat two_dyq1 = k_two*dy*qw, two_dyq2 = k_two*dy*qx, two_dyq3 = k_two*dy*qy, two_dyq4 = k_two*dy*qz;
+        PSMoveSIMDFloat two_dzq1 = k_two*dz*qw, two_dzq2 = k_two*dz*qx, two_dzq3 = k_two*dz*qy, two_dzq4 = k_two*dz*qz;
+
+        // Eqn 34) gradient_F= J_g(SEq)*f(SEq, Sa)
+        PSMoveSIMDFloat gw =
+            (two_dyq4 - two_dzq3)*fx +
+            (k_zero - two_dxq4 + two_dzq2)*fy +
+            (two_dxq3 - two_dyq2)*fz;
+        PSMoveSIMDFloat gx =
+            (two_dyq3 + two_dzq4)*fx +
+            (two_dxq3 - k_two*two_dyq2 + two_dzq1)*fy +
+            (two_dxq4 - two_dyq1 - k_two*two_dzq2)*fz;
+        PSMoveSIMDFloat gy =
+            (k_zero - k_two*two_dxq3 + two_dyq2 - two_dzq1)*fx +
+            (two_dxq2 + two_dzq4)*fy +
+            (two_dxq1 + two_dyq4 - k_two*two_dzq3)*fz;
+        PSMoveSIMDFloat gz =
+            (k_zero - k_two*two_dxq4 + two_dyq1 + two_dzq2)*fx +
+            (k_zero - two_dxq1 - k_two*two_dyq4 + two_dzq3)*fy +
+            (two_dxq2 + two_dyq3)*fz;
+
+        // normalize the gradient (zero if there is no gradient)
+        PSMoveSIMDFloat g_length = psmove_simd_sqrt(gw*gw + gx*gx + gy*gy + gz*gz);
+        gw = psmove_simd_select_greater(g_length, k_gradient_epsilon, gw / g_length, k_zero);
+        gx = psmove_simd_select_greater(g_length, k_gradient_epsilon, gx / g_length, k_zero);
+        gy = psmove_simd_select_greater(g_length, k_gradient_epsilon, gy / g_length, k_zero);
+        gz = psmove_simd_select_greater(g_length, k_gradient_epsilon, gz / g_length, k_zero);
+
+        // Eqn 43) SEq_est = SEqDot_omega - beta*SEqHatDot
+        // (only where the accelerometer reading is valid, gyro only otherwise)
+        PSMoveSIMDFloat a_length_squared = ax*ax + ay*ay + az*az;
+        dot_w = dot_w + psmove_simd_select_greater(a_length_squared, k_g_epsilon, gw*k_minus_beta, k_zero);
+        dot_x = dot_x + psmove_simd_select_greater(a_length_squared, k_g_epsilon, gx*k_minus_beta, k_zero);
+        dot_y = dot_y + psmove_simd_select_greater(a_length_squared, k_g_epsilon, gy*k_minus_beta, k_zero);
+        dot_z = dot_z + psmove_simd_select_greater(a_length_squared, k_g_epsilon, gz*k_minus_beta, k_zero);
+
+        // Eqn 42) SEq_new = SEq + SEqDot_est*delta_t
+        qw = qw + dot_w*delta_t;
+        qx = qx + dot_x*delta_t;
+        qy = qy + dot_y*delta_t;
+        qz = qz + dot_z*delta_t;
+
+        // Make sure the net quaternion is a pure rotation quaternion
+        PSMoveSIMDFloat q_length = psmove_simd_sqrt(qw*qw + qx*qx + qy*qy + qz*qz);
+        PSMoveSIMDFloat q_scale = k_one / q_length;
+        psmove_simd_store(&batch->qw[i], psmove_simd_select_greater(q_length, k_zero, qw*q_scale, k_one));
+        psmove_simd_store(&batch->qx[i], psmove_simd_select_greater(q_length, k_zero, qx*q_scale, k_zero));
+        psmove_simd_store(&batch->qy[i], psmove_simd_select_greater(q_length, k_zero, qy*q_scale, k_zero));
+        psmove_simd_store(&batch->qz[i], psmove_simd_select_greater(q_length, k_zero, qz*q_scale, k_zero));
+    }
+}
+
 // This algorithm comes from Sebastian O.H. Madgwick's 2010 paper:
 // "An efficient orientation filter for inertial and inertial/magnetic sensor arrays"
 // https://www.samba.org/tridge/UAV/madgwick_internal_report.pdf
@@ -692,3 +1358,122 @@ _psmove_orientation_fusion_complementary_marg_update(
     orientation_state->fusion_state.complementary_marg_state.mg_weight =
         lerp_clampf(mg_wight, k_base_earth_frame_align_weight, 0.9f);
 }
+
+// Cross product matrix: _psmove_skew_matrix(v)*w == glm::cross(v, w)
+static glm::mat3
+_psmove_skew_matrix(const glm::vec3 &v)
+{
+    return glm::mat3(
+        0.f, v.z, -v.y,
+        -v.z, 0.f, v.x,
+        v.y, -v.x, 0.f);
+}
+
+// Kalman update of the error state with a direction measured in the sensor frame,
+// whose direction in the identity pose is known (gravity, magnetic field)
+static void
+_psmove_orientation_eskf_correct(
+    PSMoveESKFState *eskf_state,
+    glm::quat &q,
+    const glm::vec3 &identity_direction,
+    const glm::vec3 &measured_direction,
+    float noise)
+{
+    // Predicted measurement s= q^-1*d*q. An orientation error dtheta
+    // (q_true= q*exp(dtheta)) changes it by s x dtheta, so H= |[s]x 0|
+    glm::vec3 predicted_direction = psmove_vector3f_clockwise_rotate(q, identity_direction);
+    glm::mat3 H = _psmove_skew_matrix(predicted_direction);
+    glm::mat3 H_T = glm::transpose(H);
+
+    // Innovation covariance S= H*P*H^T + R and gain K= P*H^T*S^-1
+    glm::mat3 S = H*eskf_state->P_tt*H_T + glm::mat3(noise*noise);
+    glm::mat3 S_inverse = glm::inverse(S);
+    glm::mat3 K_t = eskf_state->P_tt*H_T*S_inverse;
+    glm::mat3 K_b = glm::transpose(eskf_state->P_tb)*H_T*S_inverse;
+
+    glm::vec3 innovation = measured_direction - predicted_direction;
+
+    // Ignore measurements that don't fit the current estimate at all (e.g. magnetic disturbances)
+    if (glm::dot(innovation, S_inverse*innovation) > k_eskf_outlier_threshold)
+    {
+        return;
+    }
+
+    // Inject the estimated error into the nominal state
+    q = glm::normalize(q * psmove_quaternion_from_rotation_vector(K_t*innovation));
+    eskf_state->gyroscope_bias += K_b*innovation;
+
+    // P= (I - K*H)*P, kept symmetric
+    glm::mat3 KH_t = K_t*H;
+    glm::mat3 KH_b = K_b*H;
+    glm::mat3 P_tt = eskf_state->P_tt - KH_t*eskf_state->P_tt;
+    glm::mat3 P_bb = eskf_state->P_bb - KH_b*eskf_state->P_tb;
+    eskf_state->P_tb = eskf_state->P_tb - KH_t*eskf_state->P_tb;
+    eskf_state->P_tt = (P_tt + glm::transpose(P_tt))*0.5f;
+    eskf_state->P_bb = (P_bb + glm::transpose(P_bb))*0.5f;
+}
+
+// Error-state (multiplicative) Kalman filter: the gyroscope is integrated into
+// the nominal orientation, while a 6D error state (orientation error, gyroscope
+// bias) and its covariance are corrected by the gravity and magnetic field directions.
+static void
+_psmove_orientation_fusion_eskf_update(
+    PSMoveOrientation *orientation_state,
+    float delta_t,
+    const glm::vec3 &current_omega,
+    const glm::vec3 &current_a,
+    const glm::vec3 &current_m)
+{
+    PSMoveESKFState *eskf_state = &orientation_state->fusion_state.eskf_state;
+    glm::quat q = orientation_state->quaternion;
+
+    // Prediction
+    //-----------
+    // Integrate the bias corrected angular velocity: q_new= q*exp(omega*dT)
+    glm::vec3 rotation = (current_omega - eskf_state->gyroscope_bias)*delta_t;
+    q = glm::normalize(q * psmove_quaternion_from_rotation_vector(rotation));
+
+    // Propagate the covariance: P= F*P*F^T + Q, with F= |A  -I*dT|, A= I - [omega*dT]x
+    //                                                    |0   I   |
+    glm::mat3 A = glm::mat3(1.f) - _psmove_skew_matrix(rotation);
+    glm::mat3 A_T = glm::transpose(A);
+    glm::mat3 P_tt = eskf_state->P_tt;
+    glm::mat3 P_tb = eskf_state->P_tb;
+    glm::mat3 P_bb = eskf_state->P_bb;
+
+    eskf_state->P_tt = A*P_tt*A_T - (A*P_tb + glm::transpose(P_tb)*A_T)*delta_t + P_bb*(delta_t*delta_t) +
+        glm::mat3(k_eskf_gyroscope_noise*k_eskf_gyroscope_noise*delta_t);
+    eskf_state->P_tb = A*P_tb - P_bb*delta_t;
+    eskf_state->P_bb = P_bb + glm::mat3(k_eskf_gyroscope_bias_drift*k_eskf_gyroscope_bias_drift*delta_t);
+
+    // Gravity Correction
+    //-------------------
+    // Linear acceleration makes the accelerometer a worse estimate of the gravity direction,
+    // so the measurement noise grows with the difference of its magnitude from 1g
+    float a_length = glm::length(current_a);
+    if (!is_nearly_zero(a_length))
+    {
+        PSMove_3AxisVector identity_g= psmove_orientation_get_gravity_calibration_direction(orientation_state);
+        float noise = k_eskf_accelerometer_noise + k_eskf_accelerometer_motion_noise*fabsf(a_length - 1.f);
+
+        _psmove_orientation_eskf_correct(
+            eskf_state, q, glm::vec3(identity_g.x, identity_g.y, identity_g.z), current_a / a_length, noise);
+    }
+
+    // Magnetometer Correction
+    //------------------------
+    // Only on controllers with a (calibrated) magnetometer, makes the yaw observable
+    PSMove_3AxisVector identity_m= psmove_orientation_get_magnetometer_calibration_direction(orientation_state);
+    psmove_3axisvector_normalize_with_default(&identity_m, k_psmove_vector_zero);
+    glm::vec3 k_identity_m_direction = glm::vec3(identity_m.x, identity_m.y, identity_m.z);
+
+    if (!is_nearly_equal(glm::dot(current_m, current_m), 0.f, k_normal_epsilon*k_normal_epsilon) &&
+        !is_nearly_equal(glm::dot(k_identity_m_direction, k_identity_m_direction), 0.f, k_normal_epsilon*k_normal_epsilon))
+    {
+        _psmove_orientation_eskf_correct(
+            eskf_state, q, k_identity_m_direction, current_m, k_eskf_magnetometer_noise);
+    }
+
+    // Save the new quaternion back into the orientation state
+    orientation_state->quaternion= q;
+}
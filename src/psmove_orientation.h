@@ -90,10 +90,28 @@ ADDCALL psmove_orientation_get_magnetometer_normalized_vector(PSMoveOrientation
 ADDAPI void
 ADDCALL psmove_orientation_update(PSMoveOrientation *orientation_state);
 
+/* Same as calling psmove_orientation_update() on each state, but Madgwick IMU
+   states are fused together in SIMD lanes (NULL entries are skipped) */
+ADDAPI void
+ADDCALL psmove_orientation_update_batch(PSMoveOrientation **orientation_states, size_t count);
+
 ADDAPI void
 ADDCALL psmove_orientation_get_quaternion(PSMoveOrientation *orientation_state,
         float *q0, float *q1, float *q2, float *q3);
 
+/* Quaternion extrapolated delta_t seconds ahead with the latest angular velocity and acceleration */
+ADDAPI void
+ADDCALL psmove_orientation_get_predicted_quaternion(PSMoveOrientation *orientation_state, float delta_t,
+        float *q0, float *q1, float *q2, float *q3);
+
+/* Error state covariance of OrientationFusion_ESKF (6x6, row-major), false for other fusion types */
+ADDAPI bool
+ADDCALL psmove_orientation_get_covariance(PSMoveOrientation *orientation_state, float *covariance);
+
+/* Gyroscope bias estimated by OrientationFusion_ESKF, false for other fusion types */
+ADDAPI bool
+ADDCALL psmove_orientation_get_gyroscope_bias(PSMoveOrientation *orientation_state, PSMove_3AxisVector *out_bias);
+
 ADDAPI void
 ADDCALL psmove_orientation_reset_quaternion(PSMoveOrientation *orientation_state);
 
@@ -65,6 +65,9 @@
 extern "C" {
 #endif
 
+struct _PSMoveFileLock;
+typedef struct _PSMoveFileLock PSMoveFileLock;
+
 /* Initialize sockets API (if required) -- call before using sockets */
 ADDAPI void
 ADDCALL psmove_port_initialize_sockets();
@@ -82,6 +85,16 @@ ADDCALL psmove_port_check_pairing_permissions();
 ADDAPI uint64_t
 ADDCALL psmove_port_get_time_ms();
 
+/**
+ * Get the current monotonic time in microseconds
+ *
+ * Unlike psmove_port_get_time_ms(), this is not relative to the first call,
+ * but uses the system's monotonic clock directly (CLOCK_MONOTONIC on Linux
+ * and macOS, the performance counter on Windows).
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_port_get_time_us();
+
 /**
  * Sleep for a specified amount of milliseconds
  **/
@@ -100,6 +113,61 @@ ADDCALL psmove_port_set_socket_timeout_ms(int socket, uint32_t timeout_ms);
 ADDAPI void
 ADDCALL psmove_port_close_socket(int socket);
 
+/**
+ * Map a file into memory for reading
+ *
+ * Returns a pointer to the contents (and stores the size in "size"), or NULL
+ * if the file does not exist, is empty or cannot be mapped. The mapping must
+ * be released with psmove_port_unmap_file().
+ *
+ * On Windows, the file is read into memory instead, because a file that is
+ * mapped by any process can't be replaced with psmove_port_replace_file().
+ **/
+ADDAPI const void *
+ADDCALL psmove_port_map_file(const char *filename, size_t *size);
+
+/**
+ * Release a mapping created by psmove_port_map_file()
+ **/
+ADDAPI void
+ADDCALL psmove_port_unmap_file(const void *data, size_t size);
+
+/**
+ * Atomically replace the file "to" with the file "from"
+ *
+ * Returns true on success.
+ **/
+ADDAPI bool
+ADDCALL psmove_port_replace_file(const char *from, const char *to);
+
+/**
+ * Write data to a new file with a unique name next to "filename", e.g. to
+ * replace "filename" with it using psmove_port_replace_file()
+ *
+ * The contents are flushed to disk before this returns, so that a crash
+ * after the replacement can't leave an empty file behind.
+ *
+ * Returns the name of the new file (must be freed), or NULL on error.
+ **/
+ADDAPI char *
+ADDCALL psmove_port_write_temporary_file(const char *filename, const void *data, size_t size);
+
+/**
+ * Take an exclusive lock across processes, blocking until it is available
+ *
+ * The lock is held on the file "filename", which is created if needed, and
+ * should not be the file that is protected (as that might be replaced).
+ * Returns NULL on error. Release the lock with psmove_port_unlock_file().
+ **/
+ADDAPI PSMoveFileLock *
+ADDCALL psmove_port_lock_file(const char *filename);
+
+/**
+ * Release a lock taken with psmove_port_lock_file()
+ **/
+ADDAPI void
+ADDCALL psmove_port_unlock_file(PSMoveFileLock *lock);
+
 /**
  * Get the default Bluetooth host controller address (result must be freed)
  **/
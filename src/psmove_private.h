@@ -101,6 +101,12 @@ struct PSMove_RGBValue {
 /* Maximum length of the serial string */
 #define PSMOVE_MAX_SERIAL_LENGTH 255
 
+/* Maximum milliseconds to inhibit further updates to LEDs if not changed */
+#define PSMOVE_MAX_LED_INHIBIT_MS 4000
+
+/* Minimum time (in milliseconds) between two LED updates (rate limiting) */
+#define PSMOVE_MIN_LED_UPDATE_WAIT_MS 120
+
 /**
  * [PRIVATE API] Write raw data blob to device
  **/
@@ -108,18 +114,70 @@ ADDAPI void
 ADDCALL _psmove_write_data(PSMove *move, unsigned char *data, size_t length);
 
 
+/**
+ * [PRIVATE API] Check if LEDs or rumble have changed since the last write
+ **/
+ADDAPI bool
+ADDCALL _psmove_get_leds_dirty(PSMove *move);
+
+/**
+ * [PRIVATE API] Write LEDs and rumble to the device now, bypassing the
+ * rate limiting and change detection of psmove_update_leds()
+ **/
+ADDAPI enum PSMove_Update_Result
+ADDCALL _psmove_flush_leds(PSMove *move);
+
 /**
  * [PRIVATE API] Read raw data blob from device
  **/
 ADDAPI void
 ADDCALL _psmove_read_data(PSMove *move, unsigned char *data, size_t length);
 
+/**
+ * [PRIVATE API] Number of reports lost right before the current input report
+ *
+ * Detected from the sequence numbers, so this is a lower bound (a multiple of
+ * 16 lost reports can't be detected).
+ **/
+ADDAPI int
+ADDCALL _psmove_get_reports_lost_before_input(PSMove *move);
+
+/**
+ * [PRIVATE API] Use fixed-point math for the calibration mapping and the
+ * Madgwick IMU fusion of this controller. The default is set at build time
+ * (PSMOVE_USE_FIXED_POINT), this allows comparing both in one build.
+ **/
+ADDAPI void
+ADDCALL _psmove_set_fixed_point(PSMove *move, bool enabled);
+
+ADDAPI bool
+ADDCALL _psmove_get_fixed_point(PSMove *move);
+
+/**
+ * [PRIVATE API] Like psmove_get_transformed_accelerometer_frame_3axisvector()
+ * and psmove_get_transformed_gyroscope_frame_3axisvector(), but as three
+ * 16.16 fixed-point values (for the fixed-point orientation fusion). Only
+ * valid if _psmove_get_fixed_point() is true.
+ **/
+ADDAPI void
+ADDCALL _psmove_get_transformed_accelerometer_frame_fixed(PSMove *move, enum PSMove_Frame frame, int32_t *out_a);
+
+ADDAPI void
+ADDCALL _psmove_get_transformed_gyroscope_frame_fixed(PSMove *move, enum PSMove_Frame frame, int32_t *out_w);
+
 /**
  * [PRIVATE API] Internal device open function (hidraw, Linux / for moved)
  **/
 ADDAPI PSMove *
 ADDCALL psmove_connect_internal(const wchar_t *serial, const char *path, int id, unsigned short pid);
 
+/**
+ * [PRIVATE API] Like psmove_wait_any(), but also return (true) when the
+ * file descriptor fd (if not -1) becomes readable (ignored on Windows)
+ **/
+ADDAPI bool
+ADDCALL _psmove_wait_any_fd(PSMove **moves, size_t count, int fd, int timeout_ms);
+
 /**
  * [PRIVATE API] Get device path of a controller (hidraw, Linux / for moved)
  **/
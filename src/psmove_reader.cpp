@@ -0,0 +1,461 @@
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+//-- includes -----
+#include "psmove_reader.h"
+#include "psmove_port.h"
+#include "psmove_private.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <unistd.h>
+#  include <fcntl.h>
+#  include <poll.h>
+#endif
+
+//-- definitions -----
+static_assert((PSMOVE_READER_RING_SIZE & (PSMOVE_READER_RING_SIZE - 1)) == 0,
+        "PSMOVE_READER_RING_SIZE must be a power of two");
+
+struct _PSMoveWaiter {
+    _PSMoveWaiter();
+    ~_PSMoveWaiter();
+
+    _PSMoveWaiter(const _PSMoveWaiter &other) = delete;
+    _PSMoveWaiter &operator=(const _PSMoveWaiter &other) = delete;
+
+    void signal();
+    void reset();
+    bool wait(int fd, int timeout_ms);
+
+#ifdef _WIN32
+    HANDLE event;
+#else
+    int pipe_fds[2];
+#endif
+};
+
+struct _PSMoveReader {
+    _PSMoveReader(hid_device *handle, size_t report_size);
+
+    void run();
+    bool push(const unsigned char *data, uint64_t arrival_us);
+    bool pop(unsigned char *data, uint64_t *arrival_us);
+    bool pending();
+
+    void add_waiter(PSMoveWaiter *waiter);
+    void remove_waiter(PSMoveWaiter *waiter);
+    void notify();
+
+    hid_device *handle;
+    size_t report_size;
+
+    unsigned char ring[PSMOVE_READER_RING_SIZE][PSMOVE_READER_MAX_REPORT_SIZE];
+    uint64_t arrival[PSMOVE_READER_RING_SIZE];
+
+    /**
+     * Free-running indices, masked on access; each written by one side only.
+     * Padded so that producer and consumer do not share a cache line.
+     **/
+    std::atomic<uint32_t> head; // written by the reader thread
+    char _pad[64 - sizeof(std::atomic<uint32_t>)];
+    std::atomic<uint32_t> tail; // written by the consumer
+
+    std::atomic<bool> running;
+    std::atomic<unsigned int> overflows;
+
+    /**
+     * Threads blocked in psmove_reader_wait() on this reader. The reader
+     * thread only takes the lock if waiter_count is non-zero, so this is
+     * free while nobody waits.
+     **/
+    std::mutex waiters_mutex;
+    std::vector<PSMoveWaiter *> waiters;
+    std::atomic<int> waiter_count;
+
+    std::thread thread;
+};
+
+//-- private methods -----
+_PSMoveWaiter::_PSMoveWaiter()
+{
+#ifdef _WIN32
+    /* Manual-reset, so that the event stays set until the waiter resets it */
+    event = CreateEvent(NULL, TRUE, FALSE, NULL);
+#else
+    if (pipe(pipe_fds) == 0) {
+        for (int fd: pipe_fds) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+    } else {
+        PSMOVE_WARNING("Could not create notification pipe");
+        pipe_fds[0] = pipe_fds[1] = -1;
+    }
+#endif
+}
+
+_PSMoveWaiter::~_PSMoveWaiter()
+{
+#ifdef _WIN32
+    if (event != NULL) {
+        CloseHandle(event);
+    }
+#else
+    for (int fd: pipe_fds) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+void
+_PSMoveWaiter::signal()
+{
+#ifdef _WIN32
+    if (event != NULL) {
+        SetEvent(event);
+    }
+#else
+    if (pipe_fds[1] != -1) {
+        /* If the pipe is full, it is readable anyway */
+        char dummy = 0;
+        ssize_t res = write(pipe_fds[1], &dummy, 1);
+        (void)res;
+    }
+#endif
+}
+
+void
+_PSMoveWaiter::reset()
+{
+#ifdef _WIN32
+    if (event != NULL) {
+        ResetEvent(event);
+    }
+#else
+    if (pipe_fds[0] != -1) {
+        char buf[64];
+        while (read(pipe_fds[0], buf, sizeof(buf)) > 0) {
+            /* drain */
+        }
+    }
+#endif
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+bool
+_PSMoveWaiter::wait(int fd, int timeout_ms)
+{
+#ifdef _WIN32
+    (void)fd;
+
+    if (event == NULL) {
+        psmove_port_sleep_ms(timeout_ms < 0 ? PSMOVE_READER_READ_TIMEOUT_MS : timeout_ms);
+        return false;
+    }
+
+    WaitForSingleObject(event, timeout_ms < 0 ? INFINITE : (DWORD)timeout_ms);
+    return false;
+#else
+    struct pollfd pfd[2];
+    nfds_t nfds = 0;
+
+    pfd[nfds].fd = pipe_fds[0];
+    pfd[nfds].events = POLLIN;
+    nfds++;
+
+    if (fd != -1) {
+        pfd[nfds].fd = fd;
+        pfd[nfds].events = POLLIN;
+        nfds++;
+    }
+
+    if (poll(pfd, nfds, timeout_ms) <= 0) {
+        return false;
+    }
+
+    return (fd != -1 && (pfd[1].revents & POLLIN) != 0);
+#endif
+}
+
+_PSMoveReader::_PSMoveReader(hid_device *handle, size_t report_size)
+    : handle(handle)
+    , report_size(report_size)
+    , head(0)
+    , _pad()
+    , tail(0)
+    , running(true)
+    , overflows(0)
+    , waiters_mutex()
+    , waiters()
+    , waiter_count(0)
+    , thread()
+{
+}
+
+void
+_PSMoveReader::run()
+{
+    unsigned char buf[PSMOVE_READER_MAX_REPORT_SIZE];
+
+    while (running.load(std::memory_order_acquire)) {
+        int res = hid_read_timeout(handle, buf, report_size, PSMOVE_READER_READ_TIMEOUT_MS);
+
+        if (res == (int)report_size) {
+            if (push(buf, psmove_port_get_time_us())) {
+                notify();
+            } else {
+                overflows.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else if (res < 0) {
+            /* Device went away or read error -- avoid spinning until we are stopped */
+            psmove_port_sleep_ms(PSMOVE_READER_READ_TIMEOUT_MS);
+        }
+    }
+}
+
+bool
+_PSMoveReader::push(const unsigned char *data, uint64_t arrival_us)
+{
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == PSMOVE_READER_RING_SIZE) {
+        return false;
+    }
+
+    memcpy(ring[h & (PSMOVE_READER_RING_SIZE - 1)], data, report_size);
+    arrival[h & (PSMOVE_READER_RING_SIZE - 1)] = arrival_us;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+bool
+_PSMoveReader::pop(unsigned char *data, uint64_t *arrival_us)
+{
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    memcpy(data, ring[t & (PSMOVE_READER_RING_SIZE - 1)], report_size);
+    if (arrival_us) {
+        *arrival_us = arrival[t & (PSMOVE_READER_RING_SIZE - 1)];
+    }
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool
+_PSMoveReader::pending()
+{
+    return (tail.load(std::memory_order_relaxed) != head.load(std::memory_order_acquire));
+}
+
+void
+_PSMoveReader::add_waiter(PSMoveWaiter *waiter)
+{
+    std::lock_guard<std::mutex> lock(waiters_mutex);
+    waiters.push_back(waiter);
+    waiter_count.fetch_add(1);
+}
+
+void
+_PSMoveReader::remove_waiter(PSMoveWaiter *waiter)
+{
+    std::lock_guard<std::mutex> lock(waiters_mutex);
+    waiters.erase(std::find(waiters.begin(), waiters.end(), waiter));
+    waiter_count.fetch_sub(1);
+}
+
+void
+_PSMoveReader::notify()
+{
+    /* Pairs with the fence in _PSMoveWaiter::reset(): either the waiter sees the new head, or we see the waiter */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiter_count.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(waiters_mutex);
+    for (auto waiter: waiters) {
+        waiter->signal();
+    }
+}
+
+//-- public methods -----
+PSMoveReader *
+psmove_reader_new(hid_device *handle, size_t report_size)
+{
+    psmove_return_val_if_fail(handle != NULL, NULL);
+    psmove_return_val_if_fail(report_size > 0, NULL);
+    psmove_return_val_if_fail(report_size <= PSMOVE_READER_MAX_REPORT_SIZE, NULL);
+
+    PSMoveReader *reader = new PSMoveReader(handle, report_size);
+
+    try {
+        reader->thread = std::thread(&_PSMoveReader::run, reader);
+    } catch (const std::system_error &e) {
+        PSMOVE_WARNING("Could not start reader thread: %s", e.what());
+        delete reader;
+        return NULL;
+    }
+
+    return reader;
+}
+
+int
+psmove_reader_pop(PSMoveReader *reader, unsigned char *data, size_t length,
+        uint64_t *arrival_us)
+{
+    psmove_return_val_if_fail(reader != NULL, 0);
+    psmove_return_val_if_fail(data != NULL, 0);
+    psmove_return_val_if_fail(length >= reader->report_size, 0);
+
+    if (reader->pop(data, arrival_us)) {
+        return (int)reader->report_size;
+    }
+
+    return 0;
+}
+
+unsigned int
+psmove_reader_get_overflow_count(PSMoveReader *reader)
+{
+    psmove_return_val_if_fail(reader != NULL, 0);
+
+    return reader->overflows.load(std::memory_order_relaxed);
+}
+
+bool
+psmove_reader_wait(PSMoveReader **readers, size_t count, int fd, int timeout_ms)
+{
+    psmove_return_val_if_fail(readers != NULL || count == 0, false);
+
+    PSMoveWaiter *waiter = psmove_waiter_get_current();
+    uint64_t deadline = psmove_port_get_time_ms() + (timeout_ms > 0 ? timeout_ms : 0);
+    bool result = false;
+
+    for (size_t i=0; i<count; i++) {
+        if (readers[i] != NULL) {
+            readers[i]->add_waiter(waiter);
+        }
+    }
+
+    while (true) {
+        /* Reset before checking, so that no report pushed after the check is missed */
+        psmove_waiter_reset(waiter);
+
+        for (size_t i=0; i<count; i++) {
+            if (readers[i] != NULL && readers[i]->pending()) {
+                result = true;
+                break;
+            }
+        }
+
+        if (result) {
+            break;
+        }
+
+        int remaining = -1;
+        if (timeout_ms >= 0) {
+            uint64_t now = psmove_port_get_time_ms();
+            if (now >= deadline) {
+                break;
+            }
+            remaining = (int)(deadline - now);
+        }
+
+        if (psmove_waiter_wait(waiter, fd, remaining)) {
+            result = true;
+            break;
+        }
+    }
+
+    for (size_t i=0; i<count; i++) {
+        if (readers[i] != NULL) {
+            readers[i]->remove_waiter(waiter);
+        }
+    }
+
+    return result;
+}
+
+PSMoveWaiter *
+psmove_waiter_get_current()
+{
+    static thread_local PSMoveWaiter waiter;
+    return &waiter;
+}
+
+void
+psmove_waiter_signal(PSMoveWaiter *waiter)
+{
+    psmove_return_if_fail(waiter != NULL);
+
+    waiter->signal();
+}
+
+void
+psmove_waiter_reset(PSMoveWaiter *waiter)
+{
+    psmove_return_if_fail(waiter != NULL);
+
+    waiter->reset();
+}
+
+bool
+psmove_waiter_wait(PSMoveWaiter *waiter, int fd, int timeout_ms)
+{
+    psmove_return_val_if_fail(waiter != NULL, false);
+
+    return waiter->wait(fd, timeout_ms);
+}
+
+void
+psmove_reader_free(PSMoveReader *reader)
+{
+    psmove_return_if_fail(reader != NULL);
+
+    reader->running.store(false, std::memory_order_release);
+    if (reader->thread.joinable()) {
+        reader->thread.join();
+    }
+
+    delete reader;
+}
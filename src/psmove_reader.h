@@ -0,0 +1,147 @@
+#pragma once
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-- includes -----
+#include "psmove.h"
+#include "hidapi.h"
+
+#include <stddef.h>
+
+//-- pre-declarations -----
+struct _PSMoveReader;
+typedef struct _PSMoveReader PSMoveReader;
+
+struct _PSMoveWaiter;
+typedef struct _PSMoveWaiter PSMoveWaiter;
+
+//-- constants -----
+
+/* Number of input reports that can be queued (must be a power of two) */
+#define PSMOVE_READER_RING_SIZE 256
+
+/* Largest input report size that fits into a ring slot */
+#define PSMOVE_READER_MAX_REPORT_SIZE 64
+
+/* Timeout (in milliseconds) of a single blocking read in the reader thread */
+#define PSMOVE_READER_READ_TIMEOUT_MS 50
+
+//-- interface -----
+
+/**
+ * Start a background thread that reads input reports of size report_size
+ * from handle and queues them in a lock-free single-producer/single-consumer
+ * ring. Reports are dropped (not overwritten) if the ring is full.
+ *
+ * Returns NULL if the thread could not be started.
+ **/
+ADDAPI PSMoveReader *
+ADDCALL psmove_reader_new(hid_device *handle, size_t report_size);
+
+/**
+ * Pop the oldest queued report into data (which must hold length bytes).
+ * If arrival_us is not NULL, it is set to the time the report was read
+ * (psmove_port_get_time_us()). Must only be called from a single consumer.
+ *
+ * Returns the report size if a report was popped, 0 if the ring is empty.
+ **/
+ADDAPI int
+ADDCALL psmove_reader_pop(PSMoveReader *reader, unsigned char *data, size_t length,
+        uint64_t *arrival_us);
+
+/**
+ * Number of reports that had to be dropped because the ring was full.
+ **/
+ADDAPI unsigned int
+ADDCALL psmove_reader_get_overflow_count(PSMoveReader *reader);
+
+/**
+ * Block until at least one of the readers has a queued report, until fd
+ * (if not -1) becomes readable, or until timeout_ms milliseconds have
+ * passed (a negative timeout waits forever).
+ *
+ * Only the given readers wake up the calling thread, using its waiter
+ * (see psmove_waiter_get_current()).
+ *
+ * The fd is ignored on Windows (there are no pollable fds for devices).
+ *
+ * Returns true if a report is queued or fd is readable, false on timeout.
+ **/
+ADDAPI bool
+ADDCALL psmove_reader_wait(PSMoveReader **readers, size_t count, int fd, int timeout_ms);
+
+/**
+ * The waiter of the calling thread: a notification that other threads
+ * can signal while this thread blocks in psmove_waiter_wait(). It is
+ * created on first use and lives as long as the thread.
+ **/
+ADDAPI PSMoveWaiter *
+ADDCALL psmove_waiter_get_current();
+
+/**
+ * Wake up the thread of waiter (or make its next psmove_waiter_wait()
+ * return right away, if it is not blocked yet).
+ **/
+ADDAPI void
+ADDCALL psmove_waiter_signal(PSMoveWaiter *waiter);
+
+/**
+ * Clear pending signals. Call this before checking whatever condition is
+ * waited for, so that a signal sent after the check is not lost.
+ **/
+ADDAPI void
+ADDCALL psmove_waiter_reset(PSMoveWaiter *waiter);
+
+/**
+ * Block until waiter is signalled, until fd (if not -1) becomes readable,
+ * or until timeout_ms milliseconds have passed (negative waits forever).
+ * Must only be called from the thread that owns waiter.
+ *
+ * The fd is ignored on Windows.
+ *
+ * Returns true if fd is readable, false otherwise.
+ **/
+ADDAPI bool
+ADDCALL psmove_waiter_wait(PSMoveWaiter *waiter, int fd, int timeout_ms);
+
+/**
+ * Stop the reader thread, wait for it to finish and free all resources.
+ * The HID handle is not closed.
+ **/
+ADDAPI void
+ADDCALL psmove_reader_free(PSMoveReader *reader);
+
+#ifdef __cplusplus
+}
+#endif
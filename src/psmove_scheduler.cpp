@@ -0,0 +1,272 @@
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+//-- includes -----
+#include "psmove_scheduler.h"
+#include "psmove_private.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+//-- definitions -----
+namespace {
+
+struct SchedulerSlot {
+    /* Time at which a keep-alive write is needed (UINT64_MAX: never) */
+    uint64_t keepalive_due_us() const;
+
+    /* Time at which a write is needed (UINT64_MAX: never) */
+    uint64_t due_us() const;
+
+    void *key;
+    uint32_t min_interval_us;
+    uint32_t keepalive_us;
+    bool dirty;
+    uint64_t last_write_us; // 0 = never written
+};
+
+}; // end anonymous namespace
+
+struct _PSMoveScheduler {
+    _PSMoveScheduler(uint32_t spacing_us);
+
+    SchedulerSlot *find(void *key);
+    bool spacing_passed(uint64_t now_us) const;
+    void written(SchedulerSlot *slot, uint64_t now_us);
+
+    std::mutex mutex;
+    std::vector<SchedulerSlot> slots;
+    uint32_t spacing_us;
+    uint64_t last_write_us; // last write of any key
+};
+
+//-- private methods -----
+uint64_t
+SchedulerSlot::keepalive_due_us() const
+{
+    if (keepalive_us == 0) {
+        return UINT64_MAX;
+    }
+
+    return last_write_us + keepalive_us;
+}
+
+uint64_t
+SchedulerSlot::due_us() const
+{
+    uint64_t due = keepalive_due_us();
+
+    if (dirty) {
+        due = std::min(due, last_write_us + min_interval_us);
+    }
+
+    return due;
+}
+
+_PSMoveScheduler::_PSMoveScheduler(uint32_t spacing_us)
+    : mutex()
+    , slots()
+    , spacing_us(spacing_us)
+    , last_write_us(0)
+{
+}
+
+SchedulerSlot *
+_PSMoveScheduler::find(void *key)
+{
+    for (auto &slot: slots) {
+        if (slot.key == key) {
+            return &slot;
+        }
+    }
+
+    return nullptr;
+}
+
+bool
+_PSMoveScheduler::spacing_passed(uint64_t now_us) const
+{
+    return (last_write_us == 0 || now_us >= last_write_us + spacing_us);
+}
+
+void
+_PSMoveScheduler::written(SchedulerSlot *slot, uint64_t now_us)
+{
+    slot->dirty = false;
+    slot->last_write_us = now_us;
+    last_write_us = now_us;
+}
+
+//-- public methods -----
+PSMoveScheduler *
+psmove_scheduler_new(uint32_t spacing_us)
+{
+    return new PSMoveScheduler(spacing_us);
+}
+
+void
+psmove_scheduler_add(PSMoveScheduler *scheduler, void *key,
+        uint32_t min_interval_us, uint32_t keepalive_us)
+{
+    psmove_return_if_fail(scheduler != NULL);
+    psmove_return_if_fail(key != NULL);
+
+    std::lock_guard<std::mutex> lock(scheduler->mutex);
+
+    if (scheduler->find(key) != nullptr) {
+        PSMOVE_WARNING("Key already added to scheduler");
+        return;
+    }
+
+    SchedulerSlot slot;
+    slot.key = key;
+    slot.min_interval_us = min_interval_us;
+    slot.keepalive_us = keepalive_us;
+    slot.dirty = false;
+    slot.last_write_us = 0;
+    scheduler->slots.emplace_back(slot);
+}
+
+void
+psmove_scheduler_remove(PSMoveScheduler *scheduler, void *key)
+{
+    psmove_return_if_fail(scheduler != NULL);
+
+    std::lock_guard<std::mutex> lock(scheduler->mutex);
+
+    auto &slots = scheduler->slots;
+    slots.erase(std::remove_if(slots.begin(), slots.end(), [key] (const SchedulerSlot &slot) {
+        return slot.key == key;
+    }), slots.end());
+}
+
+void
+psmove_scheduler_mark_dirty(PSMoveScheduler *scheduler, void *key)
+{
+    psmove_return_if_fail(scheduler != NULL);
+
+    std::lock_guard<std::mutex> lock(scheduler->mutex);
+
+    SchedulerSlot *slot = scheduler->find(key);
+    if (slot != nullptr) {
+        slot->dirty = true;
+    }
+}
+
+void *
+psmove_scheduler_next(PSMoveScheduler *scheduler, uint64_t now_us)
+{
+    psmove_return_val_if_fail(scheduler != NULL, NULL);
+
+    std::lock_guard<std::mutex> lock(scheduler->mutex);
+
+    if (!scheduler->spacing_passed(now_us)) {
+        return NULL;
+    }
+
+    SchedulerSlot *best = nullptr;
+    bool best_keepalive = false;
+    uint64_t best_due = 0;
+
+    for (auto &slot: scheduler->slots) {
+        uint64_t due = slot.due_us();
+        if (due > now_us) {
+            continue;
+        }
+
+        // Missing a keep-alive switches off the LEDs, so these go first
+        bool keepalive = (slot.keepalive_due_us() <= now_us);
+
+        if (best == nullptr || (keepalive && !best_keepalive) ||
+                (keepalive == best_keepalive && due < best_due)) {
+            best = &slot;
+            best_keepalive = keepalive;
+            best_due = due;
+        }
+    }
+
+    if (best == nullptr) {
+        return NULL;
+    }
+
+    scheduler->written(best, now_us);
+
+    return best->key;
+}
+
+bool
+psmove_scheduler_acquire(PSMoveScheduler *scheduler, void *key, uint64_t now_us)
+{
+    psmove_return_val_if_fail(scheduler != NULL, false);
+
+    std::lock_guard<std::mutex> lock(scheduler->mutex);
+
+    if (!scheduler->spacing_passed(now_us)) {
+        return false;
+    }
+
+    SchedulerSlot *slot = scheduler->find(key);
+    if (slot == nullptr || slot->due_us() > now_us) {
+        return false;
+    }
+
+    scheduler->written(slot, now_us);
+
+    return true;
+}
+
+uint64_t
+psmove_scheduler_get_next_due_us(PSMoveScheduler *scheduler, void *key)
+{
+    psmove_return_val_if_fail(scheduler != NULL, UINT64_MAX);
+
+    std::lock_guard<std::mutex> lock(scheduler->mutex);
+
+    uint64_t next_due = UINT64_MAX;
+    for (auto &slot: scheduler->slots) {
+        if (key == NULL || slot.key == key) {
+            next_due = std::min(next_due, slot.due_us());
+        }
+    }
+
+    if (next_due != UINT64_MAX && scheduler->last_write_us != 0) {
+        next_due = std::max(next_due, scheduler->last_write_us + scheduler->spacing_us);
+    }
+
+    return next_due;
+}
+
+void
+psmove_scheduler_free(PSMoveScheduler *scheduler)
+{
+    psmove_return_if_fail(scheduler != NULL);
+
+    delete scheduler;
+}
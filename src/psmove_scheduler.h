@@ -0,0 +1,127 @@
+#pragma once
+
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//-- includes -----
+#include "psmove.h"
+
+#include <stdint.h>
+
+//-- pre-declarations -----
+struct _PSMoveScheduler;
+typedef struct _PSMoveScheduler PSMoveScheduler;
+
+//-- constants -----
+
+/**
+ * Default minimum time (in microseconds) between two output writes to any
+ * controller. Controllers on the same Bluetooth adapter share its airtime,
+ * and several writes in a row delay the input reports of all of them.
+ **/
+#define PSMOVE_SCHEDULER_DEFAULT_SPACING_US 2000
+
+//-- interface -----
+
+/**
+ * Create a scheduler that coalesces LED/rumble writes of several controllers
+ * and spreads them out so that at most one write is issued every spacing_us
+ * microseconds (0 disables the spacing). All functions are thread-safe.
+ *
+ * Each controller is registered with an opaque key. A key is due for a write
+ * once it has been marked dirty and min_interval_us have passed since its
+ * last write, or when keepalive_us (if not 0) have passed since its last
+ * write, even if it is not dirty. Overdue keep-alives go first, then dirty
+ * keys in the order they became due (earliest deadline first).
+ **/
+ADDAPI PSMoveScheduler *
+ADDCALL psmove_scheduler_new(uint32_t spacing_us);
+
+/**
+ * Register key. If keepalive_us is not 0, the key is due for a write right
+ * away, otherwise it is due once it has been marked dirty.
+ **/
+ADDAPI void
+ADDCALL psmove_scheduler_add(PSMoveScheduler *scheduler, void *key,
+        uint32_t min_interval_us, uint32_t keepalive_us);
+
+/**
+ * Unregister key; it will not be returned by the scheduler anymore.
+ **/
+ADDAPI void
+ADDCALL psmove_scheduler_remove(PSMoveScheduler *scheduler, void *key);
+
+/**
+ * Mark key as having new output values that need to be written.
+ **/
+ADDAPI void
+ADDCALL psmove_scheduler_mark_dirty(PSMoveScheduler *scheduler, void *key);
+
+/**
+ * Return the most urgent key that is due for a write at now_us, or NULL if
+ * no key is due or the spacing since the last write has not passed yet.
+ * The returned key is considered written (the caller must write it now).
+ *
+ * Call this repeatedly from a single thread that owns all devices.
+ **/
+ADDAPI void *
+ADDCALL psmove_scheduler_next(PSMoveScheduler *scheduler, uint64_t now_us);
+
+/**
+ * Return true if key is due for a write at now_us and the spacing since
+ * the last write has passed. The key is then considered written (the
+ * caller must write it now).
+ *
+ * Use this when each device is written by its own thread.
+ **/
+ADDAPI bool
+ADDCALL psmove_scheduler_acquire(PSMoveScheduler *scheduler, void *key, uint64_t now_us);
+
+/**
+ * Earliest time (in microseconds, same clock as now_us) at which a write
+ * of key (or of any key, if key is NULL) can be due, or UINT64_MAX if
+ * nothing is scheduled. Can be used to limit how long to sleep before
+ * asking the scheduler again.
+ **/
+ADDAPI uint64_t
+ADDCALL psmove_scheduler_get_next_due_us(PSMoveScheduler *scheduler, void *key);
+
+/**
+ * Free the scheduler.
+ **/
+ADDAPI void
+ADDCALL psmove_scheduler_free(PSMoveScheduler *scheduler);
+
+#ifdef __cplusplus
+}
+#endif
@@ -32,23 +32,81 @@
 
 #include "psmove_port.h"
 #include "psmove_private.h"
+#include "psmove_reader.h"
+#include "psmove_scheduler.h"
 #include "daemon/moved_monitor.h"
 
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <string>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+
+/* Maximum time (in milliseconds) to block if hotplug events can't be waited for */
+#define PSMOVEAPI_MAX_MONITOR_WAIT_MS 250
+
+/* Maximum time (in milliseconds) an I/O thread waits for input before writing outputs */
+#define PSMOVEAPI_IO_WAIT_MS 20
 
 namespace {
 
+struct PSMoveAPI;
+
+// Jobs posted to a strand are run one after the other, in order, but
+// jobs of different strands can run concurrently on different workers
+struct Strand {
+    Strand() : mutex(), jobs(), scheduled(false) {}
+
+    std::mutex mutex;
+    std::deque<std::function<void()>> jobs;
+    bool scheduled;
+};
+
+// Runs callback jobs on a pool of worker threads, or (with zero
+// workers) queues them until run_pending() is called by the owner
+struct Dispatcher {
+    Dispatcher(int num_threads);
+    ~Dispatcher();
+
+    Dispatcher(const Dispatcher &other) = delete;
+    Dispatcher &operator=(const Dispatcher &other) = delete;
+
+    void post(Strand &strand, std::function<void()> job);
+    void schedule(Strand *strand);
+    void run_pending();
+    bool wait_pending(int fd, int timeout_ms);
+
+    void worker_main();
+    void run_strand(Strand *strand);
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<Strand *> ready;
+    std::vector<std::thread> workers;
+    PSMoveWaiter *waiter; // thread blocked in wait_pending(), if any
+    bool running;
+};
+
 struct ControllerGlue {
     ControllerGlue(int index, const std::string &serial);
     ~ControllerGlue();
 
     void add_handle(PSMove *handle);
     void update_connection_flags();
+    void apply_connection_flags(bool usb, bool bluetooth);
+
+    void start_io(PSMoveAPI *api);
+    void stop_io();
+    void io_main(PSMoveAPI *api);
 
     ControllerGlue(const ControllerGlue &other) = delete;
     Controller &operator=(const ControllerGlue &other) = delete;
@@ -62,13 +120,32 @@ struct ControllerGlue {
     struct Controller controller;
     bool connected;
     bool api_connected;
+
+    // Threaded mode only
+    bool posted_usb; // connection flags last posted to the callbacks
+    bool posted_bluetooth;
+    Strand strand;
+    std::thread io_thread;
+    std::atomic<bool> io_running;
+    std::mutex output_mutex; // protects output_color and output_rumble
+    struct RGB output_color;
+    float output_rumble;
 };
 
 struct PSMoveAPI {
-    PSMoveAPI(EventReceiver *receiver, void *user_data);
+    PSMoveAPI(EventReceiver *receiver, void *user_data, const PSMoveAPISettings *settings);
     ~PSMoveAPI();
 
     void update();
+    bool wait(int timeout_ms);
+
+    void post_update(ControllerGlue *c, const Controller *input);
+    void post_connection_change(ControllerGlue *c);
+
+    void add_controller(ControllerGlue *c);
+    void stage_output(ControllerGlue *c, PSMove *move, const RGB &color, float rumble);
+    void write_outputs();
+    int limit_wait(ControllerGlue *c, int timeout_ms);
 
     static void on_monitor_event(enum MonitorEvent event, enum MonitorEventDeviceType device_type, const char *path, const wchar_t *serial, unsigned short pid, void *user_data);
 
@@ -76,6 +153,9 @@ struct PSMoveAPI {
     void *user_data;
     std::vector<ControllerGlue *> controllers;
     moved_monitor *monitor;
+    Dispatcher *dispatcher; // only in threaded mode
+    PSMoveScheduler *scheduler; // spreads out LED/rumble writes
+    uint32_t spacing_us; // minimum time between two writes (0 = no spacing)
 };
 
 PSMoveAPI *
@@ -94,8 +174,287 @@ device_paths_equal(const char *left, const char *right)
 #endif
 }
 
+// Read the input state of the current report of move into controller
+void
+read_input(Controller &controller, PSMove *move)
+{
+    int previous = controller.buttons;
+    controller.buttons = psmove_get_buttons(move);
+    controller.pressed = controller.buttons & ~previous;
+    controller.released = previous & ~controller.buttons;
+    controller.trigger = float(psmove_get_trigger(move)) / 255.f;
+
+    psmove_get_accelerometer_frame(move, Frame_SecondHalf,
+            &controller.accelerometer.x,
+            &controller.accelerometer.y,
+            &controller.accelerometer.z);
+    psmove_get_gyroscope_frame(move, Frame_SecondHalf,
+            &controller.gyroscope.x,
+            &controller.gyroscope.y,
+            &controller.gyroscope.z);
+    psmove_get_magnetometer_vector(move,
+            &controller.magnetometer.x,
+            &controller.magnetometer.y,
+            &controller.magnetometer.z);
+    controller.battery = psmove_get_battery(move);
+}
+
+// Copy the fields filled by read_input() from input to controller
+void
+copy_input(Controller &controller, const Controller &input)
+{
+    controller.buttons = input.buttons;
+    controller.pressed = input.pressed;
+    controller.released = input.released;
+    controller.trigger = input.trigger;
+    controller.accelerometer = input.accelerometer;
+    controller.gyroscope = input.gyroscope;
+    controller.magnetometer = input.magnetometer;
+    controller.battery = input.battery;
+}
+
+uint32_t
+output_spacing_us(const PSMoveAPISettings *settings)
+{
+    if (settings == nullptr || settings->output_spacing_us == 0) {
+        return PSMOVE_SCHEDULER_DEFAULT_SPACING_US;
+    } else if (settings->output_spacing_us < 0) {
+        return 0;
+    }
+
+    return settings->output_spacing_us;
+}
+
+std::vector<std::string>
+replay_filenames()
+{
+#ifdef _WIN32
+    const char separator = ';';
+#else
+    const char separator = ':';
+#endif
+
+    std::vector<std::string> result;
+
+    const char *env = getenv(PSMOVEAPI_REPLAY_ENV);
+    if (env == nullptr) {
+        return result;
+    }
+
+    std::string filenames(env);
+    size_t start = 0;
+    while (start <= filenames.size()) {
+        size_t end = filenames.find(separator, start);
+        if (end == std::string::npos) {
+            end = filenames.size();
+        }
+
+        if (end > start) {
+            result.emplace_back(filenames.substr(start, end - start));
+        }
+
+        start = end + 1;
+    }
+
+    return result;
+}
+
+float
+replay_speed()
+{
+    int speed = psmove_util_get_env_int(PSMOVEAPI_REPLAY_SPEED_ENV);
+    return (speed < 0) ? 1.f : (float)speed;
+}
+
 }; // end anonymous namespace
 
+Dispatcher::Dispatcher(int num_threads)
+    : mutex()
+    , cond()
+    , ready()
+    , workers()
+    , waiter(nullptr)
+    , running(true)
+{
+    for (int i=0; i<num_threads; i++) {
+        workers.emplace_back(&Dispatcher::worker_main, this);
+    }
+}
+
+Dispatcher::~Dispatcher()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    cond.notify_all();
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    // Deliver whatever is still queued (e.g. no workers, or posted late)
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ready.empty()) {
+                break;
+            }
+        }
+
+        run_pending();
+    }
+}
+
+void
+Dispatcher::post(Strand &strand, std::function<void()> job)
+{
+    bool schedule = false;
+
+    {
+        std::lock_guard<std::mutex> lock(strand.mutex);
+        strand.jobs.emplace_back(std::move(job));
+        if (!strand.scheduled) {
+            strand.scheduled = true;
+            schedule = true;
+        }
+    }
+
+    if (schedule) {
+        this->schedule(&strand);
+    }
+}
+
+void
+Dispatcher::schedule(Strand *strand)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.emplace_back(strand);
+        if (waiter != nullptr) {
+            psmove_waiter_signal(waiter);
+        }
+    }
+    cond.notify_one();
+}
+
+void
+Dispatcher::run_pending()
+{
+    std::deque<Strand *> strands;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        strands.swap(ready);
+    }
+
+    for (auto &strand: strands) {
+        run_strand(strand);
+    }
+}
+
+bool
+Dispatcher::wait_pending(int fd, int timeout_ms)
+{
+    PSMoveWaiter *self = psmove_waiter_get_current();
+    uint64_t deadline = psmove_port_get_time_ms() + (timeout_ms > 0 ? timeout_ms : 0);
+    bool result = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        waiter = self;
+    }
+
+    while (true) {
+        // Reset before checking, so that no strand scheduled after the check is missed
+        psmove_waiter_reset(self);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!ready.empty()) {
+                result = true;
+                break;
+            }
+        }
+
+        int remaining = -1;
+        if (timeout_ms >= 0) {
+            uint64_t now = psmove_port_get_time_ms();
+            if (now >= deadline) {
+                break;
+            }
+            remaining = (int)(deadline - now);
+        }
+
+        if (psmove_waiter_wait(self, fd, remaining)) {
+            // Hotplug event
+            result = true;
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        waiter = nullptr;
+    }
+
+    return result;
+}
+
+void
+Dispatcher::worker_main()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        cond.wait(lock, [this] () { return !running || !ready.empty(); });
+
+        if (ready.empty()) {
+            // Not running anymore, and nothing left to do
+            break;
+        }
+
+        Strand *strand = ready.front();
+        ready.pop_front();
+
+        lock.unlock();
+        run_strand(strand);
+        lock.lock();
+    }
+}
+
+void
+Dispatcher::run_strand(Strand *strand)
+{
+    std::deque<std::function<void()>> jobs;
+
+    {
+        std::lock_guard<std::mutex> lock(strand->mutex);
+        jobs.swap(strand->jobs);
+    }
+
+    // Only run the jobs that were queued so far, so that a busy
+    // controller can't keep a worker (or the caller) to itself
+    for (auto &job: jobs) {
+        job();
+    }
+
+    bool reschedule = false;
+
+    {
+        std::lock_guard<std::mutex> lock(strand->mutex);
+        if (strand->jobs.empty()) {
+            strand->scheduled = false;
+        } else {
+            reschedule = true;
+        }
+    }
+
+    if (reschedule) {
+        schedule(strand);
+    }
+}
+
 ControllerGlue::ControllerGlue(int index, const std::string &serial)
     : move_bluetooth(nullptr)
     , move_usb(nullptr)
@@ -103,6 +462,14 @@ ControllerGlue::ControllerGlue(int index, const std::string &serial)
     , controller()
     , connected(false)
     , api_connected(false)
+    , posted_usb(false)
+    , posted_bluetooth(false)
+    , strand()
+    , io_thread()
+    , io_running(false)
+    , output_mutex()
+    , output_color()
+    , output_rumble(0.f)
 {
     memset(&controller, 0, sizeof(controller));
     controller.index = index;
@@ -132,18 +499,94 @@ ControllerGlue::add_handle(PSMove *handle)
 void
 ControllerGlue::update_connection_flags()
 {
-    controller.usb = (move_usb != nullptr);
-    controller.bluetooth = (move_bluetooth != nullptr);
+    connected = (move_usb != nullptr || move_bluetooth != nullptr);
+}
+
+void
+ControllerGlue::apply_connection_flags(bool usb, bool bluetooth)
+{
+    controller.usb = usb;
+    controller.bluetooth = bluetooth;
 
     if (controller.usb && !controller.bluetooth) {
         controller.battery = Batt_CHARGING;
     }
+}
+
+void
+ControllerGlue::start_io(PSMoveAPI *api)
+{
+    if (io_thread.joinable()) {
+        return;
+    }
 
-    connected = (controller.usb || controller.bluetooth);
+    io_running = true;
+    io_thread = std::thread(&ControllerGlue::io_main, this, api);
+}
+
+void
+ControllerGlue::stop_io()
+{
+    if (!io_thread.joinable()) {
+        return;
+    }
+
+    io_running = false;
+    io_thread.join();
+}
+
+void
+ControllerGlue::io_main(PSMoveAPI *api)
+{
+    // The handles don't change while this thread runs (see stop_io())
+    PSMove *read = read_move();
+    PSMove *write = write_move();
+
+    // Input state as seen by this thread, posted to the callbacks
+    Controller input;
+    memset(&input, 0, sizeof(input));
+
+    while (io_running) {
+        int timeout_ms = api->limit_wait(this, PSMOVEAPI_IO_WAIT_MS);
+
+        if (read != nullptr) {
+            psmove_wait_any(&read, 1, timeout_ms);
+
+            while (psmove_poll(read)) {
+                read_input(input, read);
+                api->post_update(this, &input);
+            }
+        } else {
+            // No handle that supports reading (USB-only connection); still
+            // call update regularly, so that LED and rumble can be changed
+            psmove_port_sleep_ms(timeout_ms);
+            api->post_update(this, nullptr);
+        }
+
+        if (write != nullptr) {
+            RGB color;
+            float rumble;
+
+            {
+                std::lock_guard<std::mutex> lock(output_mutex);
+                color = output_color;
+                rumble = output_rumble;
+            }
+
+            api->stage_output(this, write, color, rumble);
+
+            // Other controllers' threads compete for the same write slots
+            if (psmove_scheduler_acquire(api->scheduler, this, psmove_port_get_time_us())) {
+                _psmove_flush_leds(write);
+            }
+        }
+    }
 }
 
 ControllerGlue::~ControllerGlue()
 {
+    stop_io();
+
     if (move_bluetooth != nullptr) {
         psmove_disconnect(move_bluetooth);
     }
@@ -152,11 +595,14 @@ ControllerGlue::~ControllerGlue()
     }
 }
 
-PSMoveAPI::PSMoveAPI(EventReceiver *receiver, void *user_data)
+PSMoveAPI::PSMoveAPI(EventReceiver *receiver, void *user_data, const PSMoveAPISettings *settings)
     : receiver(receiver)
     , user_data(user_data)
     , controllers()
     , monitor(nullptr)
+    , dispatcher(nullptr)
+    , scheduler(psmove_scheduler_new(output_spacing_us(settings)))
+    , spacing_us(output_spacing_us(settings))
 {
     std::map<std::string, std::vector<PSMove *>> moves;
 
@@ -180,22 +626,50 @@ PSMoveAPI::PSMoveAPI(EventReceiver *receiver, void *user_data)
         moves[serial].emplace_back(move);
     }
 
+    for (auto &filename: replay_filenames()) {
+        PSMove *move = psmove_connect_replay(filename.c_str(), replay_speed());
+        if (!move) {
+            PSMOVE_WARNING("Failed to replay capture %s", filename.c_str());
+            continue;
+        }
+
+        char *tmp = psmove_get_serial(move);
+        std::string serial(tmp ? tmp : filename);
+        psmove_free_mem(tmp);
+
+        moves[serial].emplace_back(move);
+    }
+
     int i = 0;
     for (auto &kv: moves) {
         auto c = new ControllerGlue(i++, kv.first);
         for (auto &handle: kv.second) {
             c->add_handle(handle);
         }
-        controllers.emplace_back(c);
+        add_controller(c);
     }
 
     monitor = moved_monitor_new(PSMoveAPI::on_monitor_event, this);
+
+    if (settings != nullptr && settings->threaded) {
+        dispatcher = new Dispatcher(settings->callback_threads > 0 ? settings->callback_threads : 0);
+    }
 }
 
 PSMoveAPI::~PSMoveAPI()
 {
     moved_monitor_free(monitor);
 
+    if (dispatcher != nullptr) {
+        for (auto &c: controllers) {
+            c->stop_io();
+        }
+
+        // Delivers all callbacks that are still queued
+        delete dispatcher;
+        dispatcher = nullptr;
+    }
+
     for (auto &c: controllers) {
         if (c->api_connected) {
             if (receiver->disconnect != nullptr) {
@@ -208,6 +682,142 @@ PSMoveAPI::~PSMoveAPI()
 
         delete c;
     }
+
+    psmove_scheduler_free(scheduler);
+}
+
+void
+PSMoveAPI::post_update(ControllerGlue *c, const Controller *input)
+{
+    bool have_input = (input != nullptr);
+    Controller copy = Controller();
+
+    if (have_input) {
+        copy = *input;
+    }
+
+    dispatcher->post(c->strand, [this, c, have_input, copy] () {
+        if (have_input) {
+            copy_input(c->controller, copy);
+        }
+
+        if (receiver->update != nullptr) {
+            receiver->update(&c->controller, user_data);
+        }
+
+        std::lock_guard<std::mutex> lock(c->output_mutex);
+        c->output_color = c->controller.color;
+        c->output_rumble = c->controller.rumble;
+    });
+}
+
+void
+PSMoveAPI::post_connection_change(ControllerGlue *c)
+{
+    bool usb = (c->move_usb != nullptr);
+    bool bluetooth = (c->move_bluetooth != nullptr);
+    bool connect = (c->connected && !c->api_connected);
+    bool disconnect = (!c->connected && c->api_connected);
+
+    dispatcher->post(c->strand, [this, c, usb, bluetooth, connect, disconnect] () {
+        c->apply_connection_flags(usb, bluetooth);
+
+        if (connect && receiver->connect != nullptr) {
+            // Send initial connect event
+            receiver->connect(&c->controller, user_data);
+        }
+
+        if (disconnect && receiver->disconnect != nullptr) {
+            // Send disconnect event
+            receiver->disconnect(&c->controller, user_data);
+        }
+
+        std::lock_guard<std::mutex> lock(c->output_mutex);
+        c->output_color = c->controller.color;
+        c->output_rumble = c->controller.rumble;
+    });
+
+    c->posted_usb = usb;
+    c->posted_bluetooth = bluetooth;
+    c->api_connected = c->connected;
+}
+
+void
+PSMoveAPI::add_controller(ControllerGlue *c)
+{
+    // Keep-alive writes stop the controller from switching off LEDs and rumble
+    psmove_scheduler_add(scheduler, c, 0, PSMOVE_MAX_LED_INHIBIT_MS * 1000);
+    controllers.emplace_back(c);
+}
+
+void
+PSMoveAPI::stage_output(ControllerGlue *c, PSMove *move, const RGB &color, float rumble)
+{
+    psmove_set_leds(move,
+            uint32_t(255 * color.r),
+            uint32_t(255 * color.g),
+            uint32_t(255 * color.b));
+    psmove_set_rumble(move, uint32_t(255 * rumble));
+
+    if (_psmove_get_leds_dirty(move)) {
+        psmove_scheduler_mark_dirty(scheduler, c);
+    }
+}
+
+void
+PSMoveAPI::write_outputs()
+{
+    // Send all pending writes, waiting out the scheduler spacing between
+    // them instead of sending them in a burst. Each controller is written at
+    // most once, so this takes at most (number of controllers) * spacing.
+    uint64_t now_us = psmove_port_get_time_us();
+    for (size_t i=0; i<controllers.size(); i++) {
+        void *key = psmove_scheduler_next(scheduler, now_us);
+        if (key == nullptr) {
+            // Only wait out the spacing, not for writes that are due later
+            uint64_t due_us = psmove_scheduler_get_next_due_us(scheduler, nullptr);
+            if (due_us == UINT64_MAX || due_us > now_us + spacing_us) {
+                break;
+            }
+
+            if (due_us > now_us) {
+                psmove_port_sleep_ms(uint32_t((due_us - now_us + 999) / 1000));
+            }
+
+            now_us = psmove_port_get_time_us();
+            key = psmove_scheduler_next(scheduler, now_us);
+            if (key == nullptr) {
+                break;
+            }
+        }
+
+        auto c = static_cast<ControllerGlue *>(key);
+        auto write_move = c->write_move();
+        if (c->connected && write_move != nullptr) {
+            _psmove_flush_leds(write_move);
+        }
+
+        now_us = psmove_port_get_time_us();
+    }
+}
+
+int
+PSMoveAPI::limit_wait(ControllerGlue *c, int timeout_ms)
+{
+    // Don't sleep past the time at which the next output write is due
+    uint64_t due_us = psmove_scheduler_get_next_due_us(scheduler, c);
+    if (due_us == UINT64_MAX) {
+        return timeout_ms;
+    }
+
+    uint64_t now_us = psmove_port_get_time_us();
+    uint64_t due_ms = (due_us > now_us) ? (due_us - now_us + 999) / 1000 : 0;
+
+    if (timeout_ms < 0 || due_ms < uint64_t(timeout_ms)) {
+        return int(std::min(due_ms, uint64_t(INT_MAX)));
+    }
+
+    return timeout_ms;
 }
 
 void
@@ -220,6 +830,24 @@ PSMoveAPI::update()
     for (auto &c: controllers) {
         c->update_connection_flags();
 
+        if (dispatcher != nullptr) {
+            // Threaded mode: Only handle connection changes here, I/O and
+            // callbacks are done by the controller's thread and the dispatcher
+            if (c->connected != c->api_connected ||
+                    (c->move_usb != nullptr) != c->posted_usb ||
+                    (c->move_bluetooth != nullptr) != c->posted_bluetooth) {
+                post_connection_change(c);
+            }
+
+            if (c->connected) {
+                c->start_io(this);
+            }
+
+            continue;
+        }
+
+        c->apply_connection_flags(c->move_usb != nullptr, c->move_bluetooth != nullptr);
+
         if (c->connected && !c->api_connected) {
             if (receiver->connect != nullptr) {
                 // Send initial connect event
@@ -252,26 +880,7 @@ PSMoveAPI::update()
         } else {
             while (psmove_poll(read_move)) {
                 if (receiver->update != nullptr) {
-                    int previous = c->controller.buttons;
-                    c->controller.buttons = psmove_get_buttons(read_move);
-                    c->controller.pressed = c->controller.buttons & ~previous;
-                    c->controller.released = previous & ~c->controller.buttons;
-                    c->controller.trigger = float(psmove_get_trigger(read_move)) / 255.f;
-
-                    psmove_get_accelerometer_frame(read_move, Frame_SecondHalf,
-                            &c->controller.accelerometer.x,
-                            &c->controller.accelerometer.y,
-                            &c->controller.accelerometer.z);
-                    psmove_get_gyroscope_frame(read_move, Frame_SecondHalf,
-                            &c->controller.gyroscope.x,
-                            &c->controller.gyroscope.y,
-                            &c->controller.gyroscope.z);
-                    psmove_get_magnetometer_vector(read_move,
-                            &c->controller.magnetometer.x,
-                            &c->controller.magnetometer.y,
-                            &c->controller.magnetometer.z);
-                    c->controller.battery = psmove_get_battery(read_move);
-
+                    read_input(c->controller, read_move);
                     receiver->update(&c->controller, user_data);
                 }
             }
@@ -279,14 +888,61 @@ PSMoveAPI::update()
 
         auto write_move = c->write_move();
         if (write_move != nullptr) {
-            psmove_set_leds(write_move,
-                    uint32_t(255 * c->controller.color.r),
-                    uint32_t(255 * c->controller.color.g),
-                    uint32_t(255 * c->controller.color.b));
-            psmove_set_rumble(write_move, uint32_t(255 * c->controller.rumble));
-            psmove_update_leds(write_move);
+            stage_output(c, write_move, c->controller.color, c->controller.rumble);
         }
     }
+
+    if (dispatcher == nullptr) {
+        write_outputs();
+    }
+
+    if (dispatcher != nullptr && dispatcher->workers.empty()) {
+        // No callback threads, deliver the queued callbacks on this thread
+        dispatcher->run_pending();
+    }
+}
+
+bool
+PSMoveAPI::wait(int timeout_ms)
+{
+    int fd = moved_monitor_get_fd(monitor);
+    if (fd == -1) {
+        // No pollable hotplug notifications on this platform, check now
+        // and make sure we come back regularly to check again
+        if (moved_monitor_wait(monitor, false)) {
+            return true;
+        }
+
+        if (timeout_ms < 0 || timeout_ms > PSMOVEAPI_MAX_MONITOR_WAIT_MS) {
+            timeout_ms = PSMOVEAPI_MAX_MONITOR_WAIT_MS;
+        }
+    }
+
+    if (dispatcher != nullptr) {
+        // Controller data is read by the I/O threads, so only wait for
+        // queued callbacks (if they are delivered on this thread) and
+        // for hotplug events
+        if (dispatcher->workers.empty()) {
+            return dispatcher->wait_pending(fd, timeout_ms);
+        }
+
+        PSMoveWaiter *self = psmove_waiter_get_current();
+        psmove_waiter_reset(self);
+        return psmove_waiter_wait(self, fd, timeout_ms);
+    }
+
+    std::vector<PSMove *> moves;
+    for (auto &c: controllers) {
+        auto read_move = c->read_move();
+        if (read_move != nullptr) {
+            moves.emplace_back(read_move);
+        }
+    }
+
+    // Come back in time for LED/rumble writes, they are done in update()
+    timeout_ms = limit_wait(nullptr, timeout_ms);
+
+    return _psmove_wait_any_fd(moves.data(), moves.size(), fd, timeout_ms);
 }
 
 void
@@ -319,6 +975,8 @@ PSMoveAPI::on_monitor_event(enum MonitorEvent event, enum MonitorEventDeviceType
                 bool found = false;
                 for (auto &c: self->controllers) {
                     if (strcmp(c->serial.c_str(), serial_number) == 0) {
+                        // The I/O thread (if any) is restarted in update()
+                        c->stop_io();
                         c->add_handle(move);
                         found = true;
                         break;
@@ -328,7 +986,7 @@ PSMoveAPI::on_monitor_event(enum MonitorEvent event, enum MonitorEventDeviceType
                 if (!found) {
                     auto c = new ControllerGlue(self->controllers.size(), std::string(serial_number));
                     c->add_handle(move);
-                    self->controllers.emplace_back(c);
+                    self->add_controller(c);
                 }
 
                 psmove_free_mem(serial_number);
@@ -344,6 +1002,7 @@ PSMoveAPI::on_monitor_event(enum MonitorEvent event, enum MonitorEventDeviceType
                     if (c->move_bluetooth != nullptr) {
                         const char *devpath = _psmove_get_device_path(c->move_bluetooth);
                         if (device_paths_equal(devpath, path)) {
+                            c->stop_io();
                             psmove_disconnect(c->move_bluetooth), c->move_bluetooth = nullptr;
                             found = true;
                             break;
@@ -353,6 +1012,7 @@ PSMoveAPI::on_monitor_event(enum MonitorEvent event, enum MonitorEventDeviceType
                     if (c->move_usb != nullptr) {
                         const char *devpath = _psmove_get_device_path(c->move_usb);
                         if (device_paths_equal(devpath, path)) {
+                            c->stop_io();
                             psmove_disconnect(c->move_usb), c->move_usb = nullptr;
                             found = true;
                             break;
@@ -374,9 +1034,15 @@ PSMoveAPI::on_monitor_event(enum MonitorEvent event, enum MonitorEventDeviceType
 
 void
 psmoveapi_init(EventReceiver *receiver, void *user_data)
+{
+    psmoveapi_init_with_settings(receiver, user_data, nullptr);
+}
+
+void
+psmoveapi_init_with_settings(EventReceiver *receiver, void *user_data, const PSMoveAPISettings *settings)
 {
     if (g_psmove_api == nullptr) {
-        g_psmove_api = new PSMoveAPI(receiver, user_data);
+        g_psmove_api = new PSMoveAPI(receiver, user_data, settings);
     }
 }
 
@@ -388,6 +1054,16 @@ psmoveapi_update()
     }
 }
 
+bool
+psmoveapi_wait(int timeout_ms)
+{
+    if (g_psmove_api != nullptr) {
+        return g_psmove_api->wait(timeout_ms);
+    }
+
+    return false;
+}
+
 void
 psmoveapi_quit()
 {
@@ -53,6 +53,10 @@ struct _PSMoveFusion {
     glm::vec4 viewport;
 };
 
+static void
+psmove_fusion_camera_to_world(PSMoveFusion *fusion, float camX, float camY, float camR,
+        float *x, float *y, float *z);
+
 
 PSMoveFusion *
 psmove_fusion_new(PSMoveTracker *tracker, float z_near, float z_far)
@@ -101,6 +105,25 @@ psmove_fusion_get_modelview_matrix(PSMoveFusion *fusion, PSMove *move)
     return glm::value_ptr(fusion->modelview);
 }
 
+float *
+psmove_fusion_get_predicted_modelview_matrix(PSMoveFusion *fusion, PSMove *move,
+        uint64_t time_us)
+{
+    psmove_return_val_if_fail(fusion != NULL, NULL);
+    psmove_return_val_if_fail(move != NULL, NULL);
+
+    float w, x, y, z;
+    psmove_get_predicted_orientation(move, time_us, &w, &x, &y, &z);
+    glm::quat quaternion(w, x, y, z);
+
+    psmove_fusion_get_predicted_position(fusion, move, time_us, &x, &y, &z);
+
+    fusion->modelview = glm::translate(glm::mat4(1.f),
+            glm::vec3(x, y, z)) * glm::mat4_cast(quaternion);
+
+    return glm::value_ptr(fusion->modelview);
+}
+
 void
 psmove_fusion_get_position(PSMoveFusion *fusion, PSMove *move,
         float *x, float *y, float *z)
@@ -111,6 +134,26 @@ psmove_fusion_get_position(PSMoveFusion *fusion, PSMove *move,
     float camX, camY, camR;
     psmove_tracker_get_position(fusion->tracker, move, &camX, &camY, &camR);
 
+    psmove_fusion_camera_to_world(fusion, camX, camY, camR, x, y, z);
+}
+
+void
+psmove_fusion_get_predicted_position(PSMoveFusion *fusion, PSMove *move,
+        uint64_t time_us, float *x, float *y, float *z)
+{
+    psmove_return_if_fail(fusion != NULL);
+    psmove_return_if_fail(move != NULL);
+
+    float camX, camY, camR;
+    psmove_tracker_get_predicted_position(fusion->tracker, move, time_us, &camX, &camY, &camR);
+
+    psmove_fusion_camera_to_world(fusion, camX, camY, camR, x, y, z);
+}
+
+static void
+psmove_fusion_camera_to_world(PSMoveFusion *fusion, float camX, float camY, float camR,
+        float *x, float *y, float *z)
+{
     float wx = 2.f * (camX - fusion->viewport[0]) / fusion->viewport[2] - 1.f;
     float wy = 2.f * (1.f - (camY - fusion->viewport[1]) / fusion->viewport[3]) - 1.f;
 
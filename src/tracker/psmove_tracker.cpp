@@ -42,6 +42,11 @@
 #include "psmove_tracker.h"
 #include "psmove_tracker_opencv.h"
 #include "psmove_tracker_hue_calibration.h"
+#include "psmove_tracker_blobs.h"
+#include "psmove_tracker_circle.h"
+#include "psmove_tracker_motion.h"
+#include "psmove_tracker_hsv.h"
+#include "psmove_tracker_segmentation.h"
 
 #include "../psmove_private.h"
 #include "../psmove_port.h"
@@ -51,6 +56,15 @@
 #include "tracker_helpers.h"
 
 #define ROIS 4                          // the number of levels of regions of interest (roi)
+#define VELOCITY_WEIGHT 0.5f            // weight of the newest measurement in the smoothed radius velocity
+#define VELOCITY_MAX_GAP_US 250000      // frames further apart than this restart the velocity estimate
+#define SPHERE_RADIUS_M 0.0225f         // radius of the sphere (meters), gives the pixels per meter at its distance
+#define MOTION_ACCELERATION 10.f        // random acceleration of the controller in the motion model (m/s^2)
+#define MOTION_START_VELOCITY 3.f       // expected speed of a controller that was just found (m/s)
+#define MOTION_MEASUREMENT_SIGMA 1.f    // standard deviation of the tracked position (pixels)
+#define MOTION_ROI_RADII 1.2f           // predicted ROIs reach this many radii beyond the predicted position ...
+#define MOTION_ROI_SIGMAS 3.f           // ... plus this many standard deviations of the prediction
+#define STANDARD_GRAVITY 9.81f          // m/s^2 per g, for accelerometer readings
 
 
 /**
@@ -89,6 +103,10 @@ struct _TrackedController {
     float q1, q2, q3; // Calculated quality criteria from the tracker
 
     int is_tracked;				// 1 if tracked 0 otherwise
+    uint64_t position_time_us;	// frame time of the last tracked position, 0 if never tracked
+    float vx, vy, vr;			// velocity of x/y (from the motion model) and smoothed velocity of the radius (in pixels per second)
+    psmove::tracker::MotionModel motion; // constant-velocity model of x/y, predicted up to motion_time_us
+    uint64_t motion_time_us;	// frame time of the motion model state
     long last_color_update;	// the timestamp when the last color adaption has been performed
     bool auto_update_leds;
 };
@@ -172,6 +190,8 @@ struct _PSMoveTracker {
             size *= 0.7f;
         }
 
+        segmentation = new psmove::tracker::Segmentation(cvGetSize(frame));
+
         // prepare structure used for erode and dilate in calibration process
         int ks = 5; // Kernel Size
         int kc = 2; // Kernel Center
@@ -195,6 +215,7 @@ struct _PSMoveTracker {
             cvReleaseImage(&roiM[i]);
             cvReleaseImage(&roiI[i]);
         }
+        delete segmentation;
         cvReleaseStructuringElement(&kCalib);
 
         camera_control_delete(cc);
@@ -208,10 +229,14 @@ struct _PSMoveTracker {
     PSMoveTrackerSettings settings;  // Camera and tracker algorithm settings. Generally do not change after startup & calibration.
 
     IplImage *frame { nullptr }; // the current frame of the camera
+    uint64_t frame_time_us { 0 }; // host time when the current frame was retrieved (psmove_util_get_time_us)
     IplImage *frame_rgb { nullptr }; // the frame as tightly packed RGB data
-    IplImage *roiI[ROIS] {}; // array of images for each level of roi (colored)
+    IplImage *roiI[ROIS] {}; // array of images for each level of roi (colored, only their size is used)
     IplImage *roiM[ROIS] {}; // array of images for each level of roi (greyscale)
     IplConvKernel *kCalib { nullptr }; // kernel used for morphological operations during calibration
+    psmove::tracker::Segmentation *segmentation { nullptr }; // color masks of all controllers for the current frame
+    psmove::tracker::BlobLabeler blobs; // finds the biggest blob in a ROI mask
+    psmove::tracker::CircleFitter circle_fitter; // fits the sphere outline for CircleEstimator_AlgebraicFit
     CvScalar rHSV; // the range of the color filter
 
     /**
@@ -327,15 +352,54 @@ float psmove_tracker_hsvcolor_diff(TrackedController* tc);
 /*
  * This will estimate the position and the radius of the orb.
  * It will calcualte the radius by findin the two most distant points
- * in the contour. And its by choosing the mid point of those two.
+ * in the outline. And its by choosing the mid point of those two.
  *
- * cont 	- (in) 	The contour representing the orb.
+ * outline 	- (in) 	The outline of the orb (see BlobLabeler::outline()).
  * x            - (out) The X coordinate of the center.
  * y            - (out) The Y coordinate of the center.
- * radius	- (out) The radius of the contour that is calculated here.
+ * radius	- (out) The radius of the outline that is calculated here.
  */
 void
-psmove_tracker_estimate_circle_from_contour(CvSeq* cont, float *x, float *y, float* radius);
+psmove_tracker_estimate_circle_from_outline(const std::vector<CvPoint> &outline, float *x, float *y, float* radius);
+
+/*
+ * Update the motion model and the smoothed radius velocity of a controller
+ * that has just been found in the current frame (for ROI prediction and
+ * psmove_tracker_get_predicted_position).
+ *
+ * tracker  - (in) The PSMoveTracker to use.
+ * tc       - (in) The controller that has been found.
+ * old_r    - (in) The radius before the current frame was processed.
+ */
+static void
+psmove_tracker_update_velocity(PSMoveTracker *tracker, TrackedController *tc, float old_r);
+
+/*
+ * Advance the motion model of a controller to the time of the current frame.
+ *
+ * tracker  - (in) The PSMoveTracker to use.
+ * tc       - (in) The controller to predict.
+ *
+ * Returns nonzero if there is a prediction, zero if the controller has not
+ * been tracked recently enough (the motion model is reset then).
+ */
+static int
+psmove_tracker_predict_motion(PSMoveTracker *tracker, TrackedController *tc);
+
+/*
+ * Place the ROI of a controller that was tracked in the previous frame
+ * around its predicted position in the current frame. The ROI level is the
+ * smallest that holds the sphere at the predicted position and its likely
+ * error (for ROIPrediction_IMUAided, also the distance the measured
+ * acceleration could have moved it since the last frame).
+ *
+ * tracker  - (in) The PSMoveTracker to use.
+ * tc       - (in) The controller whose ROI is placed.
+ *
+ * Returns nonzero if the ROI was placed, zero if there was no prediction.
+ */
+static int
+psmove_tracker_predict_roi(PSMoveTracker *tracker, TrackedController *tc);
 
 /*
  * This function return a optimal ROI center point for a given Tracked controller.
@@ -405,6 +469,10 @@ psmove_tracker_settings_set_default(PSMoveTrackerSettings *settings)
     settings->tracker_adaptive_z = 1;
     settings->color_adaption_quality_t = 35.f;
     settings->color_update_rate = 1.f;
+    settings->tracker_shared_segmentation = true;
+    settings->circle_estimator = CircleEstimator_FarthestPair;
+    settings->roi_prediction = ROIPrediction_MotionModel;
+    settings->prediction_horizon_ms = 50.f;
     settings->search_tile_width = 0;
     settings->search_tile_height = 0;
     settings->search_tiles_horizontal = 0;
@@ -1028,6 +1096,11 @@ void psmove_tracker_update_image(PSMoveTracker *tracker) {
     psmove_return_if_fail(tracker != NULL);
 
     tracker->frame = camera_control_query_frame(tracker->cc);
+    tracker->frame_time_us = psmove_util_get_time_us();
+
+    if (tracker->segmentation) {
+        tracker->segmentation->reset();
+    }
 
 #if !defined(CAMERA_CONTROL_USE_PS3EYE_DRIVER) && !defined(__linux)
     // PS3EyeDriver, CLEyeDriver, and v4l support flipping the camera image in
@@ -1041,6 +1114,25 @@ void psmove_tracker_update_image(PSMoveTracker *tracker) {
 #endif
 }
 
+/**
+ * Fill roi_m with the color mask of the controller for its current ROI
+ * (the frame's ROI must already be set to it)
+ **/
+static void
+psmove_tracker_get_roi_mask(PSMoveTracker *tracker, TrackedController *tc,
+        IplImage *roi_m, CvScalar min, CvScalar max)
+{
+    if (tracker->settings.tracker_shared_segmentation && tracker->segmentation) {
+        int slot = (int)(tc - tracker->controllers);
+        tracker->segmentation->set_range(slot, min, max);
+        tracker->segmentation->get_mask(tracker->frame,
+                cvRect(tc->roi_x, tc->roi_y, roi_m->width, roi_m->height), slot, roi_m);
+    } else {
+        // apply color filter (same result as converting to HSV and cvInRangeS())
+        psmove::tracker::hsv_mask(tracker->frame, min, max, roi_m);
+    }
+}
+
 int
 psmove_tracker_update_controller(PSMoveTracker *tracker, TrackedController *tc)
 {
@@ -1048,6 +1140,9 @@ psmove_tracker_update_controller(PSMoveTracker *tracker, TrackedController *tc)
     int i = 0;
     int sphere_found = 0;
 
+    // remember the radius in the previous frame for the velocity estimation
+    float old_r = tc->r;
+
     if (tc->auto_update_leds) {
         unsigned char r, g, b;
         psmove_tracker_get_color(tracker, tc->move, &r, &g, &b);
@@ -1059,6 +1154,12 @@ psmove_tracker_update_controller(PSMoveTracker *tracker, TrackedController *tc)
     CvScalar min = th_scalar_sub(tc->eColorHSV, tracker->rHSV);
     CvScalar max = th_scalar_add(tc->eColorHSV, tracker->rHSV);
 
+    // search where the sphere is expected in this frame
+    int roi_predicted = 0;
+    if (tracker->settings.roi_prediction != ROIPrediction_None) {
+        roi_predicted = psmove_tracker_predict_roi(tracker, tc);
+    }
+
 	// this is the tracking algorithm
 	for (;;) {
 		// get pointers to data structures for the given ROI-Level
@@ -1076,27 +1177,15 @@ psmove_tracker_update_controller(PSMoveTracker *tracker, TrackedController *tc)
 
 		// apply the ROI
 		cvSetImageROI(tracker->frame, cvRect(tc->roi_x, tc->roi_y, roi_i->width, roi_i->height));
-		cvCvtColor(tracker->frame, roi_i, CV_BGR2HSV);
-
-		// apply color filter
-		cvInRangeS(roi_i, min, max, roi_m);
-
-		// find the biggest contour in the image
-		float sizeBest = 0;
-		CvSeq* contourBest = NULL;
-		psmove_tracker_biggest_contour(roi_m, tracker->storage, &contourBest, &sizeBest);
-
-		if (contourBest) {
-			CvMoments mu; // ImageMoments are use to calculate the center of mass of the blob
-			CvRect br = cvBoundingRect(contourBest, 0);
-
-			// restore the biggest contour
-			cvSet(roi_m, TH_COLOR_BLACK, NULL);
-			cvDrawContours(roi_m, contourBest, TH_COLOR_WHITE, TH_COLOR_WHITE, -1, CV_FILLED, 8, cvPoint(0, 0));
-			// calucalte image-moments
-			cvMoments(roi_m, &mu, 0);
-			// calucalte the mass center
-            CvPoint p = cvPoint((int)(mu.m10 / mu.m00), (int)(mu.m01 / mu.m00));
+		psmove_tracker_get_roi_mask(tracker, tc, roi_m, min, max);
+
+		// find the biggest blob in the image (area, bounding box and moments in one scan)
+		psmove::tracker::Blob blob;
+		if (tracker->blobs.find_biggest(roi_m, &blob)) {
+			CvRect br = blob.bounds;
+
+			// the mass center of the blob
+            CvPoint p = cvPoint((int)blob.cx, (int)blob.cy);
             CvPoint oldMCenter = cvPoint((int)tc->mx, (int)tc->my);
 			tc->mx = (float)p.x + tc->roi_x;
 			tc->my = (float)p.y + tc->roi_y;
@@ -1105,7 +1194,15 @@ psmove_tracker_update_controller(PSMoveTracker *tracker, TrackedController *tc)
 			// remember the old radius and calcutlate the new x/y position and radius of the found contour
 			float oldRadius = tc->r;
 			// estimate x/y position and radius of the sphere
-			psmove_tracker_estimate_circle_from_contour(contourBest, &x, &y, &tc->r);
+			psmove::tracker::Circle circle;
+			if (tracker->settings.circle_estimator == CircleEstimator_AlgebraicFit &&
+					tracker->circle_fitter.fit(tracker->blobs.edges(), &circle)) {
+				x = circle.x;
+				y = circle.y;
+				tc->r = circle.radius;
+			} else {
+				psmove_tracker_estimate_circle_from_outline(tracker->blobs.outline(), &x, &y, &tc->r);
+			}
 
 			// apply radius-smoothing if enabled
             if (tracker->settings.tracker_adaptive_z) {
@@ -1136,7 +1233,7 @@ psmove_tracker_update_controller(PSMoveTracker *tracker, TrackedController *tc)
 			}
 
 			// calculate the quality of the tracking
-			int pixelInBlob = cvCountNonZero(roi_m);
+			int pixelInBlob = blob.area;
 			float pixelInResult = (float)(tc->r * tc->r * M_PI);
                         tc->q1 = 0;
                         tc->q2 = FLT_MAX;
@@ -1185,6 +1282,7 @@ psmove_tracker_update_controller(PSMoveTracker *tracker, TrackedController *tc)
                     tc->q3 > tracker->settings.color_update_quality_t3)
                 {
 					// calculate the new estimated color (adaptive color estimation)
+					tracker->blobs.draw(roi_m);
 					CvScalar newColorHSV = th_rgb2hsv(th_bgr2rgb(cvAvg(tracker->frame, roi_m)));
 
                                         tc->eColorHSV = th_scalar_mul(th_scalar_add(tc->eColorHSV, newColorHSV), 0.5);
@@ -1216,7 +1314,6 @@ psmove_tracker_update_controller(PSMoveTracker *tracker, TrackedController *tc)
 				psmove_tracker_set_roi(tracker, tc, (int)(tc->x - roi_i->width / 2), (int)(tc->y - roi_i->height / 2),  roi_i->width, roi_i->height);
 			}
 		}
-		cvClearMemStorage(tracker->storage);
 		cvResetImageROI(tracker->frame);
 
 		if (sphere_found) {
@@ -1241,6 +1338,15 @@ psmove_tracker_update_controller(PSMoveTracker *tracker, TrackedController *tc)
 			int ry;
 			// the sphere could not be found til a reasonable roi-level
 
+			if (roi_predicted) {
+				// it was just lost, start searching in the tile where it was expected
+				int columns = tracker->settings.search_tiles_horizontal;
+				int rows = tracker->settings.search_tiles_count / columns;
+				int column = (int)tc->motion.x.position / tracker->settings.search_tile_width;
+				int row = (int)tc->motion.y.position / tracker->settings.search_tile_height;
+				tc->search_tile = MAX(0, MIN(row, rows - 1)) * columns + MAX(0, MIN(column, columns - 1));
+			}
+
             rx = tracker->settings.search_tile_width * (tc->search_tile %
                 tracker->settings.search_tiles_horizontal);
             ry = tracker->settings.search_tile_height * (int)(tc->search_tile /
@@ -1254,6 +1360,10 @@ psmove_tracker_update_controller(PSMoveTracker *tracker, TrackedController *tc)
 		}
 	}
 
+	if (sphere_found) {
+		psmove_tracker_update_velocity(tracker, tc, old_r);
+	}
+
 	// remember if the sphere was found
 	tc->is_tracked = sphere_found;
 	return sphere_found;
@@ -1268,6 +1378,21 @@ psmove_tracker_update(PSMoveTracker *tracker, PSMove *move)
 
     long started = psmove_util_get_ticks();
 
+    if (tracker->settings.tracker_shared_segmentation) {
+        // Register the color ranges of all controllers up front, so that
+        // each pixel is classified for all of them in a single pass
+        for (int slot=0; slot<PSMOVE_TRACKER_MAX_CONTROLLERS; slot++) {
+            TrackedController *tc = &tracker->controllers[slot];
+            if (tc->move) {
+                tracker->segmentation->set_range(slot,
+                        th_scalar_sub(tc->eColorHSV, tracker->rHSV),
+                        th_scalar_add(tc->eColorHSV, tracker->rHSV));
+            } else {
+                tracker->segmentation->clear_range(slot);
+            }
+        }
+    }
+
     TrackedController *tc;
     for_each_controller(tracker, tc) {
         if (move == NULL || tc->move == move) {
@@ -1307,6 +1432,47 @@ psmove_tracker_get_position(PSMoveTracker *tracker, PSMove *move,
     return 0;
 }
 
+int
+psmove_tracker_get_predicted_position(PSMoveTracker *tracker, PSMove *move,
+        uint64_t time_us, float *x, float *y, float *radius)
+{
+    psmove_return_val_if_fail(tracker != NULL, 0);
+    psmove_return_val_if_fail(move != NULL, 0);
+
+    TrackedController *tc = psmove_tracker_find_controller(tracker, move);
+
+    if (tc) {
+        // constant velocity since the frame of the last tracked position
+        float dt = 0.f;
+        if (tc->position_time_us != 0 && time_us > tc->position_time_us) {
+            dt = MIN((float)(time_us - tc->position_time_us) / 1000000.f,
+                    tracker->settings.prediction_horizon_ms / 1000.f);
+        }
+
+        if (x) {
+            *x = tc->x + tc->vx * dt;
+        }
+        if (y) {
+            *y = tc->y + tc->vy * dt;
+        }
+        if (radius) {
+            *radius = MAX(tc->r + tc->vr * dt, 0.f);
+        }
+
+        return 1;
+    }
+
+    return 0;
+}
+
+uint64_t
+psmove_tracker_get_frame_time_us(PSMoveTracker *tracker)
+{
+    psmove_return_val_if_fail(tracker != NULL, 0);
+
+    return tracker->frame_time_us;
+}
+
 void
 psmove_tracker_get_size(PSMoveTracker *tracker,
         int *width, int *height)
@@ -1543,33 +1709,31 @@ void psmove_tracker_biggest_contour(IplImage* img, CvMemStorage* stor, CvSeq** r
 }
 
 void
-psmove_tracker_estimate_circle_from_contour(CvSeq* cont, float *x, float *y, float* radius)
+psmove_tracker_estimate_circle_from_outline(const std::vector<CvPoint> &outline, float *x, float *y, float* radius)
 {
-    psmove_return_if_fail(cont != NULL);
     psmove_return_if_fail(x != NULL && y != NULL && radius != NULL);
 
     int i, j;
+    int total = (int)outline.size();
     float d = 0;
     float cd = 0;
     CvPoint m1 = cvPoint( 0, 0 );
     CvPoint m2 = cvPoint( 0, 0 );
-    CvPoint * p1;
-    CvPoint * p2;
     int found = 0;
 
-	int step = MAX(1,cont->total/20);
+	int step = MAX(1,total/20);
 
-	// compare every two points of the contour (but not more than 20)
+	// compare every two points of the outline (but not more than 20)
 	// to find the most distant pair
-	for (i = 0; i < cont->total; i += step) {
-		p1 = (CvPoint*) cvGetSeqElem(cont, i);
-		for (j = i + 1; j < cont->total; j += step) {
-			p2 = (CvPoint*) cvGetSeqElem(cont, j);
-			cd = (float)th_dist_squared(*p1,*p2);
+	for (i = 0; i < total; i += step) {
+		const CvPoint &p1 = outline[i];
+		for (j = i + 1; j < total; j += step) {
+			const CvPoint &p2 = outline[j];
+			cd = (float)th_dist_squared(p1,p2);
 			if (cd > d) {
 				d = cd;
-				m1 = *p1;
-				m2 = *p2;
+				m1 = p1;
+				m2 = p2;
                                 found = 1;
 			}
 		}
@@ -1583,6 +1747,93 @@ psmove_tracker_estimate_circle_from_contour(CvSeq* cont, float *x, float *y, flo
 	*radius = (float)sqrt(d) / 2;
 }
 
+void
+psmove_tracker_update_velocity(PSMoveTracker *tracker, TrackedController *tc, float old_r)
+{
+    uint64_t now = tracker->frame_time_us;
+
+    if (now == tc->position_time_us) {
+        // this frame has already been accounted for
+        return;
+    }
+
+    if (psmove_tracker_predict_motion(tracker, tc)) {
+        float dt = (float)(now - tc->position_time_us) / 1000000.f;
+
+        tc->motion.correct(tc->x, tc->y, MOTION_MEASUREMENT_SIGMA);
+        tc->vr += ((tc->r - old_r) / dt - tc->vr) * VELOCITY_WEIGHT;
+    } else {
+        // first position (or tracking was lost for a while), no velocity yet
+        tc->motion.start(tc->x, tc->y, MOTION_MEASUREMENT_SIGMA, MOTION_START_VELOCITY * tc->r / SPHERE_RADIUS_M);
+        tc->motion_time_us = now;
+        tc->vr = 0.f;
+    }
+
+    tc->vx = tc->motion.x.velocity;
+    tc->vy = tc->motion.y.velocity;
+    tc->position_time_us = now;
+}
+
+int
+psmove_tracker_predict_motion(PSMoveTracker *tracker, TrackedController *tc)
+{
+    uint64_t now = tracker->frame_time_us;
+
+    if (!tc->motion.valid || now < tc->position_time_us ||
+            now - tc->position_time_us > VELOCITY_MAX_GAP_US) {
+        tc->motion.reset();
+        return 0;
+    }
+
+    if (now > tc->motion_time_us) {
+        float dt = (float)(now - tc->motion_time_us) / 1000000.f;
+        float pixels_per_meter = tc->r / SPHERE_RADIUS_M;
+
+        tc->motion.predict(dt, MOTION_ACCELERATION * pixels_per_meter);
+        tc->motion_time_us = now;
+    }
+
+    return 1;
+}
+
+int
+psmove_tracker_predict_roi(PSMoveTracker *tracker, TrackedController *tc)
+{
+    if (!tc->is_tracked || !psmove_tracker_predict_motion(tracker, tc)) {
+        return 0;
+    }
+
+    // half the size of the ROI: the sphere, and how far off the prediction it likely is
+    float margin = MOTION_ROI_RADII * tc->r + MOTION_ROI_SIGMAS * tc->motion.position_sigma();
+
+    if (tracker->settings.roi_prediction == ROIPrediction_IMUAided && psmove_has_calibration(tc->move)) {
+        // the reading is gravity plus at least ||a| - 1g| of acceleration in any direction
+        float ax, ay, az;
+        psmove_get_accelerometer_frame(tc->move, Frame_SecondHalf, &ax, &ay, &az);
+
+        float pixels_per_meter = tc->r / SPHERE_RADIUS_M;
+        float acceleration = fabsf(sqrtf(ax * ax + ay * ay + az * az) - 1.f) * STANDARD_GRAVITY * pixels_per_meter;
+        float dt = (float)(tracker->frame_time_us - tc->position_time_us) / 1000000.f;
+        margin += .5f * acceleration * dt * dt;
+    }
+
+    // use the smallest ROI level that is big enough
+    int level = 0;
+    for (int i = 1; i < ROIS; i++) {
+        if (tracker->roiI[i]->width < 2 * margin || tracker->roiI[i]->height < 2 * margin) {
+            break;
+        }
+        level = i;
+    }
+
+    tc->roi_level = level;
+    IplImage *roi_i = tracker->roiI[tc->roi_level];
+    psmove_tracker_set_roi(tracker, tc, (int)(tc->motion.x.position - roi_i->width / 2),
+            (int)(tc->motion.y.position - roi_i->height / 2), roi_i->width, roi_i->height);
+
+    return 1;
+}
+
 int
 psmove_tracker_center_roi_on_controller(TrackedController* tc, PSMoveTracker* tracker, CvPoint *center)
 {
@@ -1598,29 +1849,19 @@ psmove_tracker_center_roi_on_controller(TrackedController* tc, PSMoveTracker* tr
 
 	// cut out the roi!
 	cvSetImageROI(tracker->frame, cvRect(tc->roi_x, tc->roi_y, roi_i->width, roi_i->height));
-	cvCvtColor(tracker->frame, roi_i, CV_BGR2HSV);
-
-	// apply color filter
-	cvInRangeS(roi_i, min, max, roi_m);
+	psmove_tracker_get_roi_mask(tracker, tc, roi_m, min, max);
 	
-	float sizeBest = 0;
-	CvSeq* contourBest = NULL;
-	psmove_tracker_biggest_contour(roi_m, tracker->storage, &contourBest, &sizeBest);
-	if (contourBest) {
-		cvSet(roi_m, TH_COLOR_BLACK, NULL);
-		cvDrawContours(roi_m, contourBest, TH_COLOR_WHITE, TH_COLOR_WHITE, -1, CV_FILLED, 8, cvPoint(0, 0));
-		// calucalte image-moments to estimate the better ROI center
-		CvMoments mu;
-		cvMoments(roi_m, &mu, 0);
-
-        *center = cvPoint((int)(mu.m10 / mu.m00), (int)(mu.m01 / mu.m00));
+	// the mass center of the biggest blob is the better ROI center
+	psmove::tracker::Blob blob;
+	bool found = tracker->blobs.find_biggest(roi_m, &blob);
+	if (found) {
+        *center = cvPoint((int)blob.cx, (int)blob.cy);
 		center->x += tc->roi_x - roi_m->width / 2;
 		center->y += tc->roi_y - roi_m->height / 2;
 	}
-	cvClearMemStorage(tracker->storage);
 	cvResetImageROI(tracker->frame);
 
-        return (contourBest != NULL);
+        return found;
 }
 
 float
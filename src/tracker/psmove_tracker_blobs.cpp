@@ -0,0 +1,414 @@
+/**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+#include <algorithm>
+
+#include <limits.h>
+#include <string.h>
+
+#include "psmove_tracker_blobs.h"
+
+#include "../psmove_private.h"
+
+namespace {
+
+/* Sum of k^2 for k = 0..n */
+inline double
+sum_of_squares(double n)
+{
+    return n * (n + 1.) * (2. * n + 1.) / 6.;
+}
+
+/* First x >= start where row[x] != 0 (or width) */
+inline int
+skip_zero(const uint8_t *row, int x, int width)
+{
+    for (; x + 8 <= width; x += 8) {
+        uint64_t word;
+        memcpy(&word, row + x, sizeof(word));
+        if (word != 0) {
+            break;
+        }
+    }
+
+    while (x < width && row[x] == 0) {
+        x++;
+    }
+
+    return x;
+}
+
+/* First x >= start where row[x] == 0 (or width) */
+inline int
+skip_nonzero(const uint8_t *row, int x, int width)
+{
+    for (; x + 8 <= width; x += 8) {
+        uint64_t word;
+        memcpy(&word, row + x, sizeof(word));
+        if (word != UINT64_MAX) {
+            break;
+        }
+    }
+
+    while (x < width && row[x] != 0) {
+        x++;
+    }
+
+    return x;
+}
+
+} // end anonymous namespace
+
+namespace psmove {
+namespace tracker {
+
+int
+BlobLabeler::find(std::vector<int> &forest, int label)
+{
+    while (forest[label] != label) {
+        // path halving
+        forest[label] = forest[forest[label]];
+        label = forest[label];
+    }
+
+    return label;
+}
+
+void
+BlobLabeler::merge(std::vector<int> &forest, int a, int b)
+{
+    a = find(forest, a);
+    b = find(forest, b);
+
+    // The lower label stays the root
+    if (a < b) {
+        forest[b] = a;
+    } else if (b < a) {
+        forest[a] = b;
+    }
+}
+
+void
+BlobLabeler::Accumulator::add_span(int y, int first, int last, int sign)
+{
+    double n = sign * (last - first + 1);
+    double sum_x = n * (first + last) / 2.;
+
+    area += sign * (last - first + 1);
+    sx += sum_x;
+    sy += n * y;
+    sxx += sign * (sum_of_squares(last) - sum_of_squares(first - 1));
+    sxy += sum_x * y;
+    syy += n * y * y;
+
+    if (sign > 0) {
+        x0 = std::min(x0, first);
+        x1 = std::max(x1, last);
+        y0 = std::min(y0, y);
+        y1 = std::max(y1, y);
+    }
+}
+
+void
+BlobLabeler::find_open_gaps(int label, std::vector<Run> &result)
+{
+    blob_runs.clear();
+    gaps.clear();
+    result.clear();
+
+    for (const auto &run: runs) {
+        if (run.label == label) {
+            blob_runs.push_back(run);
+        }
+    }
+
+    // Gaps between the runs of each row, merged with the gaps of the previous
+    // row they touch (the background is 4-connected); node 0 is the outside
+    gap_parents.assign(1, 0);
+
+    size_t previous_begin = 0;
+    size_t previous_end = 0;
+    int previous_x0 = 0;
+    int previous_x1 = 0;
+
+    size_t i = 0;
+    while (i < blob_runs.size()) {
+        int y = blob_runs[i].y;
+        size_t end = i + 1;
+        while (end < blob_runs.size() && blob_runs[end].y == y) {
+            end++;
+        }
+
+        // Row extents of the blob
+        int x0 = blob_runs[i].x0;
+        int x1 = blob_runs[end - 1].x1;
+
+        size_t begin = gaps.size();
+        size_t previous = previous_begin;
+        for (size_t k=i+1; k<end; k++) {
+            Run gap { y, blob_runs[k - 1].x1 + 1, blob_runs[k].x0 - 1, (int)gap_parents.size() };
+            gap_parents.push_back(gap.label);
+
+            // Open to the row above (outside of the blob there)?
+            if (i == 0 || gap.x0 < previous_x0 || gap.x1 > previous_x1) {
+                merge(gap_parents, gap.label, 0);
+            }
+
+            while (previous < previous_end && gaps[previous].x1 < gap.x0) {
+                previous++;
+            }
+            for (size_t j=previous; j<previous_end && gaps[j].x0 <= gap.x1; j++) {
+                merge(gap_parents, gap.label, gaps[j].label);
+            }
+
+            gaps.push_back(gap);
+        }
+
+        // Gaps of the row above that are open to this row (or below, if it's the last)
+        for (size_t j=previous_begin; j<previous_end; j++) {
+            if (gaps[j].x0 < x0 || gaps[j].x1 > x1) {
+                merge(gap_parents, gaps[j].label, 0);
+            }
+        }
+
+        previous_begin = begin;
+        previous_end = gaps.size();
+        previous_x0 = x0;
+        previous_x1 = x1;
+        i = end;
+    }
+
+    for (size_t j=previous_begin; j<previous_end; j++) {
+        merge(gap_parents, gaps[j].label, 0);
+    }
+
+    for (const auto &gap: gaps) {
+        if (find(gap_parents, gap.label) == 0) {
+            result.push_back(gap);
+        }
+    }
+}
+
+bool
+BlobLabeler::find_biggest(const IplImage *mask, Blob *blob)
+{
+    psmove_return_val_if_fail(mask != NULL, false);
+    psmove_return_val_if_fail(mask->nChannels == 1 && mask->depth == IPL_DEPTH_8U, false);
+    psmove_return_val_if_fail(blob != NULL, false);
+
+    runs.clear();
+    parents.clear();
+    outline_points.clear();
+    open_gaps.clear();
+
+    // Collect the runs of each row, merging them with touching runs of the previous row
+    size_t previous_begin = 0;
+    size_t previous_end = 0;
+    for (int y=0; y<mask->height; y++) {
+        const uint8_t *row = (const uint8_t *)mask->imageData + y * mask->widthStep;
+        size_t begin = runs.size();
+        size_t previous = previous_begin;
+
+        int x = skip_zero(row, 0, mask->width);
+        while (x < mask->width) {
+            int end = skip_nonzero(row, x, mask->width);
+
+            Run run { y, x, end - 1, (int)parents.size() };
+            parents.push_back(run.label);
+
+            while (previous < previous_end && runs[previous].x1 < run.x0 - 1) {
+                previous++;
+            }
+            for (size_t i=previous; i<previous_end && runs[i].x0 <= run.x1 + 1; i++) {
+                merge(parents, run.label, runs[i].label);
+            }
+
+            runs.push_back(run);
+            x = skip_zero(row, end, mask->width);
+        }
+
+        previous_begin = begin;
+        previous_end = runs.size();
+    }
+
+    if (runs.empty()) {
+        return false;
+    }
+
+    // Accumulate the row extents of each blob
+    accumulators.assign(parents.size(), Accumulator { -1, 0, 0, false, 0, INT_MAX, INT_MAX, INT_MIN, INT_MIN, 0., 0., 0., 0., 0. });
+    for (auto &run: runs) {
+        run.label = find(parents, run.label);
+
+        Accumulator &accumulator = accumulators[run.label];
+        if (accumulator.row != run.y) {
+            if (accumulator.row >= 0) {
+                accumulator.add_span(accumulator.row, accumulator.row_x0, accumulator.row_x1, 1);
+            }
+            accumulator.row = run.y;
+            accumulator.row_x0 = run.x0;
+        } else {
+            accumulator.gaps = true;
+        }
+        accumulator.row_x1 = run.x1;
+    }
+
+    candidates.clear();
+    for (size_t label=0; label<accumulators.size(); label++) {
+        Accumulator &accumulator = accumulators[label];
+        if (accumulator.row >= 0) {
+            accumulator.add_span(accumulator.row, accumulator.row_x0, accumulator.row_x1, 1);
+            candidates.push_back((int)label);
+        }
+    }
+
+    // The row extents include concavities of the outline, which only count
+    // if they are enclosed by the blob, so remove the open ones. This can only
+    // make a blob smaller, so blobs that are already too small are skipped.
+    std::sort(candidates.begin(), candidates.end(), [this] (int a, int b) {
+        return (accumulators[a].area > accumulators[b].area ||
+                (accumulators[a].area == accumulators[b].area && a < b));
+    });
+
+    int biggest = -1;
+    for (int label: candidates) {
+        Accumulator &accumulator = accumulators[label];
+        if (biggest != -1 && accumulator.area <= accumulators[biggest].area) {
+            break;
+        }
+
+        candidate_gaps.clear();
+        if (accumulator.gaps) {
+            find_open_gaps(label, candidate_gaps);
+            for (const auto &gap: candidate_gaps) {
+                accumulator.add_span(gap.y, gap.x0, gap.x1, -1);
+            }
+        }
+
+        if (biggest == -1 || accumulator.area > accumulators[biggest].area) {
+            biggest = label;
+            open_gaps.swap(candidate_gaps);
+        }
+    }
+
+    const Accumulator &best = accumulators[biggest];
+    blob->area = best.area;
+    blob->bounds = cvRect(best.x0, best.y0, best.x1 - best.x0 + 1, best.y1 - best.y0 + 1);
+    blob->cx = (float)(best.sx / best.area);
+    blob->cy = (float)(best.sy / best.area);
+    blob->mu20 = (float)(best.sxx - best.sx * best.sx / best.area);
+    blob->mu11 = (float)(best.sxy - best.sx * best.sy / best.area);
+    blob->mu02 = (float)(best.syy - best.sy * best.sy / best.area);
+
+    // Left ends top to bottom, then right ends bottom to top
+    size_t rows = 0;
+    for (const auto &run: runs) {
+        if (run.label == biggest && (rows == 0 || outline_points[rows - 1].y != run.y)) {
+            outline_points.push_back(cvPoint(run.x0, run.y));
+            rows++;
+        }
+    }
+    for (const auto &run: runs) {
+        if (run.label == biggest) {
+            if (outline_points.size() > rows && outline_points.back().y == run.y) {
+                outline_points.back().x = run.x1;
+            } else {
+                outline_points.push_back(cvPoint(run.x1, run.y));
+            }
+        }
+    }
+    std::reverse(outline_points.begin() + rows, outline_points.end());
+
+    return true;
+}
+
+const std::vector<CvPoint2D32f> &
+BlobLabeler::edges()
+{
+    edge_points.clear();
+
+    int rows = (int)outline_points.size() / 2;
+    for (int i=0; i<rows; i++) {
+        float y = (float)outline_points[i].y;
+        int left = outline_points[i].x;
+        int right = outline_points[outline_points.size() - 1 - i].x;
+
+        edge_points.push_back(cvPoint2D32f(left - .5f, y));
+        edge_points.push_back(cvPoint2D32f(right + .5f, y));
+
+        // Top (and bottom) sides of the pixels not covered by the row above (below)
+        for (int neighbor=-1; neighbor<=1; neighbor+=2) {
+            int other = i + neighbor;
+            float edge_y = y + .5f * neighbor;
+
+            if (other < 0 || other >= rows) {
+                for (int x=left; x<=right; x++) {
+                    edge_points.push_back(cvPoint2D32f(x, edge_y));
+                }
+            } else {
+                int other_left = outline_points[other].x;
+                int other_right = outline_points[outline_points.size() - 1 - other].x;
+
+                for (int x=left; x<=std::min(right, other_left - 1); x++) {
+                    edge_points.push_back(cvPoint2D32f(x, edge_y));
+                }
+                for (int x=std::max(left, other_right + 1); x<=right; x++) {
+                    edge_points.push_back(cvPoint2D32f(x, edge_y));
+                }
+            }
+        }
+    }
+
+    return edge_points;
+}
+
+void
+BlobLabeler::draw(IplImage *mask) const
+{
+    psmove_return_if_fail(mask != NULL);
+    psmove_return_if_fail(mask->nChannels == 1 && mask->depth == IPL_DEPTH_8U);
+
+    for (int y=0; y<mask->height; y++) {
+        memset(mask->imageData + y * mask->widthStep, 0, mask->width);
+    }
+
+    size_t rows = outline_points.size() / 2;
+    for (size_t i=0; i<rows; i++) {
+        const CvPoint &left = outline_points[i];
+        const CvPoint &right = outline_points[outline_points.size() - 1 - i];
+        memset(mask->imageData + left.y * mask->widthStep + left.x, 0xFF, right.x - left.x + 1);
+    }
+
+    for (const auto &gap: open_gaps) {
+        memset(mask->imageData + gap.y * mask->widthStep + gap.x0, 0, gap.x1 - gap.x0 + 1);
+    }
+}
+
+} // end namespace tracker
+} // end namespace psmove
@@ -0,0 +1,132 @@
+#pragma once
+
+/**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#include "opencv2/core/core_c.h"
+
+#include <stdint.h>
+#include <vector>
+
+
+namespace psmove {
+namespace tracker {
+
+/**
+ * Statistics of a blob in a mask. Holes enclosed by the blob are filled,
+ * like drawing its outer contour filled, but concavities of the outline
+ * (e.g. where the sphere is partly hidden by a finger) are not.
+ **/
+struct Blob {
+    int area { 0 }; // number of pixels
+    CvRect bounds { 0, 0, 0, 0 }; // bounding box
+    float cx { 0.f }, cy { 0.f }; // center of mass
+    float mu20 { 0.f }, mu11 { 0.f }, mu02 { 0.f }; // central second moments (as in CvMoments)
+};
+
+/**
+ * Connected-component labeling of binary masks (8-connectivity)
+ *
+ * A single scan of the mask collects the runs of nonzero pixels of each row
+ * and merges overlapping runs of consecutive rows with union-find; the blob
+ * statistics are then accumulated from the runs, not the pixels. Holes are
+ * found the same way, by labeling the gaps between the runs of a blob and
+ * keeping those not connected to the outside. The buffers are reused, so
+ * labeling does not allocate once they have grown.
+ **/
+struct BlobLabeler {
+    BlobLabeler() = default;
+
+    BlobLabeler(const BlobLabeler &) = delete;
+    BlobLabeler &operator=(const BlobLabeler &) = delete;
+
+    /* Find the biggest blob in mask (8-bit, 1 channel), returns false if mask is empty */
+    bool find_biggest(const IplImage *mask, Blob *blob);
+
+    /**
+     * Outline of the last blob found by find_biggest(): the first and last
+     * pixel of each row, in order around the blob (this does not follow
+     * concavities of the outline that are open to the side)
+     **/
+    const std::vector<CvPoint> &outline() const { return outline_points; }
+
+    /**
+     * Edge points of the last blob found by find_biggest(): the midpoints of
+     * the pixel sides on the border of its row extents (at half-pixel
+     * positions), i.e. of outline()
+     **/
+    const std::vector<CvPoint2D32f> &edges();
+
+    /* Clear mask and draw the last blob found by find_biggest() into it (filled) */
+    void draw(IplImage *mask) const;
+
+private:
+    struct Run {
+        int y;
+        int x0; // first pixel
+        int x1; // last pixel
+        int label;
+    };
+
+    static int find(std::vector<int> &forest, int label);
+    static void merge(std::vector<int> &forest, int a, int b);
+
+    /* Gaps between the runs of blob label that are open to the outside (i.e. not holes) */
+    void find_open_gaps(int label, std::vector<Run> &result);
+
+    std::vector<Run> runs;
+    std::vector<int> parents; // union-find forest of run labels
+
+    struct Accumulator {
+        int row;
+        int row_x0, row_x1;
+        bool gaps; // more than one run in a row
+        int area;
+        int x0, y0, x1, y1;
+        double sx, sy, sxx, sxy, syy;
+
+        /* Add (sign 1) or remove (sign -1) the pixels first..last of row y */
+        void add_span(int y, int first, int last, int sign);
+    };
+    std::vector<Accumulator> accumulators; // per root label
+    std::vector<int> candidates; // root labels, biggest row extents first
+
+    std::vector<Run> blob_runs; // runs of one blob (for find_open_gaps())
+    std::vector<Run> gaps; // gaps between blob_runs, labels index gap_parents
+    std::vector<int> gap_parents; // union-find forest of gaps, 0 is the outside
+    std::vector<Run> candidate_gaps;
+    std::vector<Run> open_gaps; // of the last blob found by find_biggest()
+
+    std::vector<CvPoint> outline_points;
+    std::vector<CvPoint2D32f> edge_points;
+};
+
+} // namespace tracker
+} // namespace psmove
@@ -0,0 +1,232 @@
+/**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+#include <algorithm>
+
+#include <math.h>
+
+#include "psmove_tracker_circle.h"
+
+#include "../psmove_private.h"
+
+#define CIRCLE_FIT_MIN_POINTS 8 // fewer edge points than this are not fitted
+#define CIRCLE_FIT_GOOD_FRACTION .9f // fraction of inliers that makes a fit to all points good enough
+#define CIRCLE_FIT_MIN_FRACTION .35f // fraction of inliers needed to accept a RANSAC fit
+#define CIRCLE_FIT_ITERATIONS 48 // number of random triples tried by RANSAC
+#define CIRCLE_FIT_TOLERANCE 1.f // maximum distance of inliers to the circle (pixels)
+
+namespace {
+
+/* Circle through three points, false if they are (nearly) collinear */
+bool
+circle_from_triple(const CvPoint2D32f &a, const CvPoint2D32f &b, const CvPoint2D32f &c,
+        psmove::tracker::Circle *circle)
+{
+    float bx = b.x - a.x, by = b.y - a.y;
+    float cx = c.x - a.x, cy = c.y - a.y;
+
+    float d = 2.f * (bx * cy - by * cx);
+    if (fabsf(d) < 1e-3f) {
+        return false;
+    }
+
+    float b2 = bx * bx + by * by;
+    float c2 = cx * cx + cy * cy;
+    float ux = (cy * b2 - by * c2) / d;
+    float uy = (bx * c2 - cx * b2) / d;
+
+    circle->x = a.x + ux;
+    circle->y = a.y + uy;
+    circle->radius = sqrtf(ux * ux + uy * uy);
+
+    return true;
+}
+
+} // end anonymous namespace
+
+namespace psmove {
+namespace tracker {
+
+bool
+circle_fit_taubin(const CvPoint2D32f *points, int count, Circle *circle)
+{
+    psmove_return_val_if_fail(points != NULL, false);
+    psmove_return_val_if_fail(circle != NULL, false);
+
+    if (count < 3) {
+        return false;
+    }
+
+    double mean_x = 0., mean_y = 0.;
+    for (int i=0; i<count; i++) {
+        mean_x += points[i].x;
+        mean_y += points[i].y;
+    }
+    mean_x /= count;
+    mean_y /= count;
+
+    double mxx = 0., myy = 0., mxy = 0., mxz = 0., myz = 0., mzz = 0.;
+    for (int i=0; i<count; i++) {
+        double x = points[i].x - mean_x;
+        double y = points[i].y - mean_y;
+        double z = x * x + y * y;
+
+        mxx += x * x;
+        myy += y * y;
+        mxy += x * y;
+        mxz += x * z;
+        myz += y * z;
+        mzz += z * z;
+    }
+    mxx /= count;
+    myy /= count;
+    mxy /= count;
+    mxz /= count;
+    myz /= count;
+    mzz /= count;
+
+    // Coefficients of the characteristic polynomial (N. Chernov, "Circular and Linear Regression")
+    double mz = mxx + myy;
+    double cov_xy = mxx * myy - mxy * mxy;
+    double var_z = mzz - mz * mz;
+    double a3 = 4. * mz;
+    double a2 = -3. * mz * mz - mzz;
+    double a1 = var_z * mz + 4. * cov_xy * mz - mxz * mxz - myz * myz;
+    double a0 = mxz * (mxz * myy - myz * mxy) + myz * (myz * mxx - mxz * mxy) - var_z * cov_xy;
+
+    // Newton's method from 0 converges to the root we need
+    double x = 0.;
+    double y = a0;
+    for (int i=0; i<100; i++) {
+        double dy = a1 + x * (2. * a2 + 3. * a3 * x);
+        double x_new = x - y / dy;
+        if (x_new == x || !std::isfinite(x_new)) {
+            break;
+        }
+
+        double y_new = a0 + x_new * (a1 + x_new * (a2 + x_new * a3));
+        if (fabs(y_new) >= fabs(y)) {
+            break;
+        }
+
+        x = x_new;
+        y = y_new;
+    }
+
+    double det = x * x - x * mz + cov_xy;
+    if (fabs(det) < 1e-12) {
+        return false;
+    }
+
+    double center_x = (mxz * (myy - x) - myz * mxy) / det / 2.;
+    double center_y = (myz * (mxx - x) - mxz * mxy) / det / 2.;
+    double radius = sqrt(center_x * center_x + center_y * center_y + mz);
+
+    if (!std::isfinite(radius)) {
+        return false;
+    }
+
+    circle->x = (float)(center_x + mean_x);
+    circle->y = (float)(center_y + mean_y);
+    circle->radius = (float)radius;
+
+    return true;
+}
+
+int
+CircleFitter::select_inliers(const std::vector<CvPoint2D32f> &points, const Circle &circle)
+{
+    inliers.clear();
+    for (const auto &point: points) {
+        float dx = point.x - circle.x;
+        float dy = point.y - circle.y;
+        if (fabsf(sqrtf(dx * dx + dy * dy) - circle.radius) <= CIRCLE_FIT_TOLERANCE) {
+            inliers.push_back(point);
+        }
+    }
+
+    return (int)inliers.size();
+}
+
+bool
+CircleFitter::fit(const std::vector<CvPoint2D32f> &points, Circle *circle)
+{
+    psmove_return_val_if_fail(circle != NULL, false);
+
+    int count = (int)points.size();
+    if (count < CIRCLE_FIT_MIN_POINTS) {
+        return false;
+    }
+
+    Circle best;
+    int best_inliers = 0;
+
+    if (circle_fit_taubin(points.data(), count, &best)) {
+        best_inliers = select_inliers(points, best);
+    }
+
+    if (best_inliers < CIRCLE_FIT_GOOD_FRACTION * count) {
+        // Same sequence for every fit, so that results are reproducible
+        random_state = 1;
+
+        for (int i=0; i<CIRCLE_FIT_ITERATIONS; i++) {
+            int sample[3];
+            for (int j=0; j<3; j++) {
+                random_state = random_state * 1664525u + 1013904223u;
+                sample[j] = (int)((random_state >> 8) % (uint32_t)count);
+            }
+
+            Circle candidate;
+            if (!circle_from_triple(points[sample[0]], points[sample[1]], points[sample[2]], &candidate)) {
+                continue;
+            }
+
+            int candidate_inliers = select_inliers(points, candidate);
+            if (candidate_inliers > best_inliers) {
+                best = candidate;
+                best_inliers = candidate_inliers;
+            }
+        }
+
+        if (best_inliers < std::max(CIRCLE_FIT_MIN_POINTS, (int)(CIRCLE_FIT_MIN_FRACTION * count))) {
+            return false;
+        }
+    }
+
+    // Refine with a fit to the points close to the best circle
+    select_inliers(points, best);
+    if (!circle_fit_taubin(inliers.data(), (int)inliers.size(), circle)) {
+        return false;
+    }
+
+    return true;
+}
+
+} // end namespace tracker
+} // end namespace psmove
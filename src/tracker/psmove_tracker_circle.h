@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#include "opencv2/core/core_c.h"
+
+#include <stdint.h>
+#include <vector>
+
+
+namespace psmove {
+namespace tracker {
+
+struct Circle {
+    float x { 0.f };
+    float y { 0.f };
+    float radius { 0.f };
+};
+
+/**
+ * Least-squares circle fit to edge points
+ *
+ * Uses Taubin's algebraic fit (less biased than the Kasa fit on short arcs).
+ * If the fit to all points does not explain most of them (e.g. a sphere
+ * partially hidden by a hand), circles through random triples of points
+ * are tried, and the one with the most points close to it is refined with
+ * a fit to those points only (RANSAC).
+ **/
+struct CircleFitter {
+    CircleFitter() = default;
+
+    CircleFitter(const CircleFitter &) = delete;
+    CircleFitter &operator=(const CircleFitter &) = delete;
+
+    /* Returns false if the points do not describe a circle well enough */
+    bool fit(const std::vector<CvPoint2D32f> &points, Circle *circle);
+
+private:
+    int select_inliers(const std::vector<CvPoint2D32f> &points, const Circle &circle);
+
+    std::vector<CvPoint2D32f> inliers;
+    uint32_t random_state { 0 };
+};
+
+/* Taubin fit to all points, returns false if they are (nearly) collinear */
+bool
+circle_fit_taubin(const CvPoint2D32f *points, int count, Circle *circle);
+
+} // namespace tracker
+} // namespace psmove
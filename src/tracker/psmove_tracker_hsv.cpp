@@ -0,0 +1,403 @@
+/**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+#include <algorithm>
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#  include <immintrin.h>
+#  define PSMOVE_HSV_AVX2
+#  define PSMOVE_HSV_AVX2_TARGET
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+/* Not built for AVX2, but the compiler can build the AVX2 path for use if the CPU supports it */
+#  include <immintrin.h>
+#  define PSMOVE_HSV_AVX2
+#  define PSMOVE_HSV_AVX2_TARGET __attribute__((target("avx2")))
+#  define PSMOVE_HSV_AVX2_RUNTIME_CHECK
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#  include <arm_neon.h>
+#  define PSMOVE_HSV_NEON
+#endif
+
+#include "opencv2/core/core_c.h"
+
+#include "psmove_tracker_hsv.h"
+
+#include "../psmove_private.h"
+
+#define HSV_MAX_RANGES 8 // at most one range per label bit
+
+namespace {
+
+/**
+ * Fixed-point BGR to HSV as done by OpenCV for 8-bit images (RGB2HSV_b):
+ * the divisions by V and by (V - min(B, G, R)) are multiplications with
+ * rounded reciprocals in 12-bit fixed point.
+ **/
+const int HSV_SHIFT = 12;
+const int HSV_ROUND = 1 << (HSV_SHIFT - 1);
+const int HSV_HUE_RANGE = 180;
+
+struct HSVTables {
+    HSVTables()
+    {
+        saturation[0] = hue[0] = 0;
+        for (int i=1; i<256; i++) {
+            saturation[i] = (int)lrint((255 << HSV_SHIFT) / (1. * i));
+            hue[i] = (int)lrint((HSV_HUE_RANGE << HSV_SHIFT) / (6. * i));
+        }
+    }
+
+    int saturation[256];
+    int hue[256];
+};
+
+const HSVTables tables;
+
+inline uint8_t
+classify_pixel(const uint8_t *p, const psmove::tracker::HSVRange *ranges, const uint8_t *bits, int range_count)
+{
+    int b = p[0], g = p[1], r = p[2];
+
+    int v = std::max(b, std::max(g, r));
+    int diff = v - std::min(b, std::min(g, r));
+
+    int s = (diff * tables.saturation[v] + HSV_ROUND) >> HSV_SHIFT;
+
+    int h;
+    if (v == r) {
+        h = g - b;
+    } else if (v == g) {
+        h = b - r + 2 * diff;
+    } else {
+        h = r - g + 4 * diff;
+    }
+    h = (h * tables.hue[diff] + HSV_ROUND) >> HSV_SHIFT;
+    if (h < 0) {
+        h += HSV_HUE_RANGE;
+    }
+
+    uint8_t label = 0;
+    for (int i=0; i<range_count; i++) {
+        const psmove::tracker::HSVRange &range = ranges[i];
+        bool match = (h >= range.lower[0]) & (h <= range.upper[0]) &
+                     (s >= range.lower[1]) & (s <= range.upper[1]) &
+                     (v >= range.lower[2]) & (v <= range.upper[2]);
+        label |= match ? bits[i] : 0;
+    }
+
+    return label;
+}
+
+#if defined(PSMOVE_HSV_AVX2)
+
+/* Hue and saturation (packed to 16 bits) of 8 pixels */
+PSMOVE_HSV_AVX2_TARGET inline void
+hsv_avx2(__m128i b8, __m128i g8, __m128i r8, __m128i v8, __m128i diff8, __m128i *h16, __m128i *s16)
+{
+    const __m256i k_round = _mm256_set1_epi32(HSV_ROUND);
+    const __m256i k_hue_range = _mm256_set1_epi32(HSV_HUE_RANGE);
+
+    __m256i b = _mm256_cvtepu8_epi32(b8);
+    __m256i g = _mm256_cvtepu8_epi32(g8);
+    __m256i r = _mm256_cvtepu8_epi32(r8);
+    __m256i v = _mm256_cvtepu8_epi32(v8);
+    __m256i diff = _mm256_cvtepu8_epi32(diff8);
+
+    __m256i s = _mm256_i32gather_epi32(tables.saturation, v, 4);
+    s = _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(diff, s), k_round), HSV_SHIFT);
+
+    __m256i h_r = _mm256_sub_epi32(g, b);
+    __m256i h_g = _mm256_add_epi32(_mm256_sub_epi32(b, r), _mm256_slli_epi32(diff, 1));
+    __m256i h_b = _mm256_add_epi32(_mm256_sub_epi32(r, g), _mm256_slli_epi32(diff, 2));
+    __m256i h = _mm256_blendv_epi8(h_b, h_g, _mm256_cmpeq_epi32(v, g));
+    h = _mm256_blendv_epi8(h, h_r, _mm256_cmpeq_epi32(v, r));
+
+    h = _mm256_mullo_epi32(h, _mm256_i32gather_epi32(tables.hue, diff, 4));
+    h = _mm256_srai_epi32(_mm256_add_epi32(h, k_round), HSV_SHIFT);
+    h = _mm256_add_epi32(h, _mm256_and_si256(_mm256_cmpgt_epi32(_mm256_setzero_si256(), h), k_hue_range));
+
+    *h16 = _mm_packus_epi32(_mm256_castsi256_si128(h), _mm256_extracti128_si256(h, 1));
+    *s16 = _mm_packus_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+}
+
+/* lower <= x <= upper for unsigned bytes */
+PSMOVE_HSV_AVX2_TARGET inline __m128i
+in_range_avx2(__m128i x, __m128i lower, __m128i upper)
+{
+    return _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(x, lower), x),
+                         _mm_cmpeq_epi8(_mm_min_epu8(x, upper), x));
+}
+
+/* Classifies 16 pixels at a time, returns the number of pixels done */
+PSMOVE_HSV_AVX2_TARGET int
+classify_avx2(const uint8_t *bgr, uint8_t *labels, int count,
+        const psmove::tracker::HSVRange *ranges, const uint8_t *bits, int range_count)
+{
+    // Gather every third byte of the 48 bytes (16 pixels) into one vector per channel
+    const __m128i k_b0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i k_b1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i k_b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i k_g0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i k_g1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i k_g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i k_r0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i k_r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i k_r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+    __m128i lower[HSV_MAX_RANGES][3];
+    __m128i upper[HSV_MAX_RANGES][3];
+    __m128i label_bits[HSV_MAX_RANGES];
+    for (int i=0; i<range_count; i++) {
+        for (int c=0; c<3; c++) {
+            lower[i][c] = _mm_set1_epi8((char)ranges[i].lower[c]);
+            upper[i][c] = _mm_set1_epi8((char)ranges[i].upper[c]);
+        }
+        label_bits[i] = _mm_set1_epi8((char)bits[i]);
+    }
+
+    int done = 0;
+    for (; done + 16 <= count; done += 16, bgr += 48, labels += 16) {
+        __m128i c0 = _mm_loadu_si128((const __m128i *)bgr);
+        __m128i c1 = _mm_loadu_si128((const __m128i *)(bgr + 16));
+        __m128i c2 = _mm_loadu_si128((const __m128i *)(bgr + 32));
+
+        __m128i b = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, k_b0), _mm_shuffle_epi8(c1, k_b1)), _mm_shuffle_epi8(c2, k_b2));
+        __m128i g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, k_g0), _mm_shuffle_epi8(c1, k_g1)), _mm_shuffle_epi8(c2, k_g2));
+        __m128i r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, k_r0), _mm_shuffle_epi8(c1, k_r1)), _mm_shuffle_epi8(c2, k_r2));
+
+        __m128i v = _mm_max_epu8(b, _mm_max_epu8(g, r));
+        __m128i diff = _mm_sub_epi8(v, _mm_min_epu8(b, _mm_min_epu8(g, r)));
+
+        __m128i h_low, s_low, h_high, s_high;
+        hsv_avx2(b, g, r, v, diff, &h_low, &s_low);
+        hsv_avx2(_mm_srli_si128(b, 8), _mm_srli_si128(g, 8), _mm_srli_si128(r, 8),
+                 _mm_srli_si128(v, 8), _mm_srli_si128(diff, 8), &h_high, &s_high);
+        __m128i h = _mm_packus_epi16(h_low, h_high);
+        __m128i s = _mm_packus_epi16(s_low, s_high);
+
+        __m128i label = _mm_setzero_si128();
+        for (int i=0; i<range_count; i++) {
+            __m128i match = _mm_and_si128(_mm_and_si128(
+                        in_range_avx2(h, lower[i][0], upper[i][0]),
+                        in_range_avx2(s, lower[i][1], upper[i][1])),
+                        in_range_avx2(v, lower[i][2], upper[i][2]));
+            label = _mm_or_si128(label, _mm_and_si128(match, label_bits[i]));
+        }
+
+        _mm_storeu_si128((__m128i *)labels, label);
+    }
+
+    return done;
+}
+
+#elif defined(PSMOVE_HSV_NEON)
+
+/* Hue and saturation (packed to 16 bits) of 4 pixels */
+inline void
+hsv_neon(uint32x4_t b32, uint32x4_t g32, uint32x4_t r32, uint32x4_t v32, uint32x4_t diff32, uint16x4_t *h16, uint16x4_t *s16)
+{
+    // No gather, the reciprocal tables are computed in float (this matches them exactly, there are no ties)
+    const float32x4_t k_saturation = vdupq_n_f32((float)(255 << HSV_SHIFT));
+    const float32x4_t k_hue = vdupq_n_f32((float)((HSV_HUE_RANGE << HSV_SHIFT) / 6));
+    const int32x4_t k_one = vdupq_n_s32(1);
+    const int32x4_t k_round = vdupq_n_s32(HSV_ROUND);
+    const int32x4_t k_hue_range = vdupq_n_s32(HSV_HUE_RANGE);
+
+    int32x4_t b = vreinterpretq_s32_u32(b32);
+    int32x4_t g = vreinterpretq_s32_u32(g32);
+    int32x4_t r = vreinterpretq_s32_u32(r32);
+    int32x4_t v = vreinterpretq_s32_u32(v32);
+    int32x4_t diff = vreinterpretq_s32_u32(diff32);
+
+    int32x4_t s = vcvtnq_s32_f32(vdivq_f32(k_saturation, vcvtq_f32_s32(vmaxq_s32(v, k_one))));
+    s = vshrq_n_s32(vaddq_s32(vmulq_s32(diff, s), k_round), HSV_SHIFT);
+
+    int32x4_t h_r = vsubq_s32(g, b);
+    int32x4_t h_g = vaddq_s32(vsubq_s32(b, r), vshlq_n_s32(diff, 1));
+    int32x4_t h_b = vaddq_s32(vsubq_s32(r, g), vshlq_n_s32(diff, 2));
+    int32x4_t h = vbslq_s32(vceqq_s32(v, r), h_r, vbslq_s32(vceqq_s32(v, g), h_g, h_b));
+
+    h = vmulq_s32(h, vcvtnq_s32_f32(vdivq_f32(k_hue, vcvtq_f32_s32(vmaxq_s32(diff, k_one)))));
+    h = vshrq_n_s32(vaddq_s32(h, k_round), HSV_SHIFT);
+    h = vaddq_s32(h, vandq_s32(vreinterpretq_s32_u32(vcltzq_s32(h)), k_hue_range));
+
+    *h16 = vqmovun_s32(h);
+    *s16 = vqmovun_s32(s);
+}
+
+/* Classifies 16 pixels at a time, returns the number of pixels done */
+int
+classify_neon(const uint8_t *bgr, uint8_t *labels, int count,
+        const psmove::tracker::HSVRange *ranges, const uint8_t *bits, int range_count)
+{
+    uint8x16_t lower[HSV_MAX_RANGES][3];
+    uint8x16_t upper[HSV_MAX_RANGES][3];
+    uint8x16_t label_bits[HSV_MAX_RANGES];
+    for (int i=0; i<range_count; i++) {
+        for (int c=0; c<3; c++) {
+            lower[i][c] = vdupq_n_u8(ranges[i].lower[c]);
+            upper[i][c] = vdupq_n_u8(ranges[i].upper[c]);
+        }
+        label_bits[i] = vdupq_n_u8(bits[i]);
+    }
+
+    int done = 0;
+    for (; done + 16 <= count; done += 16, bgr += 48, labels += 16) {
+        uint8x16x3_t pixels = vld3q_u8(bgr);
+        uint8x16_t b = pixels.val[0];
+        uint8x16_t g = pixels.val[1];
+        uint8x16_t r = pixels.val[2];
+
+        uint8x16_t v = vmaxq_u8(b, vmaxq_u8(g, r));
+        uint8x16_t diff = vsubq_u8(v, vminq_u8(b, vminq_u8(g, r)));
+
+        uint16x8_t b16[2] = { vmovl_u8(vget_low_u8(b)), vmovl_high_u8(b) };
+        uint16x8_t g16[2] = { vmovl_u8(vget_low_u8(g)), vmovl_high_u8(g) };
+        uint16x8_t r16[2] = { vmovl_u8(vget_low_u8(r)), vmovl_high_u8(r) };
+        uint16x8_t v16[2] = { vmovl_u8(vget_low_u8(v)), vmovl_high_u8(v) };
+        uint16x8_t diff16[2] = { vmovl_u8(vget_low_u8(diff)), vmovl_high_u8(diff) };
+
+        uint16x4_t h_parts[4], s_parts[4];
+        for (int i=0; i<2; i++) {
+            hsv_neon(vmovl_u16(vget_low_u16(b16[i])), vmovl_u16(vget_low_u16(g16[i])),
+                     vmovl_u16(vget_low_u16(r16[i])), vmovl_u16(vget_low_u16(v16[i])),
+                     vmovl_u16(vget_low_u16(diff16[i])), &h_parts[2 * i], &s_parts[2 * i]);
+            hsv_neon(vmovl_high_u16(b16[i]), vmovl_high_u16(g16[i]),
+                     vmovl_high_u16(r16[i]), vmovl_high_u16(v16[i]),
+                     vmovl_high_u16(diff16[i]), &h_parts[2 * i + 1], &s_parts[2 * i + 1]);
+        }
+
+        uint8x16_t h = vcombine_u8(vqmovn_u16(vcombine_u16(h_parts[0], h_parts[1])),
+                                   vqmovn_u16(vcombine_u16(h_parts[2], h_parts[3])));
+        uint8x16_t s = vcombine_u8(vqmovn_u16(vcombine_u16(s_parts[0], s_parts[1])),
+                                   vqmovn_u16(vcombine_u16(s_parts[2], s_parts[3])));
+
+        uint8x16_t label = vdupq_n_u8(0);
+        for (int i=0; i<range_count; i++) {
+            uint8x16_t match = vandq_u8(vandq_u8(
+                        vandq_u8(vcgeq_u8(h, lower[i][0]), vcleq_u8(h, upper[i][0])),
+                        vandq_u8(vcgeq_u8(s, lower[i][1]), vcleq_u8(s, upper[i][1]))),
+                        vandq_u8(vcgeq_u8(v, lower[i][2]), vcleq_u8(v, upper[i][2])));
+            label = vorrq_u8(label, vandq_u8(match, label_bits[i]));
+        }
+
+        vst1q_u8(labels, label);
+    }
+
+    return done;
+}
+
+#endif
+
+/* cvInRangeS() on 8-bit images compares to the rounded-inwards, saturated bounds */
+uint8_t
+range_lower_bound(double value)
+{
+    double result = ceil(value);
+    return (uint8_t)((result < 0.) ? 0. : ((result > 255.) ? 255. : result));
+}
+
+uint8_t
+range_upper_bound(double value)
+{
+    double result = floor(value);
+    return (uint8_t)((result < 0.) ? 0. : ((result > 255.) ? 255. : result));
+}
+
+} // end anonymous namespace
+
+namespace psmove {
+namespace tracker {
+
+HSVRange
+hsv_range(CvScalar min, CvScalar max)
+{
+    HSVRange range;
+
+    for (int i=0; i<3; i++) {
+        range.lower[i] = range_lower_bound(min.val[i]);
+        range.upper[i] = range_upper_bound(max.val[i]);
+
+        if (max.val[i] < 0. || min.val[i] > 255.) {
+            // Nothing can match (lower > upper)
+            range.lower[i] = 255;
+            range.upper[i] = 0;
+        }
+    }
+
+    return range;
+}
+
+void
+hsv_classify(const uint8_t *bgr, uint8_t *labels, int count,
+        const HSVRange *ranges, const uint8_t *bits, int range_count)
+{
+    psmove_return_if_fail(range_count >= 0 && range_count <= HSV_MAX_RANGES);
+
+    int done = 0;
+
+#if defined(PSMOVE_HSV_AVX2_RUNTIME_CHECK)
+    static const bool have_avx2 = __builtin_cpu_supports("avx2");
+    if (have_avx2) {
+        done = classify_avx2(bgr, labels, count, ranges, bits, range_count);
+    }
+#elif defined(PSMOVE_HSV_AVX2)
+    done = classify_avx2(bgr, labels, count, ranges, bits, range_count);
+#elif defined(PSMOVE_HSV_NEON)
+    done = classify_neon(bgr, labels, count, ranges, bits, range_count);
+#endif
+
+    for (int i=done; i<count; i++) {
+        labels[i] = classify_pixel(bgr + 3 * i, ranges, bits, range_count);
+    }
+}
+
+void
+hsv_mask(IplImage *frame, CvScalar min, CvScalar max, IplImage *mask)
+{
+    psmove_return_if_fail(frame != NULL && frame->nChannels == 3 && frame->depth == IPL_DEPTH_8U);
+    psmove_return_if_fail(mask != NULL && mask->nChannels == 1 && mask->depth == IPL_DEPTH_8U);
+
+    CvRect roi = cvGetImageROI(frame);
+    psmove_return_if_fail(mask->width >= roi.width && mask->height >= roi.height);
+
+    HSVRange range = hsv_range(min, max);
+    uint8_t bit = 255;
+
+    for (int y=0; y<roi.height; y++) {
+        hsv_classify((const uint8_t *)frame->imageData + (roi.y + y) * frame->widthStep + 3 * roi.x,
+                (uint8_t *)mask->imageData + y * mask->widthStep, roi.width, &range, &bit, 1);
+    }
+}
+
+} // end namespace tracker
+} // end namespace psmove
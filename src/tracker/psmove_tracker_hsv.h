@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#include "psmove.h"
+
+#include "opencv2/core/core_c.h"
+
+#include <stdint.h>
+
+
+namespace psmove {
+namespace tracker {
+
+/**
+ * Inclusive per-channel bounds of a color filter in OpenCV's 8-bit HSV
+ * (H = 0..180, S and V = 0..255); a channel with lower > upper matches nothing
+ **/
+struct HSVRange {
+    uint8_t lower[3];
+    uint8_t upper[3];
+};
+
+/* Bounds that match the same pixels as cvInRangeS(hsv, min, max, mask) */
+HSVRange
+hsv_range(CvScalar min, CvScalar max);
+
+/**
+ * Classify count BGR pixels (3 bytes each) against several color ranges at
+ * once, without materializing the HSV image. The pixel's hue, saturation and
+ * value are bit-exact to cvCvtColor(..., CV_BGR2HSV). labels[i] is the OR of
+ * bits[j] for all ranges[j] that contain pixel i.
+ *
+ * Uses AVX2 (if the CPU supports it) or NEON, scalar code otherwise.
+ **/
+ADDAPI void
+ADDCALL hsv_classify(const uint8_t *bgr, uint8_t *labels, int count,
+        const HSVRange *ranges, const uint8_t *bits, int range_count);
+
+/**
+ * Fused replacement for cvCvtColor(frame, hsv, CV_BGR2HSV) followed by
+ * cvInRangeS(hsv, min, max, mask), for the ROI of frame (8-bit BGR). mask is
+ * 8-bit single channel, at least as big as the ROI; it is set to 255 where
+ * the pixel is in range and 0 otherwise.
+ **/
+ADDAPI void
+ADDCALL hsv_mask(IplImage *frame, CvScalar min, CvScalar max, IplImage *mask);
+
+} // namespace tracker
+} // namespace psmove
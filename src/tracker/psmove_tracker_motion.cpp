@@ -0,0 +1,118 @@
+/**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+
+#include <algorithm>
+
+#include <math.h>
+
+#include "psmove_tracker_motion.h"
+
+namespace psmove {
+namespace tracker {
+
+void
+MotionModel::Axis::predict(float dt, float acceleration)
+{
+    position += velocity * dt;
+
+    // P = F * P * F^T + Q, with F = [1 dt; 0 1] and the acceleration
+    // a constant random value during dt: Q = a^2 * [dt^4/4 dt^3/2; dt^3/2 dt^2]
+    float a2 = acceleration * acceleration;
+    float dt2 = dt * dt;
+    variance += dt * (2.f * covariance + dt * velocity_variance) + a2 * dt2 * dt2 / 4.f;
+    covariance += dt * velocity_variance + a2 * dt2 * dt / 2.f;
+    velocity_variance += a2 * dt2;
+}
+
+void
+MotionModel::Axis::correct(float measurement, float measurement_variance)
+{
+    float innovation_variance = variance + measurement_variance;
+    float gain_position = variance / innovation_variance;
+    float gain_velocity = covariance / innovation_variance;
+    float innovation = measurement - position;
+
+    position += gain_position * innovation;
+    velocity += gain_velocity * innovation;
+
+    // P = (I - K * H) * P, with H = [1 0]
+    velocity_variance -= gain_velocity * covariance;
+    covariance -= gain_velocity * variance;
+    variance -= gain_position * variance;
+}
+
+void
+MotionModel::reset()
+{
+    valid = false;
+}
+
+void
+MotionModel::predict(float dt, float acceleration)
+{
+    if (!valid || dt <= 0.f) {
+        return;
+    }
+
+    x.predict(dt, acceleration);
+    y.predict(dt, acceleration);
+}
+
+void
+MotionModel::start(float measured_x, float measured_y, float sigma, float velocity_sigma)
+{
+    float measurement_variance = sigma * sigma;
+    float velocity_variance = velocity_sigma * velocity_sigma;
+
+    x = Axis { measured_x, 0.f, measurement_variance, 0.f, velocity_variance };
+    y = Axis { measured_y, 0.f, measurement_variance, 0.f, velocity_variance };
+    valid = true;
+}
+
+void
+MotionModel::correct(float measured_x, float measured_y, float sigma)
+{
+    if (!valid) {
+        return;
+    }
+
+    float measurement_variance = sigma * sigma;
+    x.correct(measured_x, measurement_variance);
+    y.correct(measured_y, measurement_variance);
+}
+
+float
+MotionModel::position_sigma() const
+{
+    return sqrtf(std::max(x.variance, y.variance));
+}
+
+} // end namespace tracker
+} // end namespace psmove
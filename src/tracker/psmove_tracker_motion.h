@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+namespace psmove {
+namespace tracker {
+
+/**
+ * Constant-velocity Kalman filter for the sphere position in the image
+ *
+ * x and y are filtered independently, each with position and velocity as
+ * state. The process noise is a random acceleration between updates, so the
+ * position uncertainty grows quickly while the sphere is not seen, which is
+ * used to size the ROI in which it is searched next.
+ *
+ * All-zero is a valid (empty) state, so it can live in memset()-cleared structs.
+ **/
+struct MotionModel {
+    struct Axis {
+        float position;          // pixels
+        float velocity;          // pixels per second
+        float variance;          // of the position
+        float covariance;        // of position and velocity
+        float velocity_variance; // of the velocity
+
+        void predict(float dt, float acceleration);
+        void correct(float measurement, float measurement_variance);
+    };
+
+    /* Forget the state, until the next start() */
+    void reset();
+
+    /* Start at a measured position, with unknown velocity (of about velocity_sigma, in pixels/s) */
+    void start(float x, float y, float sigma, float velocity_sigma);
+
+    /* Advance by dt seconds, acceleration is the expected random acceleration (pixels/s^2) */
+    void predict(float dt, float acceleration);
+
+    /* Update with a measured position, sigma is its standard deviation (pixels) */
+    void correct(float x, float y, float sigma);
+
+    /* Standard deviation of the position along the less certain axis (pixels) */
+    float position_sigma() const;
+
+    bool valid;  // false until start()
+    Axis x;
+    Axis y;
+};
+
+} // namespace tracker
+} // namespace psmove
@@ -0,0 +1,179 @@
+/**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <algorithm>
+
+#include <string.h>
+
+#include "opencv2/core/core_c.h"
+
+#include "psmove_tracker.h"
+#include "psmove_tracker_segmentation.h"
+
+#include "../psmove_private.h"
+
+#define SEGMENTATION_TILE_SIZE 16 // width and height of the tiles that are classified at once
+
+static_assert(PSMOVE_TRACKER_MAX_CONTROLLERS <= 8, "labels have one bit per controller slot");
+
+namespace psmove {
+namespace tracker {
+
+Segmentation::Segmentation(CvSize size)
+    : size(size)
+    , tiles_horizontal((size.width + SEGMENTATION_TILE_SIZE - 1) / SEGMENTATION_TILE_SIZE)
+    , tiles_vertical((size.height + SEGMENTATION_TILE_SIZE - 1) / SEGMENTATION_TILE_SIZE)
+    , tiles(tiles_horizontal * tiles_vertical, 0)
+    , labels(cvCreateImage(size, IPL_DEPTH_8U, 1))
+{
+}
+
+Segmentation::~Segmentation()
+{
+    cvReleaseImage(&labels);
+}
+
+void
+Segmentation::reset()
+{
+    invalidate();
+}
+
+void
+Segmentation::set_range(int slot, CvScalar min, CvScalar max)
+{
+    psmove_return_if_fail(slot >= 0 && slot < PSMOVE_TRACKER_MAX_CONTROLLERS);
+
+    HSVRange range = hsv_range(min, max);
+
+    if (!active[slot] || memcmp(&ranges[slot], &range, sizeof(range)) != 0) {
+        active[slot] = true;
+        ranges[slot] = range;
+        invalidate();
+    }
+}
+
+void
+Segmentation::clear_range(int slot)
+{
+    psmove_return_if_fail(slot >= 0 && slot < PSMOVE_TRACKER_MAX_CONTROLLERS);
+
+    if (active[slot]) {
+        active[slot] = false;
+        invalidate();
+    }
+}
+
+void
+Segmentation::invalidate()
+{
+    std::fill(tiles.begin(), tiles.end(), 0);
+}
+
+void
+Segmentation::get_mask(IplImage *frame, CvRect rect, int slot, IplImage *mask)
+{
+    psmove_return_if_fail(frame != NULL);
+    psmove_return_if_fail(mask != NULL);
+    psmove_return_if_fail(slot >= 0 && slot < PSMOVE_TRACKER_MAX_CONTROLLERS);
+    psmove_return_if_fail(frame->width == size.width && frame->height == size.height);
+    psmove_return_if_fail(frame->nChannels == 3 && frame->depth == IPL_DEPTH_8U);
+    psmove_return_if_fail(rect.x >= 0 && rect.y >= 0 &&
+            rect.x + rect.width <= size.width && rect.y + rect.height <= size.height);
+    psmove_return_if_fail(mask->width >= rect.width && mask->height >= rect.height);
+
+    update(frame, rect);
+
+    uint8_t bit = (uint8_t)(1 << slot);
+    for (int y=0; y<rect.height; y++) {
+        const uint8_t *src = (const uint8_t *)labels->imageData + (rect.y + y) * labels->widthStep + rect.x;
+        uint8_t *dst = (uint8_t *)mask->imageData + y * mask->widthStep;
+
+        for (int x=0; x<rect.width; x++) {
+            dst[x] = (src[x] & bit) ? 255 : 0;
+        }
+    }
+}
+
+void
+Segmentation::update(IplImage *frame, CvRect rect)
+{
+    int first_column = rect.x / SEGMENTATION_TILE_SIZE;
+    int last_column = (rect.x + rect.width - 1) / SEGMENTATION_TILE_SIZE;
+    int first_row = rect.y / SEGMENTATION_TILE_SIZE;
+    int last_row = (rect.y + rect.height - 1) / SEGMENTATION_TILE_SIZE;
+
+    for (int row=first_row; row<=last_row; row++) {
+        uint8_t *classified = tiles.data() + row * tiles_horizontal;
+
+        int column = first_column;
+        while (column <= last_column) {
+            if (classified[column]) {
+                column++;
+                continue;
+            }
+
+            // Process runs of consecutive tiles at once
+            int start = column;
+            while (column <= last_column && !classified[column]) {
+                classified[column++] = 1;
+            }
+
+            CvRect run = cvRect(start * SEGMENTATION_TILE_SIZE, row * SEGMENTATION_TILE_SIZE,
+                    (column - start) * SEGMENTATION_TILE_SIZE, SEGMENTATION_TILE_SIZE);
+            run.width = std::min(run.width, size.width - run.x);
+            run.height = std::min(run.height, size.height - run.y);
+
+            classify(frame, run);
+        }
+    }
+}
+
+void
+Segmentation::classify(IplImage *frame, CvRect rect)
+{
+    HSVRange active_ranges[PSMOVE_TRACKER_MAX_CONTROLLERS];
+    uint8_t bits[PSMOVE_TRACKER_MAX_CONTROLLERS];
+    int count = 0;
+
+    for (int slot=0; slot<PSMOVE_TRACKER_MAX_CONTROLLERS; slot++) {
+        if (active[slot]) {
+            active_ranges[count] = ranges[slot];
+            bits[count++] = (uint8_t)(1 << slot);
+        }
+    }
+
+    for (int y=rect.y; y<rect.y + rect.height; y++) {
+        hsv_classify((const uint8_t *)frame->imageData + y * frame->widthStep + 3 * rect.x,
+                (uint8_t *)labels->imageData + y * labels->widthStep + rect.x,
+                rect.width, active_ranges, bits, count);
+    }
+}
+
+} // end namespace tracker
+} // end namespace psmove
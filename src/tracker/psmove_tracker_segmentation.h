@@ -0,0 +1,95 @@
+#pragma once
+
+/**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+#include "psmove_tracker.h"
+#include "psmove_tracker_hsv.h"
+
+#include "opencv2/core/core_c.h"
+
+#include <stdint.h>
+#include <vector>
+
+
+namespace psmove {
+namespace tracker {
+
+/**
+ * HSV segmentation shared by all controllers of a tracker
+ *
+ * The frame is classified in tiles, only where a controller needs a mask,
+ * and each tile only once per frame (overlapping ROIs, retries with a bigger
+ * ROI and the ROI centering all reuse it). In a single pass, every pixel is
+ * checked against the color ranges of all controllers (see hsv_classify()),
+ * the result is a label image with one bit per controller slot.
+ **/
+struct Segmentation {
+    Segmentation(CvSize size);
+    ~Segmentation();
+
+    Segmentation(const Segmentation &) = delete;
+    Segmentation &operator=(const Segmentation &) = delete;
+
+    /* Forget the converted tiles (call for each new frame) */
+    void reset();
+
+    /**
+     * Set the color range (as used by cvInRangeS()) of a controller slot,
+     * the tiles are classified again if it changes
+     **/
+    void set_range(int slot, CvScalar min, CvScalar max);
+
+    /* Stop classifying pixels for a controller slot */
+    void clear_range(int slot);
+
+    /**
+     * Write the mask of a controller slot for the rect of the frame into
+     * mask (255 where the pixel is in the slot's color range, 0 otherwise)
+     **/
+    void get_mask(IplImage *frame, CvRect rect, int slot, IplImage *mask);
+
+private:
+    void update(IplImage *frame, CvRect rect);
+    void classify(IplImage *frame, CvRect rect);
+    void invalidate();
+
+    CvSize size;
+    int tiles_horizontal;
+    int tiles_vertical;
+    std::vector<uint8_t> tiles; // nonzero if the tile's labels are valid for this frame
+
+    IplImage *labels { nullptr }; // bit (1 << slot) set if the pixel is in the slot's range
+
+    bool active[PSMOVE_TRACKER_MAX_CONTROLLERS] {};
+    HSVRange ranges[PSMOVE_TRACKER_MAX_CONTROLLERS] {};
+};
+
+} // namespace tracker
+} // namespace psmove
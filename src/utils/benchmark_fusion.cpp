@@ -0,0 +1,727 @@
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "psmove.h"
+#include "../psmove_private.h"
+#include "../psmove_capture.h"
+#include "../math/psmove_vector.h"
+
+/* Number of fusion samples to time per fusion type and capture */
+#define FUSION_BENCHMARK_DEFAULT_SAMPLES 1000000
+
+/* Reports at the start of a capture that are not used for accuracy (filter settling) */
+#define FUSION_BENCHMARK_WARMUP_US (2 * 1000 * 1000)
+
+/* Largest allowed difference of the fixed-point path from the float path (--compare-fixed) */
+#define FUSION_COMPARE_ACCELEROMETER_TOLERANCE_G 0.001
+#define FUSION_COMPARE_GYROSCOPE_TOLERANCE_RAD_S 0.001
+#define FUSION_COMPARE_ORIENTATION_TOLERANCE_DEG 0.5
+
+/* Synthetic traces: Report interval (two samples per report) and default duration */
+#define FUSION_SYNTH_REPORT_INTERVAL_US 11250
+#define FUSION_SYNTH_REPORT_SIZE 49 /* sizeof(PSMove_ZCM1_Data_Input) */
+#define FUSION_SYNTH_DEFAULT_SECONDS 120
+
+/* Synthetic traces: Raw sensor scales of the synthetic ZCM1 calibration */
+#define FUSION_SYNTH_ACCEL_COUNTS_PER_G 4096
+#define FUSION_SYNTH_GYRO_COUNTS_AT_80RPM 20000
+#define FUSION_SYNTH_MAGNETOMETER_COUNTS 1000
+
+/**
+ * Heap allocations (counted while fusion is running). Only the standalone
+ * psmove_benchmark_fusion executable counts them, by wrapping malloc() and
+ * friends (see below), so that the library's allocations are seen, too.
+ * The "psmove benchmark-fusion" subcommand doesn't replace the allocator.
+ **/
+#if defined(PSMOVE_BENCHMARK_FUSION_STANDALONE) && defined(__GLIBC__)
+#define FUSION_BENCHMARK_COUNT_ALLOCATIONS
+#endif
+
+static std::atomic<unsigned long> fusion_benchmark_allocations(0);
+
+#if defined(FUSION_BENCHMARK_COUNT_ALLOCATIONS)
+extern "C" {
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+void *
+malloc(size_t size)
+{
+    fusion_benchmark_allocations++;
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t count, size_t size)
+{
+    fusion_benchmark_allocations++;
+    return __libc_calloc(count, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+    fusion_benchmark_allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+void
+free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+}; // extern "C"
+#endif
+
+namespace {
+
+struct FusionTrace {
+    FusionTrace(const char *filename)
+        : filename(filename)
+        , model(Model_Unknown)
+        , time_us()
+        , reference()
+    {
+    }
+
+    bool load();
+
+    bool has_reference() const {
+        return !reference.empty() && reference.size() == time_us.size();
+    }
+
+    std::string filename;
+    enum PSMove_Model_Type model;
+
+    /* Recording time and reference orientation of each input report */
+    std::vector<uint64_t> time_us;
+    std::vector<glm::quat> reference;
+};
+
+struct FusionResult {
+    FusionResult()
+        : ns_per_report(0.0)
+        , allocations(0)
+        , have_accuracy(false)
+        , rms_error_deg(0.0)
+        , max_error_deg(0.0)
+        , drift_deg_per_min(0.0)
+    {
+    }
+
+    double ns_per_report;
+    unsigned long allocations;
+
+    bool have_accuracy;
+    double rms_error_deg;
+    double max_error_deg;
+    double drift_deg_per_min;
+};
+
+bool
+FusionTrace::load()
+{
+    PSMoveCaptureReader *reader = psmove_capture_reader_new(filename.c_str());
+    if (reader == nullptr) {
+        return false;
+    }
+
+    model = psmove_capture_reader_get_model(reader);
+
+    bool have_reference = false;
+    glm::quat latest_reference;
+
+    const PSMoveCapture_Record *record;
+    while ((record = psmove_capture_reader_peek(reader)) != nullptr) {
+        float q[4];
+        if (psmove_capture_record_get_reference(record, q)) {
+            latest_reference = glm::quat(q[0], q[1], q[2], q[3]);
+            have_reference = true;
+        } else if (record->type == CaptureRecord_Input) {
+            time_us.emplace_back(record->time_us);
+            if (have_reference) {
+                reference.emplace_back(latest_reference);
+            }
+        }
+
+        psmove_capture_reader_advance(reader);
+    }
+
+    psmove_capture_reader_free(reader);
+
+    return !time_us.empty();
+}
+
+float
+angle_between_deg(const glm::quat &a, const glm::quat &b)
+{
+    float cos_half_angle = fminf(1.f, fabsf(glm::dot(a, b)));
+    return 2.f * acosf(cos_half_angle) * 180.f / (float)M_PI;
+}
+
+/**
+ * Accuracy of the estimated orientations: The motion relative to the end of
+ * the warm-up is compared, which cancels out the initial heading (unknown
+ * for IMU-only fusion) and differences in the reference frame's origin.
+ * Drift is the slope of the error over time. Without a reference, drift is
+ * the total rotation after the warm-up (for captures of a resting controller).
+ **/
+void
+compute_accuracy(const FusionTrace &trace, const std::vector<glm::quat> &estimates, FusionResult &result)
+{
+    size_t warmup = 0;
+    while (warmup < estimates.size() &&
+            trace.time_us[warmup] - trace.time_us[0] < FUSION_BENCHMARK_WARMUP_US) {
+        warmup++;
+    }
+
+    if (warmup + 1 >= estimates.size()) {
+        return;
+    }
+
+    double duration_min = (double)(trace.time_us[estimates.size() - 1] - trace.time_us[warmup]) / 60e6;
+
+    if (!trace.has_reference()) {
+        result.drift_deg_per_min = angle_between_deg(estimates[warmup], estimates.back()) / duration_min;
+        result.have_accuracy = true;
+        return;
+    }
+
+    glm::quat estimate_start = glm::conjugate(estimates[warmup]);
+    glm::quat reference_start = glm::conjugate(trace.reference[warmup]);
+
+    double sum_squared = 0.0;
+    double sum_t = 0.0, sum_e = 0.0, sum_tt = 0.0, sum_te = 0.0;
+    size_t count = 0;
+
+    for (size_t i=warmup+1; i<estimates.size(); i++) {
+        double error = angle_between_deg(estimate_start * estimates[i],
+                reference_start * trace.reference[i]);
+        double t = (double)(trace.time_us[i] - trace.time_us[warmup]) / 60e6;
+
+        sum_squared += error * error;
+        result.max_error_deg = fmax(result.max_error_deg, error);
+
+        sum_t += t;
+        sum_e += error;
+        sum_tt += t * t;
+        sum_te += t * error;
+        count++;
+    }
+
+    result.rms_error_deg = sqrt(sum_squared / count);
+
+    double denominator = count * sum_tt - sum_t * sum_t;
+    if (denominator > 0.0) {
+        result.drift_deg_per_min = (count * sum_te - sum_t * sum_e) / denominator;
+    }
+
+    result.have_accuracy = true;
+}
+
+/**
+ * Replay a capture as fast as possible with the given fusion type. If
+ * estimates is not NULL, the orientation after each report is stored.
+ *
+ * Returns the number of reports, or 0 on error.
+ **/
+size_t
+run_fusion(const FusionTrace &trace, enum PSMoveOrientation_Fusion_Type fusion_type,
+        uint64_t *elapsed_us, unsigned long *allocations, std::vector<glm::quat> *estimates)
+{
+    PSMove *move = psmove_connect_replay(trace.filename.c_str(), 0.f);
+    if (move == nullptr) {
+        return 0;
+    }
+
+    psmove_set_orientation_fusion_type(move, fusion_type);
+    psmove_enable_orientation(move, true);
+
+    if (!psmove_has_orientation(move)) {
+        fprintf(stderr, "%s: No calibration data, cannot run sensor fusion\n", trace.filename.c_str());
+        psmove_disconnect(move);
+        return 0;
+    }
+
+    if (estimates != nullptr) {
+        estimates->clear();
+        estimates->reserve(trace.time_us.size());
+    }
+
+    size_t reports = 0;
+    unsigned long allocations_start = fusion_benchmark_allocations;
+    uint64_t start_us = psmove_util_get_time_us();
+
+    while (!psmove_is_replay_finished(move)) {
+        if (psmove_poll(move)) {
+            reports++;
+
+            if (estimates != nullptr) {
+                float w, x, y, z;
+                psmove_get_orientation(move, &w, &x, &y, &z);
+                estimates->emplace_back(w, x, y, z);
+            }
+        }
+    }
+
+    *elapsed_us += psmove_util_get_time_us() - start_us;
+    *allocations += fusion_benchmark_allocations - allocations_start;
+
+    psmove_disconnect(move);
+
+    return reports;
+}
+
+bool
+benchmark_fusion(const FusionTrace &trace, enum PSMoveOrientation_Fusion_Type fusion_type,
+        size_t samples, FusionResult &result)
+{
+    // Untimed pass for the accuracy (and to warm up the caches)
+    std::vector<glm::quat> estimates;
+    uint64_t elapsed_us = 0;
+    unsigned long allocations = 0;
+    if (run_fusion(trace, fusion_type, &elapsed_us, &allocations, &estimates) == 0) {
+        return false;
+    }
+
+    compute_accuracy(trace, estimates, result);
+
+    // Timed passes, repeating the capture until enough samples were fused
+    size_t reports = 0;
+    elapsed_us = 0;
+    while (reports * 2 < samples) {
+        size_t count = run_fusion(trace, fusion_type, &elapsed_us, &result.allocations, nullptr);
+        if (count == 0) {
+            return false;
+        }
+
+        reports += count;
+    }
+
+    result.ns_per_report = (double)elapsed_us * 1000.0 / (double)reports;
+
+    return true;
+}
+
+/**
+ * Replay a capture with float and with fixed-point math side by side (see
+ * _psmove_set_fixed_point()), and compare the calibrated sensor values and
+ * the Madgwick IMU orientation after each report.
+ *
+ * Returns true if all differences are within the tolerances.
+ **/
+bool
+compare_fixed(const char *filename)
+{
+    PSMove *moves[2] = { nullptr, nullptr };
+    bool ok = true;
+
+    for (int i=0; i<2; i++) {
+        moves[i] = psmove_connect_replay(filename, 0.f);
+        if (moves[i] == nullptr) {
+            ok = false;
+            break;
+        }
+
+        _psmove_set_fixed_point(moves[i], (i == 1));
+        psmove_set_orientation_fusion_type(moves[i], OrientationFusion_MadgwickIMU);
+        psmove_enable_orientation(moves[i], true);
+
+        if (!psmove_has_orientation(moves[i])) {
+            fprintf(stderr, "%s: No calibration data, cannot run sensor fusion\n", filename);
+            ok = false;
+            break;
+        }
+    }
+
+    double max_accelerometer_g = 0.0;
+    double max_gyroscope_rad_s = 0.0;
+    double max_orientation_deg = 0.0;
+    unsigned long reports = 0;
+
+    while (ok && !psmove_is_replay_finished(moves[0])) {
+        int polled = psmove_poll(moves[0]);
+        if (psmove_poll(moves[1]) != polled) {
+            fprintf(stderr, "%s: Float and fixed-point replays out of sync\n", filename);
+            ok = false;
+            break;
+        }
+
+        if (!polled) {
+            continue;
+        }
+
+        reports++;
+
+        for (int frame=Frame_FirstHalf; frame<=Frame_SecondHalf; frame++) {
+            float a[2][3], g[2][3];
+            for (int i=0; i<2; i++) {
+                psmove_get_accelerometer_frame(moves[i], (enum PSMove_Frame)frame, &a[i][0], &a[i][1], &a[i][2]);
+                psmove_get_gyroscope_frame(moves[i], (enum PSMove_Frame)frame, &g[i][0], &g[i][1], &g[i][2]);
+            }
+
+            for (int axis=0; axis<3; axis++) {
+                max_accelerometer_g = fmax(max_accelerometer_g, fabs(a[1][axis] - a[0][axis]));
+                max_gyroscope_rad_s = fmax(max_gyroscope_rad_s, fabs(g[1][axis] - g[0][axis]));
+            }
+        }
+
+        glm::quat q[2];
+        for (int i=0; i<2; i++) {
+            psmove_get_orientation(moves[i], &q[i].w, &q[i].x, &q[i].y, &q[i].z);
+        }
+
+        max_orientation_deg = fmax(max_orientation_deg, angle_between_deg(q[0], q[1]));
+    }
+
+    for (int i=0; i<2; i++) {
+        if (moves[i] != nullptr) {
+            psmove_disconnect(moves[i]);
+        }
+    }
+
+    if (!ok) {
+        return false;
+    }
+
+    bool accelerometer_ok = (max_accelerometer_g <= FUSION_COMPARE_ACCELEROMETER_TOLERANCE_G);
+    bool gyroscope_ok = (max_gyroscope_rad_s <= FUSION_COMPARE_GYROSCOPE_TOLERANCE_RAD_S);
+    bool orientation_ok = (max_orientation_deg <= FUSION_COMPARE_ORIENTATION_TOLERANCE_DEG);
+
+    printf("%s: %lu reports, largest difference of fixed-point from float:\n", filename, reports);
+    printf("    %-20s %12.6f g       (tolerance %g) %s\n", "Accelerometer", max_accelerometer_g,
+            FUSION_COMPARE_ACCELEROMETER_TOLERANCE_G, accelerometer_ok ? "OK" : "FAIL");
+    printf("    %-20s %12.6f rad/s   (tolerance %g) %s\n", "Gyroscope", max_gyroscope_rad_s,
+            FUSION_COMPARE_GYROSCOPE_TOLERANCE_RAD_S, gyroscope_ok ? "OK" : "FAIL");
+    printf("    %-20s %12.6f deg     (tolerance %g) %s\n", "MadgwickIMU", max_orientation_deg,
+            FUSION_COMPARE_ORIENTATION_TOLERANCE_DEG, orientation_ok ? "OK" : "FAIL");
+
+    return accelerometer_ok && gyroscope_ok && orientation_ok;
+}
+
+const char *
+fusion_type_name(enum PSMoveOrientation_Fusion_Type fusion_type)
+{
+    switch (fusion_type) {
+        case OrientationFusion_None: return "None";
+        case OrientationFusion_MadgwickIMU: return "MadgwickIMU";
+        case OrientationFusion_MadgwickMARG: return "MadgwickMARG";
+        case OrientationFusion_ComplementaryMARG: return "ComplementaryMARG";
+        case OrientationFusion_ESKF: return "ESKF";
+        default: return "unknown";
+    }
+}
+
+void
+synth_put_u16(unsigned char *out, int value)
+{
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+}
+
+int16_t
+synth_clamp(double value, int limit)
+{
+    return (int16_t)fmax(-limit, fmin(limit, round(value)));
+}
+
+/* Angular velocity of the synthetic motion (in the sensor frame) */
+glm::vec3
+synth_angular_velocity(double t)
+{
+    // Hold still for a second, then ramp up to a tumbling motion
+    double ramp = fmin(1.0, fmax(0.0, t - 1.0));
+
+    return glm::vec3(1.5 * sin(2.0 * M_PI * 0.23 * t),
+                     2.0 * sin(2.0 * M_PI * 0.31 * t + 1.0),
+                     1.2 * sin(2.0 * M_PI * 0.17 * t + 2.0)) * (float)ramp;
+}
+
+/**
+ * Write a synthetic ZCM1 capture of a tumbling controller with reference
+ * orientations. The sensors have white noise, and the gyroscope has a
+ * constant bias, so the reference can be used to measure filter accuracy.
+ **/
+int
+synthesize(const char *filename, double seconds)
+{
+    // Calibration blob: accelerometer readings at -1g/+1g, gyroscope at 80 RPM
+    char calibration[PSMOVE_ZCM1_CALIBRATION_BLOB_SIZE];
+    memset(calibration, 0, sizeof(calibration));
+
+    unsigned char *blob = (unsigned char *)calibration;
+    for (int i=0; i<6*3; i++) {
+        synth_put_u16(blob + 0x04 + 2 * i, 0x8000);
+    }
+
+    const int accel_low[3] = { 1, 5, 2 }; /* orientation of the -1g reading per axis */
+    const int accel_high[3] = { 3, 4, 0 }; /* orientation of the +1g reading per axis */
+    for (int axis=0; axis<3; axis++) {
+        synth_put_u16(blob + 0x04 + 6 * accel_low[axis] + 2 * axis, 0x8000 - FUSION_SYNTH_ACCEL_COUNTS_PER_G);
+        synth_put_u16(blob + 0x04 + 6 * accel_high[axis] + 2 * axis, 0x8000 + FUSION_SYNTH_ACCEL_COUNTS_PER_G);
+        synth_put_u16(blob + 0x2a + 2 * axis, 0x8000);
+        synth_put_u16(blob + 0x46 + 8 * axis + 2 * axis, 0x8000 + FUSION_SYNTH_GYRO_COUNTS_AT_80RPM);
+    }
+
+    const double gyro_counts_per_rad = FUSION_SYNTH_GYRO_COUNTS_AT_80RPM / (80.0 * 2.0 * M_PI / 60.0);
+
+    /**
+     * Directions of gravity and the magnetic field in the identity pose. With
+     * the default calibration pose (lying flat) and sensor data basis (OpenGL)
+     * the two transforms cancel out, so these are also the directions that
+     * the fusion sees (see psmove_get_transformed_gravity_calibration_direction()).
+     **/
+    const glm::vec3 gravity(0.f, 1.f, 0.f);
+    const glm::vec3 magnetic_field = glm::normalize(glm::vec3(0.2f, -0.6f, 0.77f));
+
+    PSMove_3AxisVector direction = psmove_3axisvector_xyz(magnetic_field.x, magnetic_field.y, magnetic_field.z);
+    PSMoveCaptureWriter *writer = psmove_capture_writer_new(filename, "00:00:00:00:00:00",
+            Model_ZCM1, calibration, sizeof(calibration), &direction);
+    if (writer == nullptr) {
+        fprintf(stderr, "Cannot write %s\n", filename);
+        return 1;
+    }
+
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> accel_noise(0.f, 0.01f); /* g */
+    std::normal_distribution<float> gyro_noise(0.f, 0.005f); /* rad/s */
+    std::normal_distribution<float> magnetometer_noise(0.f, 0.01f);
+    const glm::vec3 gyro_bias(0.01f, -0.005f, 0.008f); /* rad/s */
+
+    // Sensor frame -> raw sensor axes (inverse of the OpenGL sensor data basis)
+    auto to_sensor_axes = [](const glm::vec3 &v) {
+        return glm::vec3(v.x, -v.z, v.y);
+    };
+
+    const int substeps = 16;
+    const double half_interval = FUSION_SYNTH_REPORT_INTERVAL_US / 2e6;
+
+    glm::quat orientation(1.f, 0.f, 0.f, 0.f);
+    double t = 0.0;
+
+    unsigned long reports = (unsigned long)(seconds * 1e6 / FUSION_SYNTH_REPORT_INTERVAL_US);
+    for (unsigned long report=0; report<reports; report++) {
+        unsigned char data[FUSION_SYNTH_REPORT_SIZE];
+        memset(data, 0, sizeof(data));
+
+        glm::vec3 magnetometer;
+        for (int frame=0; frame<2; frame++) {
+            // Integrate the motion up to the sampling time of this frame
+            for (int i=0; i<substeps; i++) {
+                double dt = half_interval / substeps;
+                glm::vec3 omega = synth_angular_velocity(t + dt / 2.0);
+                float angle = glm::length(omega) * (float)dt;
+                if (angle > 0.f) {
+                    orientation = glm::normalize(orientation * glm::angleAxis(angle, omega / glm::length(omega)));
+                }
+                t += dt;
+            }
+
+            glm::vec3 noise_a(accel_noise(rng), accel_noise(rng), accel_noise(rng));
+            glm::vec3 noise_g(gyro_noise(rng), gyro_noise(rng), gyro_noise(rng));
+
+            glm::vec3 accelerometer = to_sensor_axes(glm::conjugate(orientation) * gravity + noise_a);
+            glm::vec3 gyroscope = to_sensor_axes(synth_angular_velocity(t) + gyro_bias + noise_g);
+
+            for (int axis=0; axis<3; axis++) {
+                // IMU values are offset binary, at offsets 13 (see PSMove_Data_Input_Common)
+                int a = synth_clamp(accelerometer[axis] * FUSION_SYNTH_ACCEL_COUNTS_PER_G, 0x7FFF);
+                int g = synth_clamp(gyroscope[axis] * gyro_counts_per_rad, 0x7FFF);
+                synth_put_u16(data + 13 + 2 * (0 * 6 + frame * 3 + axis), (a + 0x8000) & 0xFFFF);
+                synth_put_u16(data + 13 + 2 * (1 * 6 + frame * 3 + axis), (g + 0x8000) & 0xFFFF);
+            }
+
+            glm::vec3 noise_m(magnetometer_noise(rng), magnetometer_noise(rng), magnetometer_noise(rng));
+            magnetometer = to_sensor_axes(glm::conjugate(orientation) * magnetic_field + noise_m);
+        }
+
+        // The magnetometer Y axis is flipped (see psmove_get_magnetometer_3axisvector())
+        int mx = synth_clamp(magnetometer.x * FUSION_SYNTH_MAGNETOMETER_COUNTS, 0x7FF) & 0xFFF;
+        int my = synth_clamp(-magnetometer.y * FUSION_SYNTH_MAGNETOMETER_COUNTS, 0x7FF) & 0xFFF;
+        int mz = synth_clamp(magnetometer.z * FUSION_SYNTH_MAGNETOMETER_COUNTS, 0x7FF) & 0xFFF;
+
+        uint64_t time_us = (uint64_t)report * FUSION_SYNTH_REPORT_INTERVAL_US;
+        uint16_t timestamp = (uint16_t)time_us; /* device clock ticks in microseconds */
+        int temperature = 0x5E0;
+
+        data[0] = 0x01; /* PSMove_Req_GetInput */
+        data[4] = report & 0x0F; /* sequence number */
+        data[11] = timestamp >> 8;
+        data[12] = Batt_MAX;
+        data[37] = temperature >> 4;
+        data[38] = ((temperature & 0x0F) << 4) | (mx >> 8);
+        data[39] = mx & 0xFF;
+        data[40] = my >> 4;
+        data[41] = ((my & 0x0F) << 4) | (mz >> 8);
+        data[42] = mz & 0xFF;
+        data[43] = timestamp & 0xFF;
+
+        float reference[4] = { orientation.w, orientation.x, orientation.y, orientation.z };
+        psmove_capture_writer_write_reference(writer, time_us, reference);
+        psmove_capture_writer_write(writer, CaptureRecord_Input, time_us, data, sizeof(data));
+    }
+
+    psmove_capture_writer_free(writer);
+
+    printf("Wrote %lu reports (%.1f s) to %s\n", reports, seconds, filename);
+
+    return 0;
+}
+
+}; // end anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    size_t samples = FUSION_BENCHMARK_DEFAULT_SAMPLES;
+    int first = 1;
+
+    if (argc >= 3 && strcmp(argv[1], "-s") == 0) {
+        double seconds = (argc >= 4) ? atof(argv[3]) : FUSION_SYNTH_DEFAULT_SECONDS;
+        return synthesize(argv[2], seconds);
+    } else if (argc >= 3 && strcmp(argv[1], "--compare-fixed") == 0) {
+        int result = 0;
+        for (int i=2; i<argc; i++) {
+            if (!compare_fixed(argv[i])) {
+                result = 1;
+            }
+        }
+        return result;
+    } else if (argc >= 3 && strcmp(argv[1], "-n") == 0) {
+        samples = strtoul(argv[2], nullptr, 10);
+        first = 3;
+    }
+
+    if (first >= argc || strcmp(argv[first], "-h") == 0 || strcmp(argv[first], "--help") == 0) {
+        fprintf(stderr, "Usage: %s [-n <samples>] <capture> [<capture> ...]\n", argv[0]);
+        fprintf(stderr, "       %s -s <capture> [<seconds>]\n", argv[0]);
+        fprintf(stderr, "       %s --compare-fixed <capture> [<capture> ...]\n\n", argv[0]);
+        fprintf(stderr, "Replays captures (see psmove_start_recording()) through each sensor\n");
+        fprintf(stderr, "fusion type, and reports CPU time, heap allocations, and the error\n");
+        fprintf(stderr, "against the reference orientation recorded in the capture (if any).\n");
+#if !defined(FUSION_BENCHMARK_COUNT_ALLOCATIONS)
+        fprintf(stderr, "Allocations are only counted by psmove_benchmark_fusion (on Linux).\n");
+#endif
+        fprintf(stderr, "\n");
+        fprintf(stderr, "    -n <samples> ... Number of samples to time per fusion type (default: %d)\n",
+                FUSION_BENCHMARK_DEFAULT_SAMPLES);
+        fprintf(stderr, "    -s <capture> ... Write a synthetic capture with reference orientations\n");
+        fprintf(stderr, "    --compare-fixed  Check the fixed-point math against the float math,\n");
+        fprintf(stderr, "                     fails if the results differ by more than a tolerance\n");
+        return 1;
+    }
+
+    const enum PSMoveOrientation_Fusion_Type fusion_types[] = {
+        OrientationFusion_None,
+        OrientationFusion_MadgwickIMU,
+        OrientationFusion_MadgwickMARG,
+        OrientationFusion_ComplementaryMARG,
+        OrientationFusion_ESKF,
+    };
+
+    int result = 0;
+
+    for (int i=first; i<argc; i++) {
+        FusionTrace trace(argv[i]);
+        if (!trace.load()) {
+            fprintf(stderr, "%s: Cannot load capture\n", argv[i]);
+            result = 1;
+            continue;
+        }
+
+        printf("%s: %lu reports (%s), %.1f s%s\n", argv[i], (unsigned long)trace.time_us.size(),
+                (trace.model == Model_ZCM1) ? "ZCM1" : "ZCM2",
+                (double)(trace.time_us.back() - trace.time_us.front()) / 1e6,
+                trace.has_reference() ? ", with reference orientation" : "");
+        printf("    %-20s %10s %10s %8s %10s %10s %12s\n", "Fusion", "ns/report", "ns/sample",
+                "allocs", "RMS [deg]", "max [deg]", "drift [deg/min]");
+
+        double baseline_ns_per_report = 0.0;
+
+        for (auto fusion_type: fusion_types) {
+            if (trace.model != Model_ZCM1 && (fusion_type == OrientationFusion_MadgwickMARG ||
+                        fusion_type == OrientationFusion_ComplementaryMARG)) {
+                printf("    %-20s (skipped, no magnetometer)\n", fusion_type_name(fusion_type));
+                continue;
+            }
+
+            FusionResult fusion;
+            if (!benchmark_fusion(trace, fusion_type, samples, fusion)) {
+                result = 1;
+                break;
+            }
+
+            if (fusion_type == OrientationFusion_None) {
+                // Replaying, decoding and calibrating without fusion
+                baseline_ns_per_report = fusion.ns_per_report;
+            }
+
+            // Two samples (frames) are fused per report
+            double ns_per_sample = (fusion.ns_per_report - baseline_ns_per_report) / 2.0;
+
+            printf("    %-20s %10.1f", fusion_type_name(fusion_type), fusion.ns_per_report);
+            if (fusion_type == OrientationFusion_None) {
+                printf(" %10s", "-");
+            } else {
+                printf(" %10.1f", ns_per_sample);
+            }
+#if defined(FUSION_BENCHMARK_COUNT_ALLOCATIONS)
+            printf(" %8lu", fusion.allocations);
+#else
+            printf(" %8s", "-");
+#endif
+            if (!fusion.have_accuracy) {
+                printf(" %10s %10s %12s\n", "-", "-", "-");
+            } else if (trace.has_reference()) {
+                printf(" %10.2f %10.2f %12.3f\n", fusion.rms_error_deg, fusion.max_error_deg,
+                        fusion.drift_deg_per_min);
+            } else {
+                printf(" %10s %10s %12.3f\n", "-", "-", fusion.drift_deg_per_min);
+            }
+        }
+    }
+
+    return result;
+}
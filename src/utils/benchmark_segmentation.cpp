@@ -0,0 +1,188 @@
+ /**
+ * PS Move API - An interface for the PS Move Motion Controller
+ * Copyright (c) 2026 Thomas Perl <m@thp.io>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <random>
+#include <vector>
+
+#include "opencv2/core/core_c.h"
+#include "opencv2/imgproc/imgproc_c.h"
+
+#include "psmove.h"
+#include "../tracker/psmove_tracker_hsv.h"
+
+#define SEGMENTATION_BENCHMARK_DEFAULT_FRAMES 500
+#define SEGMENTATION_BENCHMARK_ROI_SIZE 240 // biggest ROI of a 640x480 frame
+
+namespace {
+
+/* Filter ranges to check, default tracker range around a sweep of colors plus edge cases */
+std::vector<std::pair<CvScalar, CvScalar>>
+check_ranges()
+{
+    std::vector<std::pair<CvScalar, CvScalar>> result;
+
+    for (int hue=0; hue<=180; hue+=6) {
+        for (int sv=0; sv<=255; sv+=85) {
+            CvScalar color = cvScalar(hue, sv, 255 - sv);
+            result.emplace_back(cvScalar(color.val[0] - 8, color.val[1] - 85, color.val[2] - 85),
+                                cvScalar(color.val[0] + 8, color.val[1] + 85, color.val[2] + 85));
+        }
+    }
+
+    result.emplace_back(cvScalar(10.5, 20.25, 30.75), cvScalar(40.5, 200.75, 250.25));
+    result.emplace_back(cvScalar(-300, -300, -300), cvScalar(300, 300, 300));
+    result.emplace_back(cvScalar(0, 0, 0), cvScalar(-1, 255, 255));
+    result.emplace_back(cvScalar(256, 0, 0), cvScalar(300, 255, 255));
+    result.emplace_back(cvScalar(50, 60, 70), cvScalar(40, 255, 255));
+
+    return result;
+}
+
+/**
+ * Compare psmove::tracker::hsv_mask() with cvCvtColor() + cvInRangeS() on
+ * a frame that contains every 24-bit color once, returns the number of
+ * differing mask pixels
+ **/
+long
+check_exactness()
+{
+    IplImage *frame = cvCreateImage(cvSize(4096, 4096), IPL_DEPTH_8U, 3);
+    IplImage *hsv = cvCreateImage(cvSize(4096, 4096), IPL_DEPTH_8U, 3);
+    IplImage *expected = cvCreateImage(cvSize(4096, 4096), IPL_DEPTH_8U, 1);
+    IplImage *mask = cvCreateImage(cvSize(4096, 4096), IPL_DEPTH_8U, 1);
+
+    for (int y=0; y<frame->height; y++) {
+        uint8_t *row = (uint8_t *)frame->imageData + y * frame->widthStep;
+        for (int x=0; x<frame->width; x++) {
+            uint32_t color = (uint32_t)(y * frame->width + x);
+            row[3 * x + 0] = (uint8_t)(color & 0xFF);
+            row[3 * x + 1] = (uint8_t)((color >> 8) & 0xFF);
+            row[3 * x + 2] = (uint8_t)((color >> 16) & 0xFF);
+        }
+    }
+
+    cvCvtColor(frame, hsv, CV_BGR2HSV);
+
+    long differences = 0;
+    for (auto &range: check_ranges()) {
+        cvInRangeS(hsv, range.first, range.second, expected);
+        psmove::tracker::hsv_mask(frame, range.first, range.second, mask);
+
+        cvCmp(expected, mask, mask, CV_CMP_NE);
+        int count = cvCountNonZero(mask);
+        if (count) {
+            printf("    H %.2f..%.2f S %.2f..%.2f V %.2f..%.2f: %d pixels differ\n",
+                    range.first.val[0], range.second.val[0], range.first.val[1], range.second.val[1],
+                    range.first.val[2], range.second.val[2], count);
+        }
+        differences += count;
+    }
+
+    cvReleaseImage(&mask);
+    cvReleaseImage(&expected);
+    cvReleaseImage(&hsv);
+    cvReleaseImage(&frame);
+
+    return differences;
+}
+
+/* Average time per ROI of both ways of getting the mask, in microseconds */
+void
+benchmark(int frames, double *opencv_us, double *fused_us)
+{
+    IplImage *frame = cvCreateImage(cvSize(640, 480), IPL_DEPTH_8U, 3);
+    IplImage *roi_i = cvCreateImage(cvSize(SEGMENTATION_BENCHMARK_ROI_SIZE, SEGMENTATION_BENCHMARK_ROI_SIZE), IPL_DEPTH_8U, 3);
+    IplImage *roi_m = cvCreateImage(cvSize(SEGMENTATION_BENCHMARK_ROI_SIZE, SEGMENTATION_BENCHMARK_ROI_SIZE), IPL_DEPTH_8U, 1);
+
+    std::mt19937 random(0);
+    for (int i=0; i<frame->imageSize; i++) {
+        frame->imageData[i] = (char)(random() & 0xFF);
+    }
+
+    CvScalar min = cvScalar(150 - 8, 255 - 85, 255 - 85);
+    CvScalar max = cvScalar(150 + 8, 255 + 85, 255 + 85);
+
+    cvSetImageROI(frame, cvRect(200, 120, SEGMENTATION_BENCHMARK_ROI_SIZE, SEGMENTATION_BENCHMARK_ROI_SIZE));
+
+    uint64_t started = psmove_util_get_time_us();
+    for (int i=0; i<frames; i++) {
+        cvCvtColor(frame, roi_i, CV_BGR2HSV);
+        cvInRangeS(roi_i, min, max, roi_m);
+    }
+    *opencv_us = (double)(psmove_util_get_time_us() - started) / frames;
+
+    started = psmove_util_get_time_us();
+    for (int i=0; i<frames; i++) {
+        psmove::tracker::hsv_mask(frame, min, max, roi_m);
+    }
+    *fused_us = (double)(psmove_util_get_time_us() - started) / frames;
+
+    cvReleaseImage(&roi_m);
+    cvReleaseImage(&roi_i);
+    cvReleaseImage(&frame);
+}
+
+} // end anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    int frames = SEGMENTATION_BENCHMARK_DEFAULT_FRAMES;
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        frames = atoi(argv[2]);
+    } else if (argc != 1) {
+        fprintf(stderr, "Usage: %s [-n <frames>]\n\n", argv[0]);
+        fprintf(stderr, "Checks that the tracker's fused BGR-to-HSV color filter gives the same\n");
+        fprintf(stderr, "masks as cvCvtColor() and cvInRangeS() for all 24-bit colors, and\n");
+        fprintf(stderr, "compares the time both take for a %dx%d ROI.\n\n",
+                SEGMENTATION_BENCHMARK_ROI_SIZE, SEGMENTATION_BENCHMARK_ROI_SIZE);
+        fprintf(stderr, "    -n <frames> ... Number of ROIs to time (default: %d)\n",
+                SEGMENTATION_BENCHMARK_DEFAULT_FRAMES);
+        return 1;
+    }
+
+    printf("Checking all 24-bit colors against OpenCV...\n");
+    long differences = check_exactness();
+    printf("    %s (%ld differing pixels)\n", differences ? "FAILED" : "OK", differences);
+
+    if (frames > 0) {
+        double opencv_us, fused_us;
+        benchmark(frames, &opencv_us, &fused_us);
+        printf("%dx%d ROI, %d frames:\n", SEGMENTATION_BENCHMARK_ROI_SIZE, SEGMENTATION_BENCHMARK_ROI_SIZE, frames);
+        printf("    cvCvtColor + cvInRangeS: %8.1f us\n", opencv_us);
+        printf("    fused:                   %8.1f us\n", fused_us);
+    }
+
+    return differences ? 1 : 0;
+}
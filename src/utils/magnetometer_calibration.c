@@ -106,10 +106,7 @@ main(int argc, char *argv[])
 						unsigned int pressed, released;
 						psmove_get_button_events(move, &pressed, &released);
 
-						/* This call updates min/max values if exceeding previously stored values */
-						psmove_get_magnetometer_3axisvector(move, NULL);
-
-						/* Returns the minimum delta (max-min) across dimensions (x, y, z) */
+						/* psmove_poll() collects the readings, returns the smallest diameter of the fitted ellipsoid */
 						float range = psmove_get_magnetometer_calibration_range(move);
 
 						/* Update the LEDs to indicate progress */
@@ -240,19 +237,8 @@ main(int argc, char *argv[])
 		}
 		else
 		{			
-			char *serial= psmove_get_serial(move);
-
-			printf("\nController #%d has bad calibration file (accelerometer values won't be correct).\n", i);
-
-			if (serial != NULL)
-			{
-				printf("Please delete %s.calibration and re-run \"psmove pair\" with the controller plugged into usb.", serial);
-				psmove_free_mem(serial);
-			}
-			else
-			{
-				printf("Please re-run \"psmove pair\" with the controller plugged into usb.");
-			}
+			printf("\nController #%d has no calibration (accelerometer values won't be correct).\n", i);
+			printf("Please re-run \"psmove pair\" with the controller plugged into usb.");
 		}
 
         printf("\nFinished PS Move #%d\n", i);
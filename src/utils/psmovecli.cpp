@@ -88,6 +88,10 @@ extern "C" {
 }
 #undef main
 
+#define main benchmark_fusion_main
+#include "benchmark_fusion.cpp"
+#undef main
+
 #if defined(PSMOVE_USE_SIXPAIR)
 #define main sixpair_main
 extern "C" {
@@ -111,6 +115,10 @@ extern "C" {
 #include "distance_calibration.cpp"
 #undef main
 
+#define main benchmark_segmentation_main
+#include "benchmark_segmentation.cpp"
+#undef main
+
 #endif /* PSMOVE_BUILD_TRACKER */
 
 static int
@@ -267,6 +275,7 @@ main(int argc, char *argv[])
 
     subcommands.emplace_back("responsiveness", "Test how quickly the controllers react", test_responsiveness_main);
     subcommands.emplace_back("led-pwm-frequency", "Test LED PWM frequency modulation", test_led_pwm_frequency_main);
+    subcommands.emplace_back("benchmark-fusion", "Benchmark sensor fusion on recorded captures", benchmark_fusion_main);
 
 #if defined(PSMOVE_BUILD_TRACKER)
     subcommands.emplace_back(nullptr, "Camera Tracking", nullptr);
@@ -276,6 +285,7 @@ main(int argc, char *argv[])
     subcommands.emplace_back("test-undistortion", "Test a camera calibration file", verify_camera_calibration_main);
     subcommands.emplace_back("test-camera", "Test camera capture (without tracking)", test_camera_main);
     subcommands.emplace_back("test-tracker", "Test tracking of controllers in the camera", test_tracker_main);
+    subcommands.emplace_back("benchmark-segmentation", "Check and time the tracker's color filter", benchmark_segmentation_main);
     subcommands.emplace_back("camera-firmware", "Initialize PS4/PS5 camera by uploading its firmware via USB", ps4_camera_firmware_main);
 #endif /* PSMOVE_BUILD_TRACKER */
 